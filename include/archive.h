@@ -0,0 +1,133 @@
+/* libchess
+ * Jack O'Connor 2025
+ * include/archive.h
+ */
+
+#ifndef ARCHIVE_H
+#define ARCHIVE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "chessboard.h"
+#include "pgn.h"
+#include "position.h"
+
+
+/* Constants */
+
+#define ARCHIVE_MAGIC       (0x3141434Cu)   // "LCA1" read as little-endian
+#define ARCHIVE_MAX_NAMES   (255)           // Distinct tag names; further names are dropped
+#define ARCHIVE_MAX_TAGS    (255)           // Tags per game
+#define ARCHIVE_MAX_PLIES   (65535)
+
+#define ARCHIVE_FLAG_FEN    (1 << 2)        // The FEN tag holds the starting position (and is stored)
+#define ARCHIVE_RESULT_MASK (0x03)
+
+
+/* Types */
+
+typedef struct { // At offset 0; every offset is from the start of the file (little-endian)
+    uint32_t    magic;
+    uint32_t    games;
+    uint64_t    names_offset;               // String table of tag names
+    uint64_t    values_offset;              // String table of tag values
+    uint64_t    index_offset;               // games x uint64_t game offsets
+} ArchiveFileHeader;
+
+typedef struct { // Starts every game record (4-byte aligned)
+    uint16_t    plies;
+    uint8_t     tags_count;
+    uint8_t     flags;                      // Result in the low bits, ARCHIVE_FLAG_FEN
+} ArchiveGameHeader;
+// Then uint8_t names[tags_count] (padded to 4), uint32_t values[tags_count],
+// ChessMove moves[plies] (padded to 4)
+
+typedef struct { // String table: count, count + 1 offsets into the bytes that follow
+    const uint32_t *offsets;
+    const char     *bytes;
+    uint32_t        count;
+} ArchiveStrings;
+
+typedef struct {
+    const char         *data;               // Mapped file
+    size_t              size;
+    size_t              games;
+
+    const uint64_t     *index;
+    ArchiveStrings      names;
+    ArchiveStrings      values;
+    int                 fen_name;           // Name id of "FEN" (or -1)
+
+    Position            start;              // Standard starting position, copied per replay
+} ArchiveReader;
+
+typedef struct { // One game, pointing into the mapping
+    size_t              index;
+    uint8_t             result;             // enum ArchiveResult
+    bool                fen;
+
+    size_t              tags_count;
+    const uint8_t      *names;
+    const uint32_t     *values;
+
+    size_t              plies;
+    const ChessMove    *moves;
+} ArchiveGame;
+
+typedef struct { // Interning table of one string kind
+    char       *bytes;
+    size_t      length;
+    size_t      capacity;
+
+    uint32_t   *offsets;                    // count + 1 entries
+    uint32_t    count;
+    size_t      offsets_capacity;
+
+    uint32_t   *slots;                      // Open addressing, id + 1 (0 is empty)
+    size_t      mask;
+} ArchiveIntern;
+
+typedef struct {
+    FILE           *stream;
+    size_t          offset;                 // Bytes written so far
+
+    uint64_t       *index;
+    size_t          games;
+    size_t          index_capacity;
+
+    ArchiveIntern   names;
+    ArchiveIntern   values;
+    size_t          dropped;                // Tags lost to ARCHIVE_MAX_NAMES or ARCHIVE_MAX_TAGS
+} ArchiveWriter;
+
+
+/* Enums */
+
+enum ArchiveResult {
+    ARCHIVE_RESULT_UNKNOWN  = 0,            // "*"
+    ARCHIVE_RESULT_WHITE    = 1,            // "1-0"
+    ARCHIVE_RESULT_BLACK    = 2,            // "0-1"
+    ARCHIVE_RESULT_DRAW     = 3             // "1/2-1/2"
+};
+
+
+/* Function Headers */
+
+ArchiveWriter * archive_writer_create(const char *path);
+bool            archive_writer_add(ArchiveWriter *aw, const PgnTag *tags, size_t tags_count, uint8_t result,
+                                   const ChessMove *moves, size_t plies);
+bool            archive_writer_close(ArchiveWriter *aw);
+uint8_t         archive_result(PgnSpan text);
+
+ArchiveReader * archive_open(const char *path);
+void            archive_close(ArchiveReader *ar);
+bool            archive_game(ArchiveReader *ar, size_t index, ArchiveGame *game);
+bool            archive_string(const ArchiveStrings *strings, uint32_t id, PgnSpan *value);
+bool            archive_game_tag(ArchiveReader *ar, const ArchiveGame *game, const char *name, PgnSpan *value);
+bool            archive_replay(ArchiveReader *ar, const ArchiveGame *game, ChessBoard *cb);
+
+
+#endif
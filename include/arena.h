@@ -0,0 +1,50 @@
+/* libchess
+ * Jack O'Connor 2025
+ * include/arena.h
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+
+/* Constants */
+
+#define ARENA_BLOCK_SIZE    (1 << 20)   // Default bytes per block
+#define ARENA_ALIGNMENT     (16)        // Every allocation is aligned to this
+
+
+/* Types */
+
+typedef struct ArenaBlock ArenaBlock;
+
+struct ArenaBlock {
+    ArenaBlock *next;
+    size_t      size;                   // Usable bytes after the header
+    size_t      used;
+    size_t      padding;                // Keeps the data that follows aligned
+};
+
+typedef struct { // Bump allocator; everything allocated is released together
+    ArenaBlock *blocks;                 // Block being filled first
+    ArenaBlock *spare;                  // Blocks kept by arena_reset for reuse
+    size_t      block_size;
+    size_t      allocated;              // Bytes handed out since the last reset
+    size_t      blocks_count;           // Blocks obtained from malloc
+} Arena;
+
+
+/* Function Headers */
+
+Arena *     arena_create(size_t block_size);
+void        arena_delete(Arena *arena);
+void        arena_reset(Arena *arena);
+
+void *      arena_alloc(Arena *arena, size_t size);
+void *      arena_calloc(Arena *arena, size_t count, size_t size);
+char *      arena_strdup(Arena *arena, const char *s);
+
+
+#endif
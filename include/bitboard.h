@@ -1,29 +1,112 @@
-/* libchess
- * Jack O'Connor 2025
- * include/bitboard.h
- */
-
-#ifndef BITBOARD_H
-#define BITBOARD_H
-
-#include <stdbool.h>
-#include <stdint.h>
-#include <stdio.h>
-
-/* Types */
-
-typedef uint64_t Bitboard;
-
-
-/* Macro Functions */
-
-#define bitboard_set(b, file, rank, value)      (b = ((value) ? b | (1L << (rank * 8 + file)) : b & ~(1L << (rank * 8 + file))))
-#define bitboard_get(b, file, rank)             ((b >> (rank * 8 + file) & 1L))
-
-/* Function Headers */
-
-void    bitboard_dump(Bitboard *b, FILE *stream);
-
-
-#endif
-
+/* libchess
+ * Jack O'Connor 2025
+ * include/bitboard.h
+ */
+
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/* Types */
+
+typedef uint64_t Bitboard;
+
+
+/* Constants */
+
+#define BB_FILE_A       (0x0101010101010101lu)
+#define BB_FILE_B       (BB_FILE_A << 1)
+#define BB_FILE_G       (BB_FILE_A << 6)
+#define BB_FILE_H       (BB_FILE_A << 7)
+#define BB_RANK_1       (0x00000000000000FFlu)
+#define BB_RANK_3       (BB_RANK_1 << 16)
+#define BB_RANK_6       (BB_RANK_1 << 40)
+#define BB_RANK_8       (BB_RANK_1 << 56)
+
+
+/* Globals */
+
+extern const Bitboard KNIGHT_ATTACKS[64];
+extern const Bitboard KING_ATTACKS[64];
+extern const Bitboard PAWN_ATTACKS[2][64];  // [0] white, [1] black
+
+
+/* Macro Functions */
+
+#define bitboard_set(b, file, rank, value)      (b = ((value) ? b | (1L << ((rank) * 8 + (file))) : b & ~(1L << ((rank) * 8 + (file)))))
+#define bitboard_get(b, file, rank)             (((b) >> ((rank) * 8 + (file)) & 1L))
+
+#define bitboard_popcount(b)                    ((uint8_t)__builtin_popcountll(b))
+#define bitboard_lsb(b)                         ((uint8_t)__builtin_ctzll(b))
+#define bitboard_msb(b)                         ((uint8_t)(63 ^ __builtin_clzll(b)))
+#define bitboard_pop_lsb(b)                     __extension__ ({ uint8_t _sq = bitboard_lsb(b); b &= b - 1; _sq; })
+
+// One-square shifts; the file masks stop east/west moves wrapping around the board
+#define bitboard_north(b)                       ((b) << 8)
+#define bitboard_south(b)                       ((b) >> 8)
+#define bitboard_east(b)                        (((b) << 1) & ~BB_FILE_A)
+#define bitboard_west(b)                        (((b) >> 1) & ~BB_FILE_H)
+#define bitboard_north_east(b)                  (((b) << 9) & ~BB_FILE_A)
+#define bitboard_north_west(b)                  (((b) << 7) & ~BB_FILE_H)
+#define bitboard_south_east(b)                  (((b) >> 7) & ~BB_FILE_A)
+#define bitboard_south_west(b)                  (((b) >> 9) & ~BB_FILE_H)
+
+
+/* Inline Functions */
+
+/**
+ * Set-wise knight attacks.
+ *
+ * @param   b   Bitboard of knights.
+ *
+ * @return  Bitboard of squares attacked by any of the knights.
+**/
+static inline Bitboard  bitboard_knight_attacks(Bitboard b) {
+
+    Bitboard l1 = (b >> 1) & ~BB_FILE_H;
+    Bitboard l2 = (b >> 2) & ~(BB_FILE_G | BB_FILE_H);
+    Bitboard r1 = (b << 1) & ~BB_FILE_A;
+    Bitboard r2 = (b << 2) & ~(BB_FILE_A | BB_FILE_B);
+    Bitboard h1 = l1 | r1;
+    Bitboard h2 = l2 | r2;
+    return (h1 << 16) | (h1 >> 16) | (h2 << 8) | (h2 >> 8);
+}
+
+/**
+ * Set-wise king attacks.
+ *
+ * @param   b   Bitboard of kings.
+ *
+ * @return  Bitboard of squares attacked by any of the kings.
+**/
+static inline Bitboard  bitboard_king_attacks(Bitboard b) {
+
+    Bitboard attacks = bitboard_east(b) | bitboard_west(b);
+    b |= attacks;
+    return attacks | bitboard_north(b) | bitboard_south(b);
+}
+
+/**
+ * Set-wise pawn attacks.
+ *
+ * @param   b       Bitboard of pawns.
+ * @param   black   `true` for black pawns (attacking south), `false` for white.
+ *
+ * @return  Bitboard of squares attacked by any of the pawns.
+**/
+static inline Bitboard  bitboard_pawn_attacks(Bitboard b, bool black) {
+
+    if (!black) return bitboard_north_west(b) | bitboard_north_east(b);
+    return bitboard_south_west(b) | bitboard_south_east(b);
+}
+
+
+/* Function Headers */
+
+void    bitboard_dump(Bitboard *b, FILE *stream);
+
+
+#endif
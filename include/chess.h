@@ -1,45 +1,71 @@
-/* libchess
- * Jack O'Connor 2025
- * include/chess.h
- */
-
-#pragma once
-
-#include <stdbool.h>
-#include <stdint.h>
-#include <stdio.h>
-#include <stdlib.h>
-#include <time.h>
-
-#include "list.h"
-#include "bitboard.h"
-#include "chessboard.h"
-
-
-/* Types */
-
-typedef struct {
-    Chessboard *board;
-    size_t ply_count;
-
-    char *event;
-    char *site;
-    char *date;
-    char *time;
-    size_t round;
-    char *white;
-    char *black;
-    char *result;
-
-    List *moves;
-} ChessGame;
-
-
-/* Function Headers */
-
-ChessGame *     chessgame_create(const char *fen, char *event, char *site, char *date, char *time, size_t round, char *white, char *black);
-void            chessgame_delete(ChessGame *cg);
-
-bool            chessgame_move_pgn(ChessGame *cg, const char *pgn);
-bool            chessgame_to_fen(ChessGame *cg, char *fen);
-
+/* libchess
+ * Jack O'Connor 2025
+ * include/chess.h
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "arena.h"
+#include "bitboard.h"
+#include "chessboard.h"
+
+
+/* Types */
+
+typedef struct { // One ply of history
+    ChessMove   move;
+    ChessUndo   undo;                   // State the move destroyed
+    uint64_t    key;                    // Position key after the move
+} ChessRecord;
+
+typedef struct {
+    ChessBoard *board;
+    size_t ply_count;                   // Plies played (records past it can be redone)
+
+    char *event;
+    char *site;
+    char *date;
+    char *time;
+    size_t round;
+    char *white;
+    char *black;
+    uint8_t result;                     // enum ChessGameResult
+
+    ChessRecord *records;               // Contiguous, indexed by ply
+    size_t records_count;               // Plies that can be redone up to
+    size_t records_capacity;
+
+    Arena *arena;                       // Owns the game (NULL for the heap)
+} ChessGame;
+
+
+/* Enums */
+
+enum ChessGameResult {
+    CHESSGAME_ONGOING   = 0,
+    CHESSGAME_WHITE_WON = 1,
+    CHESSGAME_BLACK_WON = 2,
+    CHESSGAME_DRAWN     = 3             // Stalemate
+};
+
+
+/* Function Headers */
+
+ChessGame *     chessgame_create(const char *fen, char *event, char *site, char *date, char *time, size_t round, char *white, char *black);
+ChessGame *     chessgame_create_in(Arena *arena, const char *fen, char *event, char *site, char *date, char *time, size_t round, char *white, char *black);
+void            chessgame_delete(ChessGame *cg);
+
+bool            chessgame_move(ChessGame *cg, ChessMove move);
+bool            chessgame_move_pgn(ChessGame *cg, const char *pgn);
+bool            chessgame_undo(ChessGame *cg);
+bool            chessgame_redo(ChessGame *cg);
+
+const ChessRecord * chessgame_record(const ChessGame *cg, size_t ply);
+size_t          chessgame_repetitions(const ChessGame *cg);
+size_t          chessgame_to_fen(ChessGame *cg, char *fen, size_t size);
@@ -1,62 +1,158 @@
-// libchess
-// Jack O'Connor 2025
-// include/chessboard.h
-
-#ifndef CHESSBOARD_H
-#define CHESSBOARD_H
-
-#include <stdint.h>
-#include <stdlib.h>
-#include <stdio.h>
-
-#include "chesspiece.h"
-#include "bitboard.h"
-
-
-#define MAX_MOVES   (218)
-#define COLOR_ARR_INDEX(color)  ((color == WHITE) ? 0 : 1)
-#define PIECE_ARR_INDEX(piece)  (piece & (PIECE_TYPE_BITMASK | PIECE_COLOR_BITMASK))
-
-#define BB_IDX_ALL              (7)
-#define BB_IDX_COLOR(color)     (color)
-#define BB_IDX_PIECE(piece)     ((piece) & (PIECE_TYPE_BITMASK | PIECE_COLOR_BITMASK))
-
-/* Types */
-
-typedef struct {
-    ChessPiece  board[64];
-    size_t      halfmove_clock;
-    size_t      fullmove_counter;
-
-    Bitboard    locations[14];
-
-    Bitboard    targets[14];
-
-    uint8_t     to_move;
-    int8_t      enpassant_target;
-    uint8_t     castle_ability_w;
-    uint8_t     castle_ability_b;
-
-    uint8_t     king_pos_w;
-    uint8_t     king_pos_b;
-} ChessBoard;
-
-typedef uint16_t ChessMove;
-
-
-/* External Function */
-
-ChessBoard *        chessboard_create(const char *fen);
-void                chessboard_delete(ChessBoard *cb);
-void                chessboard_dump(ChessBoard *cb, FILE *stream);
-char *              chessboard_to_fen(ChessBoard *cb);
-
-ChessPiece *        chessboard_get(ChessBoard *cb, uint8_t file, uint8_t rank);
-
-bool                chessboard_make_move(ChessBoard *cb, ChessMove move);
-bool                chessboard_unmake_move(ChessBoard *cb, ChessMove move);
-
-size_t              chessboard_pseudolegal_moves(ChessBoard *board, ChessMove *out);
-
-#endif
-
+// libchess
+// Jack O'Connor 2025
+// include/chessboard.h
+
+#ifndef CHESSBOARD_H
+#define CHESSBOARD_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "arena.h"
+#include "chesspiece.h"
+#include "bitboard.h"
+
+
+#define MAX_MOVES   (256)
+#define COLOR_ARR_INDEX(color)  ((color == WHITE) ? 0 : 1)
+#define PIECE_ARR_INDEX(piece)  (piece & (PIECE_TYPE_BITMASK | PIECE_COLOR_BITMASK))
+
+#define BB_IDX_ALL              (7)
+#define BB_IDX_COLOR(color)     (color)
+#define BB_IDX_PIECE(piece)     ((piece) & (PIECE_TYPE_BITMASK | PIECE_COLOR_BITMASK))
+
+#define MOVE_FROM(move)                     ((move) & 0x3F)
+#define MOVE_TO(move)                       (((move) >> 6) & 0x3F)
+#define MOVE_PROMOTION(move)                (((move) >> 12) & PIECE_TYPE_BITMASK)
+#define MOVE_CREATE(from, to, promotion)    ((ChessMove)((from) | ((to) << 6) | ((promotion) << 12)))
+
+#define CHESSBOARD_FEN_SIZE     (128) // Longest FEN (two 20-digit counters) and its NUL
+
+/* Types */
+
+typedef struct { // Irreversible state saved by chessboard_make_move_with (owned by the caller)
+    ChessPiece  captured;
+    uint8_t     castle_ability_w;
+    uint8_t     castle_ability_b;
+    int8_t      enpassant_target;
+    uint8_t     king_pos_w;
+    uint8_t     king_pos_b;
+    size_t      halfmove_clock;
+    uint64_t    key;                // Position key before the move
+} ChessUndo;
+
+typedef void (*ChessPrefetchFunc)(void *arg, uint64_t key);
+
+typedef struct {
+    ChessPiece  board[64];
+    size_t      halfmove_clock;
+    size_t      fullmove_counter;
+    uint64_t    key;                // Zobrist key, updated incrementally
+
+    Bitboard    locations[16];
+
+    Bitboard    targets[16];
+
+    uint8_t     to_move;
+    int8_t      enpassant_target;
+    uint8_t     castle_ability_w;
+    uint8_t     castle_ability_b;
+
+    uint8_t     king_pos_w;
+    uint8_t     king_pos_b;
+
+    ChessPrefetchFunc   prefetch;   // Called by make_move as soon as the new key is known (or NULL)
+    void               *prefetch_arg;
+} ChessBoard;
+
+typedef uint16_t ChessMove;
+
+
+/* Enums */
+
+enum ChessSliderMode { // Sliding piece move generator
+    SLIDERS_RAYS    = 0,
+    SLIDERS_MAGIC   = 1
+};
+
+
+/* Inline Functions */
+
+/**
+ * Access a piece from a ChessBoard structure
+ *
+ * @param   cb      Pointer to ChessBoard structure.
+ * @param   file    File (0 indexed) of desired piece.
+ * @param   rank    Rank (0 indexed) of desired piece.
+ *
+ * @return  Pointer to ChessPiece structure, or NULL if coordinates invalid.
+**/
+static inline ChessPiece *  chessboard_get(ChessBoard *cb, uint8_t file, uint8_t rank) {
+
+    if (file >= 8 || rank >= 8) return NULL;
+
+    return cb->board + (rank * 8) + file;
+}
+
+/**
+ * Look up the piece on a square.
+ *
+ * @param   cb      Pointer to ChessBoard structure.
+ * @param   square  Square (0-63).
+ *
+ * @return  ChessPiece on the square, or EMPTY.
+**/
+static inline ChessPiece    chessboard_piece_at(const ChessBoard *cb, uint8_t square) {
+    return cb->board[square];
+}
+
+/**
+ * Bitboard of one piece kind, e.g. (KNIGHT | BLACK). A bare color gives
+ * all pieces of that color.
+ *
+ * @param   cb      Pointer to ChessBoard structure.
+ * @param   piece   ChessPiece (type and color), or WHITE or BLACK.
+ *
+ * @return  Bitboard of the squares holding such pieces.
+**/
+static inline Bitboard      chessboard_bitboard(const ChessBoard *cb, ChessPiece piece) {
+    return cb->locations[BB_IDX_PIECE(piece)];
+}
+
+
+/* External Function */
+
+ChessBoard *        chessboard_create(const char *fen);
+ChessBoard *        chessboard_create_in(Arena *arena, const char *fen);
+bool                chessboard_init(ChessBoard *cb, const char *fen);
+const char *        chessboard_parse_fen(ChessBoard *cb, const char *fen);
+void                chessboard_refresh(ChessBoard *cb);
+void                chessboard_delete(ChessBoard *cb);
+void                chessboard_dump(ChessBoard *cb, FILE *stream);
+char *              chessboard_to_fen(ChessBoard *cb);
+size_t              chessboard_write_fen(const ChessBoard *cb, char *buf, size_t size);
+
+uint64_t            chessboard_compute_key(ChessBoard *cb);
+
+bool                chessboard_make_move(ChessBoard *cb, ChessMove move);
+bool                chessboard_make_move_with(ChessBoard *cb, ChessMove move, ChessUndo *undo);
+bool                chessboard_unmake_move_with(ChessBoard *cb, ChessMove move, const ChessUndo *undo);
+
+bool                chessboard_square_attacked(ChessBoard *cb, uint8_t square, ChessPiece color);
+bool                chessboard_in_check(ChessBoard *cb, ChessPiece color);
+
+size_t              chessboard_pseudolegal_moves(ChessBoard *board, ChessMove *out);
+size_t              chessboard_legal_moves(ChessBoard *cb, ChessMove *out);
+size_t              chessboard_count_legal_moves(ChessBoard *cb);
+void                chessboard_set_slider_mode(enum ChessSliderMode mode);
+void                chessboard_set_prefetch(ChessBoard *cb, ChessPrefetchFunc func, void *arg);
+
+void                chessmove_to_string(ChessMove move, char *out);
+bool                chessboard_move_from_string(ChessBoard *cb, const char *str, ChessMove *move);
+bool                chessboard_move_from_san(ChessBoard *cb, const char *str, ChessMove *move);
+
+size_t              chessboard_perft(ChessBoard *cb, size_t depth);
+
+#endif
+
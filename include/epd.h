@@ -0,0 +1,35 @@
+/* libchess
+ * Jack O'Connor 2025
+ * include/epd.h
+ */
+
+#ifndef EPD_H
+#define EPD_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "chessboard.h"
+
+
+/* Types */
+
+typedef struct { // Positions of an EPD file, one per line
+    char           *text;               // Copy of the input; fens and operations point into it
+    size_t          count;
+    size_t          invalid;            // Lines skipped because their FEN did not parse
+
+    ChessBoard     *boards;             // count positions in one contiguous allocation
+    const char    **fens;               // FEN fields of each line
+    const char    **operations;         // Rest of each line after the FEN ("" if none)
+} EpdFile;
+
+
+/* Function Headers */
+
+EpdFile *   epd_load(const char *path);
+EpdFile *   epd_parse(const char *text, size_t length);
+void        epd_delete(EpdFile *epd);
+
+
+#endif
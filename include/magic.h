@@ -0,0 +1,55 @@
+/* libchess
+ * Jack O'Connor 2025
+ * include/magic.h
+ */
+
+#ifndef MAGIC_H
+#define MAGIC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "bitboard.h"
+
+
+/* Constants */
+
+#define MAGIC_BISHOP_TABLE_SIZE (5248)
+#define MAGIC_ROOK_TABLE_SIZE   (102400)
+
+
+/* Types */
+
+typedef struct {
+    Bitboard    mask;       // Relevant occupancy (ray squares excluding board edges)
+    Bitboard    magic;
+    uint32_t    offset;     // Start of this square's slice of the shared attack table
+    uint8_t     shift;
+} Magic;
+
+
+/* Globals */
+
+// Generated into src/tables.c at build time (see src/gen_tables.c)
+extern const Magic      MAGIC_BISHOP[64];
+extern const Magic      MAGIC_ROOK[64];
+extern const Bitboard   MAGIC_BISHOP_TABLE[MAGIC_BISHOP_TABLE_SIZE];
+extern const Bitboard   MAGIC_ROOK_TABLE[MAGIC_ROOK_TABLE_SIZE];
+
+extern const Bitboard   BETWEEN[64][64];    // Squares strictly between two aligned squares
+extern const Bitboard   LINE[64][64];       // Full line through two aligned squares (0 if not aligned)
+
+
+/* Macro Functions */
+
+#define magic_index(m, occupancy)                   (((((occupancy) & (m)->mask) * (m)->magic) >> (m)->shift))
+#define magic_bishop_attacks(square, occupancy)     (MAGIC_BISHOP_TABLE[MAGIC_BISHOP[square].offset + magic_index(&MAGIC_BISHOP[square], occupancy)])
+#define magic_rook_attacks(square, occupancy)       (MAGIC_ROOK_TABLE[MAGIC_ROOK[square].offset + magic_index(&MAGIC_ROOK[square], occupancy)])
+#define magic_queen_attacks(square, occupancy)      (magic_bishop_attacks(square, occupancy) | magic_rook_attacks(square, occupancy))
+
+/* Function Headers */
+
+Bitboard    magic_slow_attacks(uint8_t square, Bitboard occupancy, bool bishop);
+
+
+#endif
@@ -0,0 +1,57 @@
+/* libchess
+ * Jack O'Connor 2025
+ * include/perft.h
+ */
+
+#ifndef PERFT_H
+#define PERFT_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "chessboard.h"
+
+
+/* Types */
+
+typedef struct { // Lockless: an entry is valid only if check ^ data == key
+    _Atomic uint64_t    check;
+    _Atomic uint64_t    data;      // nodes << 8 | depth
+} PerftHashEntry;
+
+typedef struct {
+    PerftHashEntry *entries;
+    size_t          mask;           // Entry count - 1 (power of two)
+
+    atomic_size_t   hits;
+    atomic_size_t   misses;
+    atomic_size_t   overwrites;     // Stores that evicted a different position
+} PerftHash;
+
+typedef struct {
+    ChessMove   move;
+    size_t      nodes;
+} PerftDivide;
+
+typedef struct {
+    size_t      nodes;
+    double      seconds;
+    double      nps;
+    size_t      steals;
+
+    size_t      moves_count;
+    PerftDivide divide[MAX_MOVES];  // Leaf nodes below each legal root move
+} PerftResult;
+
+
+/* Function Headers */
+
+PerftHash * perft_hash_create(size_t megabytes);
+void        perft_hash_delete(PerftHash *hash);
+
+bool        perft_run(ChessBoard *cb, size_t depth, size_t threads, PerftHash *hash, PerftResult *result);
+
+
+#endif
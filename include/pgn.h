@@ -0,0 +1,92 @@
+/* libchess
+ * Jack O'Connor 2025
+ * include/pgn.h
+ */
+
+#ifndef PGN_H
+#define PGN_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "chessboard.h"
+
+
+/* Constants */
+
+#define PGN_MAX_TAGS        (32)        // Further tags of a game are skipped, except FEN and SetUp
+#define PGN_MAX_SAN         (16)        // Longest move token replayed
+#define PGN_RELEASE_SIZE    (64 << 20)  // Consumed bytes are unmapped in steps of this size
+
+
+/* Types */
+
+typedef struct { // View into the input; not NUL-terminated
+    const char *ptr;
+    size_t      length;
+} PgnSpan;
+
+typedef struct {
+    PgnSpan     name;
+    PgnSpan     value;                  // Between the quotes, escapes left in place
+} PgnTag;
+
+typedef struct {
+    int         type;                   // enum PgnTokenType
+    PgnSpan     text;
+} PgnToken;
+
+typedef struct { // One game, pointing into the reader's input
+    size_t      index;                  // Position in the input (0 is the first game)
+    size_t      offset;                 // Byte offset of the first tag
+    PgnSpan     text;                   // Whole game, tags through termination marker
+
+    size_t      tags_count;
+    PgnTag      tags[PGN_MAX_TAGS];
+
+    PgnSpan     movetext;
+    PgnSpan     result;                 // Termination marker (empty if missing)
+} PgnGame;
+
+typedef struct {
+    const char *data;
+    size_t      size;
+    size_t      cursor;                 // Offset of the next unread byte
+
+    int         fd;                     // Mapped file (or -1 for caller memory)
+    size_t      released;               // Bytes already returned to the kernel
+
+    size_t      games;                  // Games yielded so far
+} PgnReader;
+
+
+/* Enums */
+
+enum PgnTokenType {
+    PGN_TOKEN_NONE          = 0,
+    PGN_TOKEN_TAG,                      // [Name "Value"]
+    PGN_TOKEN_MOVE,                     // SAN, including any suffix
+    PGN_TOKEN_NUMBER,                   // Move number indication such as "12." or "12..."
+    PGN_TOKEN_COMMENT,                  // {...} or ; to end of line
+    PGN_TOKEN_NAG,                      // $n, or a free-standing !, ?, !? ...
+    PGN_TOKEN_VARIATION_START,
+    PGN_TOKEN_VARIATION_END,
+    PGN_TOKEN_RESULT,                   // 1-0, 0-1, 1/2-1/2 or *
+};
+
+
+/* Function Headers */
+
+PgnReader * pgn_open(const char *path);
+PgnReader * pgn_open_memory(const char *data, size_t size);
+void        pgn_close(PgnReader *reader);
+void        pgn_release(PgnReader *reader, size_t offset);
+
+bool        pgn_next_token(const char **cursor, const char *end, PgnToken *token);
+bool        pgn_next_game(PgnReader *reader, PgnGame *game);
+bool        pgn_game_tag(const PgnGame *game, const char *name, PgnSpan *value);
+bool        pgn_replay(const PgnGame *game, ChessBoard *cb, ChessMove *moves, size_t capacity, size_t *plies);
+
+
+#endif
@@ -0,0 +1,93 @@
+/* libchess
+ * Jack O'Connor 2025
+ * include/pgn_pipeline.h
+ */
+
+#ifndef PGN_PIPELINE_H
+#define PGN_PIPELINE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "chessboard.h"
+#include "pgn.h"
+
+
+/* Constants */
+
+#define PGN_CHUNK_SIZE      (1 << 20)   // Default bytes of PGN text per chunk
+#define PGN_MAX_PLIES       (1024)      // Moves of a game kept for the game callback
+
+
+/* Types */
+
+typedef struct { // Growable byte buffer, reused from chunk to chunk
+    char       *data;
+    size_t      length;
+    size_t      capacity;
+} PgnOutput;
+
+typedef struct { // One replayed game, handed to the game callback on a worker thread
+    const PgnGame      *game;
+    ChessBoard         *board;          // Position after the last legal move
+    const ChessMove    *moves;          // First PGN_MAX_PLIES moves of the main line
+    size_t              plies;
+    bool                legal;
+} PgnReplay;
+
+typedef struct { // One game, handed to the write callback in input order
+    size_t      index;
+    size_t      offset;                 // Byte offset of the game in the input
+    size_t      plies;
+    bool        legal;
+    const char *data;                   // Bytes the game callback wrote for this game
+    size_t      length;
+} PgnRecord;
+
+typedef void (*PgnGameFunc)(const PgnReplay *replay, PgnOutput *out, void *arg);
+typedef void (*PgnWriteFunc)(const PgnRecord *record, void *arg);
+
+typedef struct { // Zero fields take defaults
+    size_t          workers;            // Replay threads (0 for one per online CPU)
+    size_t          chunk_size;         // Bytes per chunk (PGN_CHUNK_SIZE)
+    size_t          chunks;             // Chunks in flight, bounding memory (2 * workers + 2)
+
+    PgnGameFunc     game;               // Called on a worker thread per game (or NULL)
+    PgnWriteFunc    write;              // Called on the calling thread per game, in order (or NULL)
+    void           *arg;
+} PgnPipelineOptions;
+
+typedef struct {
+    size_t      games;
+    size_t      illegal;
+    size_t      plies;
+    size_t      chunks;
+    size_t      bytes;
+    double      seconds;
+
+    size_t      workers;
+    double      reader_busy;            // Splitting input into chunks
+    double      reader_wait;            // Blocked until a chunk was free
+    double      worker_busy;            // Summed over workers
+    double      worker_idle;            // Worker time not spent on chunks
+    double      writer_busy;
+    double      writer_wait;            // Blocked until a replayed chunk arrived
+
+    size_t      work_depth_max;         // Chunks queued for workers, sampled per push
+    double      work_depth_mean;
+    size_t      done_depth_max;         // Replayed chunks queued for the writer, sampled per push
+    double      done_depth_mean;
+    size_t      reorder_max;            // Chunks held back waiting for an earlier one
+} PgnPipelineStats;
+
+
+/* Function Headers */
+
+bool        pgn_output_append(PgnOutput *out, const void *data, size_t length);
+bool        pgn_output_printf(PgnOutput *out, const char *format, ...);
+
+bool        pgn_pipeline_run(PgnReader *reader, const PgnPipelineOptions *options, PgnPipelineStats *stats);
+
+
+#endif
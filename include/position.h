@@ -0,0 +1,63 @@
+/* libchess
+ * Jack O'Connor 2025
+ * include/position.h
+ */
+
+#ifndef POSITION_H
+#define POSITION_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "bitboard.h"
+#include "chessboard.h"
+
+
+/* Constants */
+
+#define POSITION_CASTLE_W_LONG      (1 << 0)    // Same packing as zobrist_castle_index
+#define POSITION_CASTLE_W_SHORT     (1 << 1)
+#define POSITION_CASTLE_B_LONG      (1 << 2)
+#define POSITION_CASTLE_B_SHORT     (1 << 3)
+
+
+/* Types */
+
+typedef struct { // Bitboards only, cheap to copy (no mailbox, attack maps or undo stack)
+    Bitboard    colors[2];              // Indexed by COLOR_ARR_INDEX
+    Bitboard    pieces[6];              // Indexed by piece type - 1, both colors
+    uint64_t    key;                    // Same Zobrist key as the ChessBoard
+
+    uint16_t    halfmove_clock;         // Saturates
+    uint16_t    fullmove_counter;       // Saturates
+    uint8_t     to_move;                // WHITE or BLACK
+    int8_t      enpassant_target;
+    uint8_t     castle;                 // POSITION_CASTLE_* flags
+} Position;
+
+
+/* Macro Functions */
+
+#define position_occupancy(pos)             ((pos)->colors[0] | (pos)->colors[1])
+#define position_bitboard(pos, type, color) ((pos)->pieces[(type) - 1] & (pos)->colors[COLOR_ARR_INDEX(color)])
+
+
+/* Function Headers */
+
+bool        position_init(Position *pos, const char *fen);
+void        position_from_chessboard(Position *pos, const ChessBoard *cb);
+void        position_to_chessboard(const Position *pos, ChessBoard *cb);
+
+ChessPiece  position_piece_at(const Position *pos, uint8_t square);
+bool        position_square_attacked(const Position *pos, uint8_t square, ChessPiece color);
+bool        position_in_check(const Position *pos);
+
+size_t      position_legal_moves(const Position *pos, ChessMove *out);
+size_t      position_count_legal_moves(const Position *pos);
+void        position_make_move(Position *pos, ChessMove move);
+
+size_t      position_perft(const Position *pos, size_t depth);
+
+
+#endif
@@ -0,0 +1,67 @@
+/* libchess
+ * Jack O'Connor 2025
+ * include/search.h
+ */
+
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "chessboard.h"
+#include "ttable.h"
+
+
+/* Constants */
+
+#define SEARCH_MAX_PLY      (64)
+#define SEARCH_INFINITY     (32000)
+#define SEARCH_MATE         (31000)     // Mate in n plies scores SEARCH_MATE - n
+
+
+/* Types */
+
+typedef struct {
+    size_t      depth;                  // Depth of the last completed iteration
+    int         score;                  // Centipawns from the side to move's point of view
+    size_t      nodes;
+    double      seconds;
+    double      nps;
+
+    size_t      pv_length;
+    ChessMove   pv[SEARCH_MAX_PLY];     // Principal variation (pv[0] is the best move)
+} SearchResult;
+
+typedef void (*SearchInfoFunc)(const SearchResult *info, void *arg);
+
+typedef struct { // Zero fields mean "no limit"
+    size_t          depth;
+    size_t          nodes;
+    double          seconds;
+
+    size_t          threads;            // Lazy SMP threads, all sharing tt (0 or 1 for one)
+    TTable         *tt;                 // Transposition table (or NULL)
+    atomic_bool    *stop;               // Raised by another thread to abort (or NULL)
+    SearchInfoFunc  info;               // Called after every completed iteration (or NULL)
+    void           *info_arg;
+
+    const uint64_t *history;            // Keys of the game positions before the root, oldest first (or NULL)
+    size_t          history_count;
+} SearchLimits;
+
+
+/* Macro Functions */
+
+#define search_is_mate(score)   ((score) > SEARCH_MATE - SEARCH_MAX_PLY || (score) < -SEARCH_MATE + SEARCH_MAX_PLY)
+
+
+/* Function Headers */
+
+int         search_evaluate(ChessBoard *cb);
+bool        chessboard_search(ChessBoard *cb, const SearchLimits *limits, SearchResult *result);
+
+
+#endif
@@ -0,0 +1,26 @@
+/* libchess
+ * Jack O'Connor 2025
+ * include/tables.h
+ */
+
+#ifndef TABLES_H
+#define TABLES_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "bitboard.h"
+#include "magic.h"
+
+
+/* Function Headers */
+
+void        tables_compute_leapers(Bitboard knight[64], Bitboard king[64], Bitboard pawn[2][64]);
+void        tables_compute_magics(Magic magics[64], Bitboard *table, bool bishop);
+void        tables_compute_lines(Bitboard between[64][64], Bitboard line[64][64]);
+void        tables_compute_zobrist(uint64_t pieces[16][64], uint64_t castle[16], uint64_t enpassant[8], uint64_t *side);
+
+Bitboard    tables_ray_attacks(uint8_t square, Bitboard occupancy, bool bishop);
+
+
+#endif
@@ -0,0 +1,65 @@
+/* libchess
+ * Jack O'Connor 2025
+ * include/threadpool.h
+ */
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+
+/* Types */
+
+typedef void (*ThreadPoolFunc)(void *arg);
+
+typedef struct {
+    ThreadPoolFunc  func;
+    void           *arg;
+} ThreadPoolTask;
+
+typedef struct ThreadPool ThreadPool;
+
+typedef struct { // Double-ended queue owned by one worker
+    ThreadPool     *pool;
+    pthread_t       thread;
+    size_t          index;
+
+    pthread_mutex_t lock;
+    ThreadPoolTask *tasks;          // Ring buffer
+    size_t          capacity;       // Power of two
+    size_t          top;            // Thieves take from here (oldest)
+    size_t          bottom;         // Owner pushes/pops here (newest)
+} ThreadPoolWorker;
+
+struct ThreadPool {
+    ThreadPoolWorker   *workers;
+    size_t              workers_count;
+
+    pthread_mutex_t     lock;
+    pthread_cond_t      work_ready;
+    pthread_cond_t      work_done;
+
+    atomic_size_t       queued;     // Tasks waiting in deques
+    atomic_size_t       pending;    // Tasks submitted but not finished
+    atomic_size_t       idle;       // Workers sleeping on work_ready
+    atomic_size_t       next;       // Round-robin target for external submits
+    atomic_size_t       steals;
+    bool                shutdown;
+};
+
+
+/* Function Headers */
+
+ThreadPool *    threadpool_create(size_t threads);
+void            threadpool_delete(ThreadPool *pool);
+
+bool            threadpool_submit(ThreadPool *pool, ThreadPoolFunc func, void *arg);
+void            threadpool_wait(ThreadPool *pool);
+size_t          threadpool_idle(ThreadPool *pool);
+
+
+#endif
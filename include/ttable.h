@@ -0,0 +1,71 @@
+/* libchess
+ * Jack O'Connor 2025
+ * include/ttable.h
+ */
+
+#ifndef TTABLE_H
+#define TTABLE_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "chessboard.h"
+
+
+/* Constants */
+
+#define TTABLE_BUCKET_SIZE  (4)     // Entries per 64-byte bucket (one cache line)
+
+
+/* Types */
+
+typedef struct { // Lockless: an entry is valid only if check ^ data == key
+    _Atomic uint64_t    check;
+    _Atomic uint64_t    data;       // move | score << 16 | depth << 32 | bound << 40 | age << 42
+} TTableEntry;
+
+typedef struct {
+    TTableEntry entries[TTABLE_BUCKET_SIZE];
+} __attribute__((aligned(64))) TTableBucket;
+
+typedef struct {
+    TTableBucket   *buckets;
+    size_t          mask;           // Bucket count - 1 (power of two)
+    size_t          size;           // Mapped bytes
+    uint8_t         age;            // Generation, bumped by ttable_new_search
+} TTable;
+
+typedef struct { // Unpacked entry
+    ChessMove   move;
+    int16_t     score;
+    uint8_t     depth;
+    uint8_t     bound;
+} TTableHit;
+
+
+/* Enums */
+
+enum TTableBound {
+    TTABLE_NONE     = 0,
+    TTABLE_UPPER    = 1,            // Score is at most the stored value (failed low)
+    TTABLE_LOWER    = 2,            // Score is at least the stored value (failed high)
+    TTABLE_EXACT    = 3
+};
+
+
+/* Function Headers */
+
+TTable *    ttable_create(size_t megabytes);
+void        ttable_delete(TTable *tt);
+void        ttable_clear(TTable *tt);
+void        ttable_new_search(TTable *tt);
+
+bool        ttable_probe(TTable *tt, uint64_t key, TTableHit *hit);
+void        ttable_store(TTable *tt, uint64_t key, ChessMove move, int score, uint8_t depth, uint8_t bound);
+void        ttable_prefetch(void *tt, uint64_t key);
+size_t      ttable_hashfull(TTable *tt);
+
+
+#endif
@@ -0,0 +1,26 @@
+/* libchess
+ * Jack O'Connor 2025
+ * include/zobrist.h
+ */
+
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+#include <stdint.h>
+
+
+/* Globals */
+
+// Fixed seed, so keys are stable across processes and builds
+extern const uint64_t ZOBRIST_PIECES[16][64];   // Indexed by BB_IDX_PIECE(piece), square
+extern const uint64_t ZOBRIST_CASTLE[16];       // Indexed by zobrist_castle_index
+extern const uint64_t ZOBRIST_ENPASSANT[8];     // Indexed by file
+extern const uint64_t ZOBRIST_SIDE;             // Black to move
+
+
+/* Macro Functions */
+
+#define zobrist_castle_index(castle_w, castle_b)    ((((castle_w) >> 4) & 3) | ((((castle_b) >> 4) & 3) << 2))
+
+
+#endif
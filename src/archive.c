@@ -0,0 +1,511 @@
+/* libchess
+ * Jack O'Connor 2025
+ * src/archive.c
+ */
+
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "archive.h"
+
+
+/* Macro Functions */
+
+#define archive_pad4(n)     (((n) + 3) & ~(size_t)3)
+#define archive_pad8(n)     (((n) + 7) & ~(size_t)7)
+
+
+/* Internal Functions */
+
+/**
+ * Write bytes to the archive and track the file offset.
+ *
+ * @param   aw      Pointer to ArchiveWriter structure.
+ * @param   data    Bytes to write (NULL writes zeros).
+ * @param   length  Number of bytes.
+ *
+ * @return  `true` if successful, `false` otherwise.
+**/
+static bool     writer_put(ArchiveWriter *aw, const void *data, size_t length) {
+
+    static const char zeros[8] = { 0 };
+    if (!data && length > sizeof(zeros)) return false;
+    if (length && fwrite((data) ? data : zeros, 1, length, aw->stream) != length) return false;
+    aw->offset += length;
+    return true;
+}
+
+static uint64_t intern_hash(const char *s, size_t length) {
+    uint64_t hash = 0xCBF29CE484222325lu;
+    for (size_t i = 0; i < length; i++) hash = (hash ^ (uint8_t)s[i]) * 0x100000001B3lu;
+    return hash;
+}
+
+/**
+ * Rebuild the slot table of an interning table at twice its size.
+ *
+ * @param   in      Pointer to ArchiveIntern structure.
+ *
+ * @return  `true` if successful, `false` otherwise.
+**/
+static bool     intern_grow(ArchiveIntern *in) {
+
+    size_t slots_count = (in->slots) ? (in->mask + 1) * 2 : 1024;
+    uint32_t *slots = (uint32_t *) calloc(slots_count, sizeof(uint32_t));
+    if (!slots) return false;
+
+    for (uint32_t id = 0; id < in->count; id++) {
+        size_t slot = intern_hash(in->bytes + in->offsets[id], in->offsets[id + 1] - in->offsets[id]);
+        while (slots[slot & (slots_count - 1)]) slot++;
+        slots[slot & (slots_count - 1)] = id + 1;
+    }
+
+    free(in->slots);
+    in->slots = slots;
+    in->mask = slots_count - 1;
+    return true;
+}
+
+/**
+ * Find a string in an interning table, adding it if it is new.
+ *
+ * @param   in      Pointer to ArchiveIntern structure.
+ * @param   s       String bytes.
+ * @param   length  Number of bytes.
+ * @param   limit   Largest number of strings the table may hold.
+ * @param   id      Pointer to the string's id to populate.
+ *
+ * @return  `true` if successful, `false` if the string is new and the table
+ *          is full (or could not grow).
+**/
+static bool     intern_add(ArchiveIntern *in, const char *s, size_t length, size_t limit, uint32_t *id) {
+
+    if (!in->slots || (in->count + 1) * 2 > in->mask + 1) {
+        if (!intern_grow(in)) return false;
+    }
+
+    size_t slot = intern_hash(s, length);
+    for (; in->slots[slot & in->mask]; slot++) {
+        uint32_t other = in->slots[slot & in->mask] - 1;
+        if (in->offsets[other + 1] - in->offsets[other] == length &&
+            !memcmp(in->bytes + in->offsets[other], s, length)) {
+            *id = other;
+            return true;
+        }
+    }
+
+    if (in->count >= limit || in->length + length > UINT32_MAX) return false;
+
+    if (in->length + length > in->capacity) {
+        size_t capacity = (in->capacity) ? in->capacity : 4096;
+        while (capacity < in->length + length) capacity *= 2;
+        char *bytes = (char *) realloc(in->bytes, capacity);
+        if (!bytes) return false;
+        in->bytes = bytes;
+        in->capacity = capacity;
+    }
+    if (in->count + 2 > in->offsets_capacity) {
+        size_t capacity = (in->offsets_capacity) ? in->offsets_capacity * 2 : 1024;
+        uint32_t *offsets = (uint32_t *) realloc(in->offsets, capacity * sizeof(uint32_t));
+        if (!offsets) return false;
+        in->offsets = offsets;
+        in->offsets_capacity = capacity;
+    }
+
+    memcpy(in->bytes + in->length, s, length);
+    in->offsets[in->count] = in->length;
+    in->length += length;
+    in->offsets[in->count + 1] = in->length;
+
+    in->slots[slot & in->mask] = in->count + 1;
+    *id = in->count++;
+    return true;
+}
+
+/**
+ * Write an interning table as a string table, padded to eight bytes.
+ *
+ * @param   aw      Pointer to ArchiveWriter structure.
+ * @param   in      Pointer to ArchiveIntern structure.
+ *
+ * @return  `true` if successful, `false` otherwise.
+**/
+static bool     writer_put_strings(ArchiveWriter *aw, const ArchiveIntern *in) {
+
+    uint32_t first = 0;
+    size_t start = aw->offset;
+    bool success = writer_put(aw, &in->count, sizeof(uint32_t)) &&
+                   writer_put(aw, (in->count) ? in->offsets : &first, (in->count + 1) * sizeof(uint32_t)) &&
+                   writer_put(aw, in->bytes, in->length);
+    return success && writer_put(aw, NULL, archive_pad8(aw->offset - start) - (aw->offset - start));
+}
+
+static void     intern_free(ArchiveIntern *in) {
+    free(in->bytes);
+    free(in->offsets);
+    free(in->slots);
+}
+
+/**
+ * Point an ArchiveStrings view at a string table inside the mapping.
+ *
+ * @param   ar      Pointer to ArchiveReader structure.
+ * @param   offset  Offset of the table.
+ * @param   strings Pointer to ArchiveStrings structure to populate.
+ *
+ * @return  `true` if the table lies inside the file, `false` otherwise.
+**/
+static bool     reader_strings(ArchiveReader *ar, uint64_t offset, ArchiveStrings *strings) {
+
+    if (offset > ar->size || ar->size - offset < sizeof(uint32_t) || offset % 4) return false;
+    strings->count = *(const uint32_t *)(ar->data + offset);
+    size_t left = ar->size - offset - sizeof(uint32_t);
+    if (left / sizeof(uint32_t) <= strings->count) return false;
+
+    strings->offsets = (const uint32_t *)(ar->data + offset + sizeof(uint32_t));
+    strings->bytes = (const char *)(strings->offsets + strings->count + 1);
+    if (left - (strings->count + (size_t) 1) * sizeof(uint32_t) < strings->offsets[strings->count]) return false;
+
+    // Every string must lie inside the table, so archive_string needs no checks of its own
+    for (uint32_t id = 0; id < strings->count; id++) {
+        if (strings->offsets[id] > strings->offsets[id + 1]) return false;
+    }
+    return true;
+}
+
+
+/* External Functions */
+
+/**
+ * Create an archive file and its writer.
+ *
+ * @param   path    Path of the archive to create (truncated if it exists).
+ *
+ * @return  Pointer to new ArchiveWriter structure, or NULL if error.
+**/
+ArchiveWriter * archive_writer_create(const char *path) {
+
+    ArchiveWriter *aw = (ArchiveWriter *) calloc(1, sizeof(ArchiveWriter));
+    if (!aw) return NULL;
+
+    // "FEN" is interned up front, so a full name table can never drop it
+    uint32_t fen;
+    aw->stream = fopen(path, "wb");
+    ArchiveFileHeader header = { 0 };
+    if (!aw->stream || !writer_put(aw, &header, sizeof(header)) ||
+        !intern_add(&aw->names, "FEN", 3, ARCHIVE_MAX_NAMES, &fen)) {
+        if (aw->stream) fclose(aw->stream);
+        intern_free(&aw->names);
+        free(aw);
+        return NULL;
+    }
+
+    return aw;
+}
+
+/**
+ * Append one game. Tag names and values are interned, so each distinct
+ * string is stored once per archive. Tags beyond the archive limits are
+ * dropped, except the FEN tag: a slot is kept for it, and the game is
+ * rejected if it still cannot be stored (its moves only replay from there).
+ *
+ * @param   aw          Pointer to ArchiveWriter structure.
+ * @param   tags        Tags of the game.
+ * @param   tags_count  Number of tags.
+ * @param   result      enum ArchiveResult.
+ * @param   moves       Main line, legal from the starting position.
+ * @param   plies       Number of moves.
+ *
+ * @return  `true` if successful, `false` otherwise.
+**/
+bool            archive_writer_add(ArchiveWriter *aw, const PgnTag *tags, size_t tags_count, uint8_t result,
+                                   const ChessMove *moves, size_t plies) {
+
+    if (plies > ARCHIVE_MAX_PLIES) return false;
+
+    if (aw->games == aw->index_capacity) {
+        size_t capacity = (aw->index_capacity) ? aw->index_capacity * 2 : 1024;
+        uint64_t *index = (uint64_t *) realloc(aw->index, capacity * sizeof(uint64_t));
+        if (!index) return false;
+        aw->index = index;
+        aw->index_capacity = capacity;
+    }
+
+    size_t fen = tags_count;
+    for (size_t i = 0; i < tags_count && fen == tags_count; i++) {
+        if (tags[i].name.length == 3 && !memcmp(tags[i].name.ptr, "FEN", 3)) fen = i;
+    }
+
+    uint8_t names[ARCHIVE_MAX_TAGS];
+    uint32_t values[ARCHIVE_MAX_TAGS];
+    ArchiveGameHeader header = { .plies = plies, .flags = result & ARCHIVE_RESULT_MASK };
+    for (size_t i = 0; i < tags_count; i++) {
+        size_t reserved = (fen < tags_count && i < fen) ? 1 : 0;
+        uint32_t name, value;
+        if (header.tags_count + reserved >= ARCHIVE_MAX_TAGS ||
+            !intern_add(&aw->names, tags[i].name.ptr, tags[i].name.length, ARCHIVE_MAX_NAMES, &name) ||
+            !intern_add(&aw->values, tags[i].value.ptr, tags[i].value.length, UINT32_MAX - 1, &value)) {
+            if (i == fen) return false;
+            aw->dropped++;
+            continue;
+        }
+
+        if (i == fen) header.flags |= ARCHIVE_FLAG_FEN;
+        names[header.tags_count] = name;
+        values[header.tags_count] = value;
+        header.tags_count++;
+    }
+
+    aw->index[aw->games++] = aw->offset;
+    return writer_put(aw, &header, sizeof(header)) &&
+           writer_put(aw, names, header.tags_count) &&
+           writer_put(aw, NULL, archive_pad4(header.tags_count) - header.tags_count) &&
+           writer_put(aw, values, header.tags_count * sizeof(uint32_t)) &&
+           writer_put(aw, moves, plies * sizeof(ChessMove)) &&
+           writer_put(aw, NULL, archive_pad4(plies * sizeof(ChessMove)) - plies * sizeof(ChessMove));
+}
+
+/**
+ * Write the string tables, the index and the file header, then close the
+ * file and deallocate ArchiveWriter structure.
+ *
+ * @param   aw      Pointer to ArchiveWriter structure.
+ *
+ * @return  `true` if the archive is complete, `false` otherwise.
+**/
+bool            archive_writer_close(ArchiveWriter *aw) {
+
+    if (!aw) return false;
+
+    ArchiveFileHeader header = { .magic = ARCHIVE_MAGIC, .games = aw->games };
+    bool success = aw->games <= UINT32_MAX;
+
+    success = success && writer_put(aw, NULL, archive_pad8(aw->offset) - aw->offset);
+    header.names_offset = aw->offset;
+    success = success && writer_put_strings(aw, &aw->names);
+    header.values_offset = aw->offset;
+    success = success && writer_put_strings(aw, &aw->values);
+    header.index_offset = aw->offset;
+    success = success && writer_put(aw, aw->index, aw->games * sizeof(uint64_t));
+
+    success = success && !fseek(aw->stream, 0, SEEK_SET) && fwrite(&header, sizeof(header), 1, aw->stream) == 1;
+    success = !fclose(aw->stream) && success;
+
+    intern_free(&aw->names);
+    intern_free(&aw->values);
+    free(aw->index);
+    free(aw);
+    return success;
+}
+
+/**
+ * Classify a PGN termination marker or Result tag value.
+ *
+ * @param   text    "1-0", "0-1", "1/2-1/2" or anything else.
+ *
+ * @return  enum ArchiveResult.
+**/
+uint8_t         archive_result(PgnSpan text) {
+    if (text.length == 3 && !memcmp(text.ptr, "1-0", 3)) return ARCHIVE_RESULT_WHITE;
+    if (text.length == 3 && !memcmp(text.ptr, "0-1", 3)) return ARCHIVE_RESULT_BLACK;
+    if (text.length == 7 && !memcmp(text.ptr, "1/2-1/2", 7)) return ARCHIVE_RESULT_DRAW;
+    return ARCHIVE_RESULT_UNKNOWN;
+}
+
+/**
+ * Map an archive read-only and check its layout.
+ *
+ * @param   path    Path of the archive.
+ *
+ * @return  Pointer to new ArchiveReader structure, or NULL if error.
+**/
+ArchiveReader * archive_open(const char *path) {
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) || (size_t) st.st_size < sizeof(ArchiveFileHeader)) {
+        close(fd);
+        return NULL;
+    }
+
+    void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return NULL;
+
+    ArchiveReader *ar = (ArchiveReader *) calloc(1, sizeof(ArchiveReader));
+    if (!ar) {
+        munmap(data, st.st_size);
+        return NULL;
+    }
+    position_init(&ar->start, NULL);
+
+    ar->data = (const char *) data;
+    ar->size = st.st_size;
+
+    const ArchiveFileHeader *header = (const ArchiveFileHeader *) data;
+    ar->games = header->games;
+
+    // Offsets are compared with what is left of the file, so a huge one cannot wrap around
+    bool valid = header->magic == ARCHIVE_MAGIC && header->index_offset % 8 == 0 &&
+                 header->index_offset <= ar->size &&
+                 (ar->size - header->index_offset) / sizeof(uint64_t) >= ar->games &&
+                 reader_strings(ar, header->names_offset, &ar->names) &&
+                 reader_strings(ar, header->values_offset, &ar->values);
+    if (!valid) {
+        archive_close(ar);
+        return NULL;
+    }
+    ar->index = (const uint64_t *)(ar->data + header->index_offset);
+
+    ar->fen_name = -1;
+    for (uint32_t id = 0; id < ar->names.count; id++) {
+        PgnSpan name;
+        if (archive_string(&ar->names, id, &name) && name.length == 3 && !memcmp(name.ptr, "FEN", 3)) {
+            ar->fen_name = id;
+        }
+    }
+
+    return ar;
+}
+
+/**
+ * Unmap the archive and deallocate ArchiveReader structure.
+ *
+ * @param   ar      Pointer to ArchiveReader structure.
+**/
+void            archive_close(ArchiveReader *ar) {
+    if (!ar) return;
+    munmap((void *) ar->data, ar->size);
+    free(ar);
+}
+
+/**
+ * Seek to a game through the index.
+ *
+ * @param   ar      Pointer to ArchiveReader structure.
+ * @param   index   Game number (0 is the first game).
+ * @param   game    Pointer to ArchiveGame structure to populate.
+ *
+ * @return  `true` if the game exists, `false` otherwise.
+**/
+bool            archive_game(ArchiveReader *ar, size_t index, ArchiveGame *game) {
+
+    if (index >= ar->games) return false;
+
+    uint64_t offset = ar->index[index];
+    if (offset % 4 || offset > ar->size || ar->size - offset < sizeof(ArchiveGameHeader)) return false;
+
+    const ArchiveGameHeader *header = (const ArchiveGameHeader *)(ar->data + offset);
+    size_t tags_size = archive_pad4(header->tags_count) + header->tags_count * sizeof(uint32_t);
+    size_t left = ar->size - offset - sizeof(ArchiveGameHeader);
+    if (left < tags_size || (left - tags_size) / sizeof(ChessMove) < header->plies) return false;
+
+    const char *names = (const char *)(header + 1);
+    const char *values = names + archive_pad4(header->tags_count);
+    const char *moves = values + header->tags_count * sizeof(uint32_t);
+
+    game->index = index;
+    game->result = header->flags & ARCHIVE_RESULT_MASK;
+    game->fen = header->flags & ARCHIVE_FLAG_FEN;
+    game->tags_count = header->tags_count;
+    game->names = (const uint8_t *) names;
+    game->values = (const uint32_t *) values;
+    game->plies = header->plies;
+    game->moves = (const ChessMove *) moves;
+    return true;
+}
+
+/**
+ * Look up an interned string.
+ *
+ * @param   strings Pointer to ArchiveStrings structure (names or values).
+ * @param   id      String id.
+ * @param   value   Pointer to PgnSpan to populate.
+ *
+ * @return  `true` if the id exists, `false` otherwise.
+**/
+bool            archive_string(const ArchiveStrings *strings, uint32_t id, PgnSpan *value) {
+    if (id >= strings->count) return false;
+    value->ptr = strings->bytes + strings->offsets[id];
+    value->length = strings->offsets[id + 1] - strings->offsets[id];
+    return true;
+}
+
+/**
+ * Look up a tag of a game by name.
+ *
+ * @param   ar      Pointer to ArchiveReader structure.
+ * @param   game    Pointer to ArchiveGame structure.
+ * @param   name    Tag name, e.g. "White".
+ * @param   value   Pointer to PgnSpan to populate with the value.
+ *
+ * @return  `true` if the tag is present, `false` otherwise.
+**/
+bool            archive_game_tag(ArchiveReader *ar, const ArchiveGame *game, const char *name, PgnSpan *value) {
+
+    size_t length = strlen(name);
+    for (size_t i = 0; i < game->tags_count; i++) {
+        PgnSpan tag;
+        if (archive_string(&ar->names, game->names[i], &tag) && tag.length == length &&
+            !memcmp(tag.ptr, name, length)) {
+            return archive_string(&ar->values, game->values[i], value);
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Replay a game from its stored moves (no parsing or move generation).
+ * The moves are played on a Position, which keeps no mailbox or attack
+ * maps, and the ChessBoard is built once from where it ends.
+ *
+ * @param   ar      Pointer to ArchiveReader structure.
+ * @param   game    Pointer to ArchiveGame structure.
+ * @param   cb      Pointer to ChessBoard structure, reset to the starting
+ *                  position and left after the last move.
+ *
+ * @return  `true` if successful, `false` otherwise.
+**/
+bool            archive_replay(ArchiveReader *ar, const ArchiveGame *game, ChessBoard *cb) {
+
+    Position pos = ar->start;
+    size_t halfmove_clock = 0, fullmove_counter = 1;
+    if (game->fen) {
+        char fen[CHESSBOARD_FEN_SIZE];
+        PgnSpan value;
+        if (!archive_game_tag(ar, game, "FEN", &value) || value.length >= sizeof(fen)) return false;
+        memcpy(fen, value.ptr, value.length);
+        fen[value.length] = '\0';
+
+        if (!chessboard_init(cb, fen)) return false;
+        position_from_chessboard(&pos, cb);
+        halfmove_clock = cb->halfmove_clock;
+        fullmove_counter = cb->fullmove_counter;
+    }
+    fullmove_counter += (game->plies + (pos.to_move == BLACK)) / 2;
+
+    // A move must lift a piece of the side to move and land on neither its
+    // own pieces nor a king, so a corrupt archive cannot break the bitboards
+    for (size_t i = 0; i < game->plies; i++) {
+        ChessMove move = game->moves[i];
+        Bitboard blocked = pos.colors[COLOR_ARR_INDEX(pos.to_move)] | pos.pieces[KING - 1];
+        ChessPiece promotion = MOVE_PROMOTION(move);
+        if (!(pos.colors[COLOR_ARR_INDEX(pos.to_move)] & (1lu << MOVE_FROM(move))) ||
+            (blocked & (1lu << MOVE_TO(move))) || promotion == PAWN || promotion > QUEEN) return false;
+        position_make_move(&pos, move);
+    }
+
+    // The Position's counters saturate; a saturated clock was never reset
+    position_to_chessboard(&pos, cb);
+    if (pos.halfmove_clock == UINT16_MAX) cb->halfmove_clock = halfmove_clock + game->plies;
+    cb->fullmove_counter = fullmove_counter;
+    return true;
+}
@@ -0,0 +1,388 @@
+/* libchess
+ * Jack O'Connor 2025
+ * src/archive_main.c
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "archive.h"
+#include "chessboard.h"
+#include "pgn.h"
+#include "pgn_pipeline.h"
+
+
+/* Types */
+
+typedef struct { // A replayed game as serialized by encode_game
+    uint32_t    plies;
+    uint8_t     tags_count;
+    uint8_t     result;
+} ConvertGame;
+// Then per tag: uint32_t name length, uint32_t value length, name, value; then ChessMove moves[plies]
+
+typedef struct {
+    const char     *path;               // PGN file being converted
+    ArchiveWriter  *writer;
+    bool            quiet;
+
+    size_t          games;              // Games stored
+    size_t          plies;
+    size_t          illegal;            // Games skipped
+    size_t          long_games;
+    bool            failed;             // A write to the archive failed
+
+    ChessMove       moves[ARCHIVE_MAX_PLIES];
+} ArchiveConvert;
+
+
+/* Functions */
+
+void    usage(const char *program, int status) {
+    fprintf(stderr, "Usage: %s convert [-j WORKERS] [-q] IN.pgn OUT.lca\n", program);
+    fprintf(stderr, "       %s replay FILE.lca [FILE.pgn]\n", program);
+    fprintf(stderr, "       %s show FILE.lca GAME\n", program);
+    fprintf(stderr, "    -j WORKERS  Replay the PGN on a pipeline with this many workers (0 for one per CPU)\n");
+    fprintf(stderr, "    -q          Do not report skipped games\n");
+    exit(status);
+}
+
+double  now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * Game callback: serialize a legal game's tags and moves for the writer
+ * (runs on a worker in pipeline mode). Illegal games write nothing.
+ *
+ * @param   replay  Pointer to PgnReplay structure.
+ * @param   out     Pointer to PgnOutput structure to append to.
+ * @param   arg     Pointer to ArchiveConvert structure.
+**/
+void    encode_game(const PgnReplay *replay, PgnOutput *out, void *arg) {
+
+    if (!replay->legal || replay->plies > ARCHIVE_MAX_PLIES) return;
+
+    const PgnGame *game = replay->game;
+    size_t length = out->length;
+    ConvertGame header = {
+        .plies      = replay->plies,
+        .tags_count = game->tags_count,
+        .result     = archive_result(game->result),
+    };
+    pgn_output_append(out, &header, sizeof(header));
+
+    for (size_t i = 0; i < game->tags_count; i++) {
+        uint32_t lengths[2] = { game->tags[i].name.length, game->tags[i].value.length };
+        pgn_output_append(out, lengths, sizeof(lengths));
+        pgn_output_append(out, game->tags[i].name.ptr, lengths[0]);
+        pgn_output_append(out, game->tags[i].value.ptr, lengths[1]);
+    }
+
+    if (replay->plies <= PGN_MAX_PLIES) {
+        pgn_output_append(out, replay->moves, replay->plies * sizeof(ChessMove));
+        return;
+    }
+
+    // Only the first PGN_MAX_PLIES moves were kept, so replay long games again
+    ChessMove *moves = (ChessMove *) malloc(replay->plies * sizeof(ChessMove));
+    ChessBoard cb;
+    size_t plies;
+    if (moves && pgn_replay(game, &cb, moves, replay->plies, &plies)) {
+        pgn_output_append(out, moves, plies * sizeof(ChessMove));
+    } else {
+        out->length = length;
+    }
+    free(moves);
+}
+
+/**
+ * Write callback: add a serialized game to the archive, in input order.
+ *
+ * @param   record  Pointer to PgnRecord structure.
+ * @param   arg     Pointer to ArchiveConvert structure.
+**/
+void    write_game(const PgnRecord *record, void *arg) {
+
+    ArchiveConvert *state = (ArchiveConvert *) arg;
+    if (!record->length) {
+        if (!state->quiet) {
+            fprintf(stderr, "%s: game %lu (byte %lu): %s, skipped\n", state->path, record->index + 1,
+                    record->offset, (record->legal) ? "too many plies" : "illegal move");
+        }
+        if (record->legal) state->long_games++;
+        else state->illegal++;
+        return;
+    }
+
+    ConvertGame header;
+    const char *cursor = record->data;
+    memcpy(&header, cursor, sizeof(header));
+    cursor += sizeof(header);
+
+    PgnTag tags[PGN_MAX_TAGS];
+    for (size_t i = 0; i < header.tags_count; i++) {
+        uint32_t lengths[2];
+        memcpy(lengths, cursor, sizeof(lengths));
+        cursor += sizeof(lengths);
+        tags[i].name = (PgnSpan) { cursor, lengths[0] };
+        tags[i].value = (PgnSpan) { cursor + lengths[0], lengths[1] };
+        cursor += lengths[0] + lengths[1];
+    }
+    memcpy(state->moves, cursor, header.plies * sizeof(ChessMove));
+
+    if (!archive_writer_add(state->writer, tags, header.tags_count, header.result, state->moves, header.plies)) {
+        state->failed = true;
+        return;
+    }
+    state->games++;
+    state->plies += header.plies;
+}
+
+/**
+ * Convert a PGN file to an archive.
+ *
+ * @param   options Pipeline options (or NULL to replay on this thread).
+ * @param   input   Path of the PGN file.
+ * @param   output  Path of the archive.
+ * @param   quiet   Do not report skipped games.
+ *
+ * @return  EXIT_SUCCESS or EXIT_FAILURE.
+**/
+int     convert(PgnPipelineOptions *options, const char *input, const char *output, bool quiet) {
+
+    ArchiveConvert *state = (ArchiveConvert *) calloc(1, sizeof(ArchiveConvert));
+    PgnReader *reader = pgn_open(input);
+    if (!state || !reader) {
+        fprintf(stderr, "Unable to open %s\n", input);
+        pgn_close(reader);
+        free(state);
+        return EXIT_FAILURE;
+    }
+    state->path = input;
+    state->quiet = quiet;
+    state->writer = archive_writer_create(output);
+    if (!state->writer) {
+        fprintf(stderr, "Unable to create %s\n", output);
+        pgn_close(reader);
+        free(state);
+        return EXIT_FAILURE;
+    }
+
+    double start = now();
+    if (options) {
+        options->game = encode_game;
+        options->write = write_game;
+        options->arg = state;
+        PgnPipelineStats stats;
+        if (!pgn_pipeline_run(reader, options, &stats)) state->failed = true;
+    } else {
+        ChessBoard cb;
+        ChessMove moves[PGN_MAX_PLIES];
+        PgnOutput out = { 0 };
+        PgnGame game;
+        while (pgn_next_game(reader, &game)) {
+            PgnReplay replay = { .game = &game, .board = &cb, .moves = moves };
+            replay.legal = pgn_replay(&game, &cb, moves, PGN_MAX_PLIES, &replay.plies);
+
+            out.length = 0;
+            encode_game(&replay, &out, state);
+
+            PgnRecord record = {
+                .index  = game.index,
+                .offset = game.offset,
+                .plies  = replay.plies,
+                .legal  = replay.legal,
+                .data   = out.data,
+                .length = out.length,
+            };
+            write_game(&record, state);
+        }
+        free(out.data);
+    }
+
+    size_t dropped = state->writer->dropped;
+    if (!archive_writer_close(state->writer)) state->failed = true;
+    double seconds = now() - start;
+    size_t size = reader->size;
+    pgn_close(reader);
+
+    ArchiveReader *ar = (state->failed) ? NULL : archive_open(output);
+    if (!ar) {
+        fprintf(stderr, "Unable to write %s\n", output);
+        free(state);
+        return EXIT_FAILURE;
+    }
+
+    fprintf(stdout, "Games:  %lu (%lu illegal, %lu too long skipped)\n", state->games, state->illegal,
+            state->long_games);
+    fprintf(stdout, "Plies:  %lu\n", state->plies);
+    fprintf(stdout, "Tags:   %u names, %u values (%lu dropped)\n", ar->names.count, ar->values.count, dropped);
+    fprintf(stdout, "Size:   %.1f MB -> %.1f MB (%.2fx)\n", size / 1e6, ar->size / 1e6, (double) size / ar->size);
+    fprintf(stdout, "Time:   %.3fs\n", seconds);
+
+    archive_close(ar);
+    free(state);
+    return EXIT_SUCCESS;
+}
+
+/**
+ * Time replaying every game of an archive, and optionally of the PGN it was
+ * converted from.
+ *
+ * @param   path    Path of the archive.
+ * @param   pgn     Path of the PGN file (or NULL).
+ *
+ * @return  EXIT_SUCCESS or EXIT_FAILURE.
+**/
+int     replay(const char *path, const char *pgn) {
+
+    ArchiveReader *ar = archive_open(path);
+    if (!ar) {
+        fprintf(stderr, "Unable to open %s\n", path);
+        return EXIT_FAILURE;
+    }
+
+    ChessBoard cb;
+    size_t plies = 0, failed = 0;
+    double start = now();
+    for (size_t i = 0; i < ar->games; i++) {
+        ArchiveGame game;
+        if (!archive_game(ar, i, &game) || !archive_replay(ar, &game, &cb)) {
+            failed++;
+            continue;
+        }
+        plies += game.plies;
+    }
+    double seconds = now() - start;
+
+    fprintf(stdout, "%s: %lu games (%lu failed), %lu plies, %.1f MB\n", path, ar->games, failed, plies, ar->size / 1e6);
+    fprintf(stdout, "    %.3fs, %.0f games/s, %.1f ns/ply\n", seconds, ar->games / seconds, seconds * 1e9 / plies);
+
+    if (pgn) {
+        PgnReader *reader = pgn_open(pgn);
+        if (!reader) {
+            fprintf(stderr, "Unable to open %s\n", pgn);
+            archive_close(ar);
+            return EXIT_FAILURE;
+        }
+
+        size_t games = 0, pgn_plies = 0;
+        double pgn_start = now();
+        PgnGame game;
+        while (pgn_next_game(reader, &game)) {
+            size_t game_plies;
+            pgn_replay(&game, &cb, NULL, 0, &game_plies);
+            pgn_plies += game_plies;
+            games++;
+        }
+        double pgn_seconds = now() - pgn_start;
+
+        fprintf(stdout, "%s: %lu games, %lu plies, %.1f MB\n", pgn, games, pgn_plies, reader->size / 1e6);
+        fprintf(stdout, "    %.3fs, %.0f games/s, %.1f ns/ply\n", pgn_seconds, games / pgn_seconds,
+                pgn_seconds * 1e9 / pgn_plies);
+        fprintf(stdout, "Archive: %.1fx faster, %.2fx smaller\n", pgn_seconds / seconds, (double) reader->size / ar->size);
+        pgn_close(reader);
+    }
+
+    archive_close(ar);
+    return (failed) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/**
+ * Print the tags, moves and final position of one game.
+ *
+ * @param   path    Path of the archive.
+ * @param   number  Game number (1 is the first game).
+ *
+ * @return  EXIT_SUCCESS or EXIT_FAILURE.
+**/
+int     show(const char *path, size_t number) {
+
+    ArchiveReader *ar = archive_open(path);
+    if (!ar) {
+        fprintf(stderr, "Unable to open %s\n", path);
+        return EXIT_FAILURE;
+    }
+
+    ArchiveGame game;
+    ChessBoard cb;
+    if (!number || !archive_game(ar, number - 1, &game) || !archive_replay(ar, &game, &cb)) {
+        fprintf(stderr, "%s: no game %lu (of %lu)\n", path, number, ar->games);
+        archive_close(ar);
+        return EXIT_FAILURE;
+    }
+
+    for (size_t i = 0; i < game.tags_count; i++) {
+        PgnSpan name, value;
+        archive_string(&ar->names, game.names[i], &name);
+        archive_string(&ar->values, game.values[i], &value);
+        fprintf(stdout, "[%.*s \"%.*s\"]\n", (int) name.length, name.ptr, (int) value.length, value.ptr);
+    }
+
+    static const char *results[] = { "*", "1-0", "0-1", "1/2-1/2" };
+    for (size_t i = 0; i < game.plies; i++) {
+        char move[8];
+        chessmove_to_string(game.moves[i], move);
+        fprintf(stdout, "%s%s", (i) ? " " : "\n", move);
+    }
+    fprintf(stdout, "%s%s\n", (game.plies) ? " " : "\n", results[game.result]);
+
+    char *fen = chessboard_to_fen(&cb);
+    fprintf(stdout, "%s\n", fen);
+    free(fen);
+
+    archive_close(ar);
+    return EXIT_SUCCESS;
+}
+
+
+/* Main Execution */
+
+int main(int argc, char *argv[]) {
+
+    if (argc < 2) usage(argv[0], EXIT_FAILURE);
+    const char *command = argv[1];
+
+    PgnPipelineOptions options = { .chunk_size = PGN_CHUNK_SIZE };
+    bool pipeline = false, quiet = false;
+
+    optind = 2;
+    int option;
+    while ((option = getopt(argc, argv, "j:qh")) != -1) {
+        switch (option) {
+            case 'j':
+                pipeline = true;
+                options.workers = strtoul(optarg, NULL, 10);
+                break;
+            case 'q':
+                quiet = true;
+                break;
+            case 'h':
+                usage(argv[0], EXIT_SUCCESS);
+                break;
+            default:
+                usage(argv[0], EXIT_FAILURE);
+        }
+    }
+
+    int count = argc - optind;
+    if (!strcmp(command, "convert") && count == 2) {
+        return convert((pipeline) ? &options : NULL, argv[optind], argv[optind + 1], quiet);
+    }
+    if (!strcmp(command, "replay") && (count == 1 || count == 2)) {
+        return replay(argv[optind], (count == 2) ? argv[optind + 1] : NULL);
+    }
+    if (!strcmp(command, "show") && count == 2) {
+        return show(argv[optind], strtoul(argv[optind + 1], NULL, 10));
+    }
+
+    usage(argv[0], EXIT_FAILURE);
+    return EXIT_FAILURE;
+}
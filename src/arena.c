@@ -0,0 +1,160 @@
+/* libchess
+ * Jack O'Connor 2025
+ * src/arena.c
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena.h"
+
+
+/* Macro Functions */
+
+#define arena_align(n)      (((n) + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1))
+#define arena_data(block)   ((char *)(block) + sizeof(ArenaBlock))
+
+
+/* Internal Functions */
+
+/**
+ * Start a new block with room for at least size bytes, reusing a spare
+ * block when one is large enough.
+ *
+ * @param   arena   Pointer to Arena structure.
+ * @param   size    Bytes needed.
+ *
+ * @return  Pointer to the new current ArenaBlock, or NULL if error.
+**/
+static ArenaBlock * arena_grow(Arena *arena, size_t size) {
+
+    ArenaBlock *block = arena->spare;
+    if (block && block->size >= size) {
+        arena->spare = block->next;
+    } else {
+        size_t block_size = (size > arena->block_size) ? size : arena->block_size;
+        block = (ArenaBlock *) malloc(sizeof(ArenaBlock) + block_size);
+        if (!block) return NULL;
+        block->size = block_size;
+        arena->blocks_count++;
+    }
+
+    block->used = 0;
+    block->next = arena->blocks;
+    arena->blocks = block;
+    return block;
+}
+
+static void         arena_free_blocks(ArenaBlock *block) {
+    while (block) {
+        ArenaBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+}
+
+
+/* External Functions */
+
+/**
+ * Create Arena structure.
+ *
+ * @param   block_size  Bytes per block (0 for ARENA_BLOCK_SIZE). Larger
+ *                      allocations get a block of their own.
+ *
+ * @return  Pointer to new Arena structure, or NULL if error.
+**/
+Arena *     arena_create(size_t block_size) {
+
+    Arena *arena = (Arena *) calloc(1, sizeof(Arena));
+    if (arena) arena->block_size = arena_align((block_size) ? block_size : ARENA_BLOCK_SIZE);
+    return arena;
+}
+
+/**
+ * Deallocate Arena structure and everything allocated from it.
+ *
+ * @param   arena   Pointer to Arena structure.
+**/
+void        arena_delete(Arena *arena) {
+    if (!arena) return;
+    arena_free_blocks(arena->blocks);
+    arena_free_blocks(arena->spare);
+    free(arena);
+}
+
+/**
+ * Release everything allocated from an arena at once. Blocks are kept and
+ * reused by later allocations.
+ *
+ * @param   arena   Pointer to Arena structure.
+**/
+void        arena_reset(Arena *arena) {
+
+    while (arena->blocks) {
+        ArenaBlock *block = arena->blocks;
+        arena->blocks = block->next;
+        block->next = arena->spare;
+        arena->spare = block;
+    }
+    arena->allocated = 0;
+}
+
+/**
+ * Allocate memory from an arena. It is released by arena_reset or
+ * arena_delete, never individually.
+ *
+ * @param   arena   Pointer to Arena structure.
+ * @param   size    Bytes to allocate.
+ *
+ * @return  Pointer to ARENA_ALIGNMENT-aligned, uninitialized memory, or NULL if error.
+**/
+void *      arena_alloc(Arena *arena, size_t size) {
+
+    size = arena_align((size) ? size : 1);
+
+    ArenaBlock *block = arena->blocks;
+    if (!block || block->size - block->used < size) {
+        if (!(block = arena_grow(arena, size))) return NULL;
+    }
+
+    void *ptr = arena_data(block) + block->used;
+    block->used += size;
+    arena->allocated += size;
+    return ptr;
+}
+
+/**
+ * Allocate zeroed memory from an arena.
+ *
+ * @param   arena   Pointer to Arena structure.
+ * @param   count   Number of elements.
+ * @param   size    Bytes per element.
+ *
+ * @return  Pointer to zeroed memory, or NULL if error.
+**/
+void *      arena_calloc(Arena *arena, size_t count, size_t size) {
+
+    if (size && count > SIZE_MAX / size) return NULL;
+
+    void *ptr = arena_alloc(arena, count * size);
+    if (ptr) memset(ptr, 0, count * size);
+    return ptr;
+}
+
+/**
+ * Copy a string into an arena.
+ *
+ * @param   arena   Pointer to Arena structure.
+ * @param   s       String to copy.
+ *
+ * @return  Pointer to the copy, or NULL if error.
+**/
+char *      arena_strdup(Arena *arena, const char *s) {
+
+    size_t length = strlen(s) + 1;
+    char *copy = (char *) arena_alloc(arena, length);
+    if (copy) memcpy(copy, s, length);
+    return copy;
+}
@@ -0,0 +1,389 @@
+/* libchess
+ * Jack O'Connor 2025
+ * src/bench.c
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "chessboard.h"
+#include "position.h"
+#include "search.h"
+
+
+/* Constants */
+
+static const char *POSITIONS[] = { // Start position plus the standard perft suite (Kiwipete is #2)
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+};
+
+#define POSITIONS_COUNT     (sizeof(POSITIONS) / sizeof(POSITIONS[0]))
+
+#define BENCH_PERFT_DEPTH   (3)
+#define BENCH_SEARCH_DEPTH  (4)
+#define BENCH_MAX_REPEAT    (1 << 24)
+
+
+/* Types */
+
+typedef size_t (*BenchFunc)(ChessBoard **boards, size_t repeat);
+
+typedef struct {
+    const char *name;
+    const char *unit;           // What one operation is
+    BenchFunc   func;           // Runs the suite `repeat` times, returns operations performed
+} BenchSuite;
+
+typedef struct {
+    const BenchSuite   *suite;
+    size_t              ops;        // Operations per timed run
+    double              ns_per_op;  // Median over runs
+    double              ops_per_sec;
+    double              baseline;   // ns/op from the baseline file (0 if absent)
+} BenchResult;
+
+
+/* Globals */
+
+volatile size_t Sink; // Keeps results observable so the compiler cannot drop the work
+
+
+/* Suites */
+
+size_t  bench_fen_parse(ChessBoard **boards, size_t repeat) {
+    ChessBoard cb;
+    size_t ops = 0;
+    for (size_t r = 0; r < repeat; r++) {
+        for (size_t i = 0; i < POSITIONS_COUNT; i++, ops++) {
+            chessboard_init(&cb, POSITIONS[i]);
+            Sink += cb.key;
+        }
+    }
+    return ops;
+}
+
+size_t  bench_fen_write(ChessBoard **boards, size_t repeat) {
+    char fen[CHESSBOARD_FEN_SIZE];
+    size_t ops = 0;
+    for (size_t r = 0; r < repeat; r++) {
+        for (size_t i = 0; i < POSITIONS_COUNT; i++, ops++) {
+            Sink += chessboard_write_fen(boards[i], fen, sizeof(fen));
+        }
+    }
+    return ops;
+}
+
+size_t  bench_pseudolegal(ChessBoard **boards, size_t repeat) {
+    ChessMove moves[MAX_MOVES];
+    size_t ops = 0;
+    for (size_t r = 0; r < repeat; r++) {
+        for (size_t i = 0; i < POSITIONS_COUNT; i++, ops++) {
+            Sink += chessboard_pseudolegal_moves(boards[i], moves);
+        }
+    }
+    return ops;
+}
+
+size_t  bench_legal(ChessBoard **boards, size_t repeat) {
+    ChessMove moves[MAX_MOVES];
+    size_t ops = 0;
+    for (size_t r = 0; r < repeat; r++) {
+        for (size_t i = 0; i < POSITIONS_COUNT; i++, ops++) {
+            Sink += chessboard_legal_moves(boards[i], moves);
+        }
+    }
+    return ops;
+}
+
+size_t  bench_make_unmake(ChessBoard **boards, size_t repeat) {
+
+    ChessMove moves[POSITIONS_COUNT][MAX_MOVES];
+    for (size_t i = 0; i < POSITIONS_COUNT; i++) chessboard_legal_moves(boards[i], moves[i]);
+
+    size_t ops = 0;
+    ChessUndo undo;
+    for (size_t r = 0; r < repeat; r++) {
+        for (size_t i = 0; i < POSITIONS_COUNT; i++) {
+            for (ChessMove *move = moves[i]; *move; move++, ops++) {
+                chessboard_make_move_with(boards[i], *move, &undo);
+                Sink += boards[i]->key;
+                chessboard_unmake_move_with(boards[i], *move, &undo);
+            }
+        }
+    }
+    return ops;
+}
+
+size_t  bench_perft(ChessBoard **boards, size_t repeat) {
+    size_t ops = 0;
+    for (size_t r = 0; r < repeat; r++) {
+        for (size_t i = 0; i < POSITIONS_COUNT; i++) {
+            ops += chessboard_perft(boards[i], BENCH_PERFT_DEPTH);
+        }
+    }
+    Sink += ops;
+    return ops;
+}
+
+size_t  bench_perft_copy(ChessBoard **boards, size_t repeat) {
+
+    Position positions[POSITIONS_COUNT];
+    for (size_t i = 0; i < POSITIONS_COUNT; i++) position_from_chessboard(&positions[i], boards[i]);
+
+    size_t ops = 0;
+    for (size_t r = 0; r < repeat; r++) {
+        for (size_t i = 0; i < POSITIONS_COUNT; i++) {
+            ops += position_perft(&positions[i], BENCH_PERFT_DEPTH);
+        }
+    }
+    Sink += ops;
+    return ops;
+}
+
+size_t  bench_search(ChessBoard **boards, size_t repeat) {
+
+    SearchLimits limits = { .depth = BENCH_SEARCH_DEPTH };
+    SearchResult result;
+
+    size_t ops = 0;
+    for (size_t r = 0; r < repeat; r++) {
+        for (size_t i = 0; i < POSITIONS_COUNT; i++) {
+            if (chessboard_search(boards[i], &limits, &result)) ops += result.nodes;
+        }
+    }
+    Sink += ops;
+    return ops;
+}
+
+static const BenchSuite SUITES[] = {
+    { "fen_parse",      "board",    bench_fen_parse },
+    { "fen_write",      "fen",      bench_fen_write },
+    { "pseudolegal",    "position", bench_pseudolegal },
+    { "legal",          "position", bench_legal },
+    { "make_unmake",    "move",     bench_make_unmake },
+    { "perft",          "node",     bench_perft },
+    { "perft_copy",     "node",     bench_perft_copy },
+    { "search",         "node",     bench_search },
+};
+
+#define SUITES_COUNT    (sizeof(SUITES) / sizeof(SUITES[0]))
+
+
+/* Functions */
+
+void    usage(const char *program, int status) {
+    fprintf(stderr, "Usage: %s [options] [SUITE...]\n", program);
+    fprintf(stderr, "    -r RUNS     Timed runs per suite, median is reported (default: 7)\n");
+    fprintf(stderr, "    -m MS       Minimum duration of one run in milliseconds (default: 100)\n");
+    fprintf(stderr, "    -j FILE     Write results as JSON (- for stdout)\n");
+    fprintf(stderr, "    -b FILE     Compare against a JSON baseline written by -j\n");
+    fprintf(stderr, "    -l          List suites\n");
+    exit(status);
+}
+
+double  now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int     compare_doubles(const void *a, const void *b) {
+    double x = *(const double *) a, y = *(const double *) b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Time a suite: grow the repeat count until one run lasts at least
+ * min_seconds, then take the median of runs timed runs.
+ *
+ * @param   suite       Pointer to BenchSuite structure.
+ * @param   boards      Boards parsed from POSITIONS.
+ * @param   runs        Number of timed runs.
+ * @param   min_seconds Minimum duration of one run.
+ * @param   result      Pointer to BenchResult structure to populate.
+**/
+void    bench_run(const BenchSuite *suite, ChessBoard **boards, size_t runs, double min_seconds, BenchResult *result) {
+
+    size_t repeat = 1;
+    for (;;) {
+        double start = now();
+        suite->func(boards, repeat);
+        double elapsed = now() - start;
+        if (elapsed >= min_seconds || repeat >= BENCH_MAX_REPEAT) break;
+        repeat *= (elapsed > 0 && min_seconds / elapsed < 16) ? 2 : 16;
+    }
+
+    double samples[runs];
+    size_t ops = 0;
+    for (size_t r = 0; r < runs; r++) {
+        double start = now();
+        ops = suite->func(boards, repeat);
+        samples[r] = (now() - start) * 1e9 / ops;
+    }
+    qsort(samples, runs, sizeof(double), compare_doubles);
+
+    result->suite = suite;
+    result->ops = ops;
+    result->ns_per_op = (runs % 2) ? samples[runs / 2] : (samples[runs / 2 - 1] + samples[runs / 2]) / 2;
+    result->ops_per_sec = 1e9 / result->ns_per_op;
+}
+
+/**
+ * Read ns/op values from a baseline written by bench_write_json.
+ *
+ * @param   path        Baseline file path.
+ * @param   results     Results to annotate with their baseline value.
+ * @param   count       Number of results.
+ *
+ * @return  `true` if the file could be read, `false` otherwise.
+**/
+bool    bench_read_baseline(const char *path, BenchResult *results, size_t count) {
+
+    FILE *stream = fopen(path, "r");
+    if (!stream) return false;
+
+    // One suite per line: {"suite": "NAME", ..., "ns_per_op": VALUE, ...}
+    char line[BUFSIZ];
+    while (fgets(line, sizeof(line), stream)) {
+        char name[64];
+        char *suite = strstr(line, "\"suite\":");
+        char *value = strstr(line, "\"ns_per_op\":");
+        if (!suite || !value || sscanf(suite, "\"suite\": \"%63[^\"]\"", name) != 1) continue;
+
+        for (size_t i = 0; i < count; i++) {
+            if (!strcmp(results[i].suite->name, name)) results[i].baseline = strtod(value + 12, NULL);
+        }
+    }
+
+    fclose(stream);
+    return true;
+}
+
+/**
+ * Write results as a JSON document with one suite per line.
+ *
+ * @param   stream      Output stream.
+ * @param   results     Results to write.
+ * @param   count       Number of results.
+ * @param   runs        Timed runs per suite.
+**/
+void    bench_write_json(FILE *stream, BenchResult *results, size_t count, size_t runs) {
+
+    fprintf(stream, "{\n  \"positions\": %lu,\n  \"runs\": %lu,\n  \"suites\": [\n", POSITIONS_COUNT, runs);
+    for (size_t i = 0; i < count; i++) {
+        fprintf(stream, "    {\"suite\": \"%s\", \"unit\": \"%s\", \"ops\": %lu, \"ns_per_op\": %.3f, \"ops_per_sec\": %.0f",
+                results[i].suite->name, results[i].suite->unit, results[i].ops,
+                results[i].ns_per_op, results[i].ops_per_sec);
+        if (results[i].baseline > 0) {
+            fprintf(stream, ", \"baseline_ns_per_op\": %.3f, \"change\": %.4f",
+                    results[i].baseline, results[i].ns_per_op / results[i].baseline - 1);
+        }
+        fprintf(stream, "}%s\n", (i + 1 < count) ? "," : "");
+    }
+    fprintf(stream, "  ]\n}\n");
+}
+
+
+/* Main Execution */
+
+int main(int argc, char *argv[]) {
+
+    size_t runs = 7;
+    double min_seconds = 0.1;
+    const char *json = NULL;
+    const char *baseline = NULL;
+
+    int option;
+    while ((option = getopt(argc, argv, "r:m:j:b:lh")) != -1) {
+        switch (option) {
+            case 'r':
+                runs = strtoul(optarg, NULL, 10);
+                break;
+            case 'm':
+                min_seconds = strtod(optarg, NULL) / 1000;
+                break;
+            case 'j':
+                json = optarg;
+                break;
+            case 'b':
+                baseline = optarg;
+                break;
+            case 'l':
+                for (size_t s = 0; s < SUITES_COUNT; s++) fprintf(stdout, "%s\n", SUITES[s].name);
+                return EXIT_SUCCESS;
+            case 'h':
+                usage(argv[0], EXIT_SUCCESS);
+                break;
+            default:
+                usage(argv[0], EXIT_FAILURE);
+        }
+    }
+    if (!runs) usage(argv[0], EXIT_FAILURE);
+
+    // Suites named on the command line, or all of them
+    const BenchSuite *selected[SUITES_COUNT];
+    size_t count = 0;
+    for (size_t s = 0; s < SUITES_COUNT; s++) {
+        bool wanted = (optind >= argc);
+        for (int a = optind; a < argc; a++) wanted |= !strcmp(argv[a], SUITES[s].name);
+        if (wanted) selected[count++] = &SUITES[s];
+    }
+    if (!count) {
+        fprintf(stderr, "No matching suite (see -l)\n");
+        return EXIT_FAILURE;
+    }
+
+    ChessBoard *boards[POSITIONS_COUNT];
+    for (size_t i = 0; i < POSITIONS_COUNT; i++) {
+        if (!(boards[i] = chessboard_create(POSITIONS[i]))) {
+            fprintf(stderr, "Unable to create board: %s\n", POSITIONS[i]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Progress goes to stderr when the JSON document takes stdout
+    FILE *table = (json && !strcmp(json, "-")) ? stderr : stdout;
+    fprintf(table, "%lu positions, median of %lu runs\n\n", POSITIONS_COUNT, runs);
+    fprintf(table, "%-12s %12s %14s %10s\n", "Suite", "ns/op", "ops/s", "Change");
+
+    BenchResult results[SUITES_COUNT] = { 0 };
+    for (size_t i = 0; i < count; i++) {
+        bench_run(selected[i], boards, runs, min_seconds, &results[i]);
+    }
+
+    if (baseline && !bench_read_baseline(baseline, results, count)) {
+        fprintf(stderr, "Unable to read baseline: %s\n", baseline);
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        fprintf(table, "%-12s %12.2f %14.0f", results[i].suite->name, results[i].ns_per_op, results[i].ops_per_sec);
+        if (results[i].baseline > 0) {
+            // Positive means slower than the baseline
+            fprintf(table, " %+9.1f%%\n", (results[i].ns_per_op / results[i].baseline - 1) * 100);
+        } else {
+            fprintf(table, " %10s\n", "-");
+        }
+    }
+
+    if (json) {
+        FILE *stream = (!strcmp(json, "-")) ? stdout : fopen(json, "w");
+        if (!stream) {
+            fprintf(stderr, "Unable to write %s\n", json);
+        } else {
+            bench_write_json(stream, results, count, runs);
+            if (stream != stdout) fclose(stream);
+        }
+    }
+
+    for (size_t i = 0; i < POSITIONS_COUNT; i++) chessboard_delete(boards[i]);
+    return EXIT_SUCCESS;
+}
@@ -1,551 +1,1421 @@
-// libchess
-// Jack O'Connor 2025
-// src/chessboard_ng.c
-
-#include <ctype.h>
-#include <string.h>
-#include <sys/types.h>
-
-#include "chessboard.h"
-
-
-/* Constants */
-
-const Bitboard A_FILE = 0x0101010101010101;
-const Bitboard RANK_1 = 0x00000000000000FF;
-
-const char *DEFAULT_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
-
-const char *PIECE_CHARS = "pnbrqk";
-
-const int KNIGHT_OFFSETS[][2] = {
-    {-1, 2}, {1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}
-};
-
-const int DIRECTIONS[][2] = {
-    {-1, -1}, {0, -1}, {1, -1},
-    {-1,  0},          {1,  0},
-    {-1,  1}, {0,  1}, {1,  1}
-};
-
-const size_t DIRECTIONS_BISHOP[] = {0, 2, 5, 7};
-const size_t DIRECTIONS_ROOK[]   = {1, 3, 4, 6};
-const size_t DIRECTIONS_QUEEN[]  = {0, 1, 2, 3, 4, 5, 6, 7, 8};
-
-
-
-/* Functions */
-
-/**
- * Get the ASCII character associated with piece.
- *
- * @param   piece   ChessPiece to convert to character.
- * @return  Character ASCII piece or 0 if error.
-**/
-char            get_piece_char(ChessPiece piece) {
-    
-    ChessPiece color = piece_color(piece);
-    piece = piece & PIECE_TYPE_BITMASK;
-    for (int i = 0; i < 6; i++) {
-        if (piece == PAWN) {
-            if (color == WHITE) return toupper(PIECE_CHARS[i]);
-            else return PIECE_CHARS[i];
-        }
-        piece--;
-    }
-
-    return '\0';
-}
-
-/**
- * Get the ChessPiece associated with ASCII character.
- *
- * @param   c   ASCII character to convert to piece.
- * @return  ChessPiece or 0 if error.
-**/
-ChessPiece      get_char_piece(char c) {
-
-    ChessPiece color = (isupper(c)) ? WHITE : BLACK;
-    c = tolower(c);
-    ChessPiece piece = PAWN;
-    for (char *cmp = (char *)PIECE_CHARS; *cmp; cmp++) {
-        if (c == *cmp) return piece | color;
-        piece++;
-    }
-
-    return EMPTY;
-}
-
-/**
- * Create ChessBoard structure.
- *
- * @param   fen     Forsyth-Edwards Notation string representing position (if NULL, default initial position is created).
- *
- * @return  Pointer to new ChessBoard structure.
-**/
-ChessBoard *        chessboard_create(const char *fen) {
-    
-    // Handle event that fen is NULL.
-    if (!fen) fen = DEFAULT_FEN;
-
-    ChessBoard *cb = (ChessBoard *) calloc(1, sizeof(ChessBoard));
-    if (cb) {
-        cb->to_move = WHITE;
-        cb->enpassant_target = -1;
-        cb->halfmove_clock = 0;
-        cb->fullmove_counter = 1;
-        
-        // Process position string
-        char *c = (char *) fen;
-        uint8_t file = 0, rank = 7;
-        while (*c && *c != ' ') {
-            
-            if (isalpha(*c)) {
-                ChessPiece piece = get_char_piece(*c);
-                if (piece) {
-                    ChessPiece color = piece_color(piece);
-                    ChessPiece type = piece_type(piece);
-                    if (type == KING) {
-                        if (color == WHITE) cb->king_pos_w = (rank * 8) + file;
-                        if (color == BLACK) cb->king_pos_b = (rank * 8) + file;
-                    }
-
-                    cb->board[(rank * 8) + file] = piece;
-                }
-            } else if (isdigit(*c)) {
-                uint8_t skip = *c - '0';
-                file += skip - 1;
-            } else if (*c == '/') {
-                file = 0;
-                rank--;
-                c++;
-                continue;
-            }
-
-            file++;
-            c++;
-        }
-
-        if (!*c) goto FEN_COMPLETE;
-        c++;
-
-        // Process side-to-move
-        if (*c == 'w') cb->to_move = WHITE;
-        else if (*c == 'b') cb->to_move = BLACK;
-        else return cb;
-
-        if (!*c) goto FEN_COMPLETE;
-        c += 2;
-
-        // Process castling ability
-        while (*c && *c != ' ') {
-            switch (*c) {
-                case 'K':
-                    cb->castle_ability_w |= CAN_CASTLE_SHORT;
-                    break;
-                case 'Q':
-                    cb->castle_ability_w |= CAN_CASTLE_LONG;
-                    break;
-                case 'k':
-                    cb->castle_ability_b |= CAN_CASTLE_SHORT;
-                    break;
-                case 'q':
-                    cb->castle_ability_b |= CAN_CASTLE_LONG;
-                    break;
-                default:
-                    goto FEN_COMPLETE;
-            }
-            c++;
-        }
-
-        if (!*c) goto FEN_COMPLETE;
-        c++;
-
-        // Process enpassant target square
-        if (*c == '-') {
-            cb->enpassant_target = -1;
-        } else {
-            uint8_t file = *(c++) - 'a';
-            uint8_t rank = *c - '1';
-            if (file >= 8 || rank >= 8) return cb;
-            cb->enpassant_target = (rank * 8) + file;
-        }
-
-        if (!*c) goto FEN_COMPLETE;
-        c += 2;
-
-        // Process move counters
-        char counter_buf[64];
-        strcpy(counter_buf, c);
-        char *word = strtok(counter_buf, " ");
-        if (!word) goto FEN_COMPLETE;
-        cb->halfmove_clock = atol(word);
-
-        word = strtok(NULL, " ");
-        if (!word) goto FEN_COMPLETE;
-        cb->fullmove_counter = atol(word);
-
-FEN_COMPLETE:
-        // Populate bitboards
-        for (size_t rank = 0; rank < 8; rank++) {
-            for (size_t file = 0; file < 8; file++) {
-                ChessPiece *piece = chessboard_get(cb, file, rank);
-                if (!piece || !*piece) continue;
-
-                ChessPiece color = piece_color(*piece);
-                // ChessPiece type = piece_type(*piece);
-
-                bitboard_set(cb->locations[BB_IDX_ALL], file, rank, true);
-                bitboard_set(cb->locations[BB_IDX_COLOR(color)], file, rank, true);
-                bitboard_set(cb->locations[BB_IDX_PIECE(*piece)], file, rank, true);
-
-                // TODO: Set target locations
-            }
-        }
-    }
-
-    return cb;
-}
-
-
-/**
- * Deallocate ChessBoard structure.
- *
- * @param   cb  Pointer to ChessBoard structure to delete.
-**/
-void                chessboard_delete(ChessBoard *cb) {
-    free(cb);
-}
-
-
-void                chessboard_dump(ChessBoard *cb, FILE *stream) {
-
-    for (ssize_t rank = 7; rank >= 0; rank--) {
-        fprintf(stream, "  +---+---+---+---+---+---+---+---+\n");
-        fprintf(stream, "%ld ", rank + 1);
-        for (ssize_t file = 0; file < 8; file++) {
-            ChessPiece piece = cb->board[rank * 8 + file];
-            char piece_char;
-            if (piece) {
-                piece_char = get_piece_char(piece);
-            } else {
-                piece_char = ' ';
-            }
-            
-            fprintf(stream, "| %c ", piece_char);
-        }
-        fprintf(stream, "|\n");
-    }
-    fprintf(stream, "  +---+---+---+---+---+---+---+---+\n");
-    fprintf(stream, "    a   b   c   d   e   f   g   h  \n");
-}
-
-
-/**
- * Get the FEN representation of a ChessBoard structure's position.
- *
- * @param   cb  Pointer to ChessBoard structure.
- *
- * @return  FEN string (must be freed) or NULL if error.
-**/
-char *              chessboard_to_fen(ChessBoard *cb) {
-
-    char fen_buf[BUFSIZ] = { 0 };
-    
-    // Process piece position.
-    char *c = fen_buf;
-    int empty = 0;
-    for (ssize_t rank = 7; rank >= 0; rank--) {
-        for (ssize_t file = 0; file < 8; file++) {
-            ChessPiece *piece = chessboard_get(cb, file, rank);
-            if (!piece) return NULL;
-            if (!*piece) {
-                empty++;
-                continue;
-            }
-
-            if (empty) {
-                *(c++) = '0' + empty; 
-                empty = 0;
-            }
-            char piece_char = get_piece_char(*piece);
-            *(c++) = piece_char;
-        }
-
-        if (empty) {
-            *(c++) = '0' + empty; 
-            empty = 0;
-        }
-        if (rank) *(c++) = '/';
-    }
-    *(c++) = ' ';
-
-    // Process side-to-move
-    if (cb->to_move == WHITE) *(c++) = 'w';
-    else *(c++) = 'b';
-    *(c++) = ' ';
-
-    // Process castle availability
-    bool any_castle = false;
-    if (cb->castle_ability_w & CAN_CASTLE_SHORT) {
-        *(c++) = 'K';
-        any_castle = true;
-    }
-    if (cb->castle_ability_w & CAN_CASTLE_LONG) {
-        *(c++) = 'Q';
-        any_castle = true;
-    }
-    if (cb->castle_ability_b & CAN_CASTLE_SHORT) {
-        *(c++) = 'k';
-        any_castle = true;
-    }
-    if (cb->castle_ability_b & CAN_CASTLE_LONG) {
-        *(c++) = 'q';
-        any_castle = true;
-    }
-
-    if (!any_castle) *(c++) = '-';
-    *(c++) = ' ';
-
-    // Process enpassant target square
-    if (cb->enpassant_target == -1) {
-        *(c++) = '-';
-    } else {
-        int8_t ep_file = cb->enpassant_target % 8;
-        int8_t ep_rank = cb->enpassant_target / 8;
-        *(c++) = 'a' + ep_file;
-        *(c++) = '1' + ep_rank;
-    }
-    *(c++) = ' ';
-
-    // Process move counters
-    char counter_buf[64] = { 0 };
-    snprintf(counter_buf, 64, "%lu %lu", cb->halfmove_clock, cb->fullmove_counter);
-    strcat(fen_buf, counter_buf);
-
-    return strdup(fen_buf);
-}
-
-
-/**
- * Access a piece from a ChessBoard structure
- *
- * @param   cb      Pointer to ChessBoard structure.
- * @param   file    File (0 indexed) of desired piece.
- * @param   rank    Rank (0 indexed) of desired piece.
- *
- * @return  Pointer to ChessPiece structure, or NULL if coordinates invalid.
-**/
-ChessPiece *        chessboard_get(ChessBoard *cb, uint8_t file, uint8_t rank) {
-
-    if (file >= 8 || rank >= 8) return NULL;
-
-    return cb->board + (rank * 8) + file;
-}
-
-/**
- * Perform a ChessMove action for the current player
- * 
- * @param   cb      Pointer to ChessBoard structure.
- * @param   move    ChessMove object containing encoded move information.
- * 
- * @return  `true` if operation was successful, `false` otherwise.
- */
-bool                chessboard_make_move(ChessBoard *cb, ChessMove move) {
-    
-    uint16_t position_from  = move & 0x3F;
-    uint16_t position_to    = (move >> 6) & 0x3F;
-
-    ChessPiece color = cb->to_move;
-    ChessPiece enemy_color = (color == WHITE) ? BLACK : WHITE;
-
-    // TODO: Check legality
-    ChessPiece *piece_from = cb->board + position_from;
-    ChessPiece *piece_to = cb->board + position_to;
-
-    if (piece_color(*piece_from) != color) return false;
-    if (*piece_to && piece_color(*piece_to) != enemy_color) return false;
-
-    Bitboard bb_from    = (1lu << position_from);
-    Bitboard bb_to      = (1lu << position_to);
-
-    cb->locations[BB_IDX_ALL]                   &= ~bb_from;
-    cb->locations[BB_IDX_ALL]                   |= bb_to;
-
-    cb->locations[BB_IDX_COLOR(color)]          &= ~bb_from;
-    cb->locations[BB_IDX_COLOR(color)]          |= bb_to;
-    cb->locations[BB_IDX_PIECE(*piece_from)]    &= ~bb_from;
-    cb->locations[BB_IDX_PIECE(*piece_from)]    |= bb_to;
-
-    if (*piece_to) {
-        cb->locations[BB_IDX_COLOR(enemy_color)]    &= ~bb_to;
-        cb->locations[BB_IDX_PIECE(*piece_to)]      &= ~bb_to;
-    }
-    // TODO: Update target bitboards
-
-    *piece_to = *piece_from;
-    *piece_from = 0;
-
-    cb->to_move = (cb->to_move == WHITE) ? BLACK : WHITE;
-    return true;
-}
-
-
-/**
- * Undo a ChessMove action for the previous player
- * 
- * @param   cb      Pointer to ChessBoard structure.
- * @param   move    ChessMove object containing encoded move information.
- * 
- * @return  `true` if operation was successful, `false` otherwise.
- */
-bool                chessboard_unmake_move(ChessBoard *cb, ChessMove move);
-
-
-/**
- * Generate list of pseudolegal moves for current player (may put the player in check)
- *
- * @param   cb      Pointer to ChessBoard structure.
- * @param   out     Pointer to array of ChessMoves to populate 
- *                      (218 elements, terminated with null move)
- *
- * @return  Pointer to ChessPiece structure, or NULL if coordinates invalid.
-**/
-size_t              chessboard_pseudolegal_moves(ChessBoard *cb, ChessMove *out) {
-
-    size_t move_idx = 0;
-    ChessPiece color = cb->to_move;
-    ChessPiece enemy_color = (color == WHITE) ? BLACK : WHITE;
-
-    for (size_t rank = 0; rank < 8; rank++) {
-        for (size_t file = 0; file < 8; file++) {
-            if (!bitboard_get(cb->locations[BB_IDX_COLOR(color)], file, rank)) continue;
-
-            uint8_t position = file + rank * 8;
-            ChessPiece *piece = chessboard_get(cb, file, rank);
-            ChessPiece type = piece_type(*piece);
-
-            switch (type) {
-                case PAWN: {
-                    int move_direction = (color == WHITE) ? 1 : -1;
-                    if (!bitboard_get(cb->locations[BB_IDX_ALL], file, rank + move_direction)) {
-                        uint8_t new_rank = rank + move_direction;
-                        if (new_rank == 0 || new_rank == 8) { // Promotion moves
-                            out[move_idx++] = position | ((file + new_rank * 8) << 6) | P_TO_N;
-                            out[move_idx++] = position | ((file + new_rank * 8) << 6) | P_TO_B;
-                            out[move_idx++] = position | ((file + new_rank * 8) << 6) | P_TO_R;
-                            out[move_idx++] = position | ((file + new_rank * 8) << 6) | P_TO_Q;
-                        } else {
-                            out[move_idx++] = position | ((file + new_rank * 8) << 6);
-
-                            if ( !bitboard_get(cb->locations[BB_IDX_ALL], file, new_rank + move_direction))
-                                out[move_idx++] = position | ((file + (new_rank + move_direction) * 8) << 6);
-                        }
-                    }
-                    // TODO
-                }
-                break;
-                case KNIGHT:
-
-                    for (size_t i = 0; i < sizeof(KNIGHT_OFFSETS)/sizeof(KNIGHT_OFFSETS[0]); i++) {
-                        ssize_t dx = KNIGHT_OFFSETS[i][1];
-                        ssize_t dy = KNIGHT_OFFSETS[i][0];
-                        size_t new_file = file + dx;
-                        size_t new_rank = rank + dy;
-
-                        if (new_file >= 8 || new_rank >= 8) continue;
-                        if (bitboard_get(cb->locations[BB_IDX_COLOR(color)], new_file, new_rank)) continue;
-                        out[move_idx++] = position | ((new_file + new_rank * 8) << 6);
-                        
-                    }
-
-                    break;
-                case BISHOP:
-
-                    for (size_t i = 0; i < sizeof(DIRECTIONS_BISHOP)/sizeof(size_t); i++) {
-                        size_t dir_index = DIRECTIONS_BISHOP[i];
-                        ssize_t dx = DIRECTIONS[dir_index][1];
-                        ssize_t dy = DIRECTIONS[dir_index][0];
-                        size_t new_file = file + dx;
-                        size_t new_rank = rank + dy;
-
-                        while (new_file <= 8 && new_rank <= 8) {
-                            if (bitboard_get(cb->locations[BB_IDX_COLOR(color)], new_file, new_rank)) break;
-                            out[move_idx++] = position | ((new_file + new_rank * 8) << 6);
-
-                            new_file += dx;
-                            new_rank += dy;
-
-                            if (bitboard_get(cb->locations[BB_IDX_COLOR(enemy_color)], new_file, new_rank)) break;
-                        }
-                    }
-
-                    break;
-                case ROOK:
-
-                    for (size_t i = 0; i < sizeof(DIRECTIONS_ROOK)/sizeof(size_t); i++) {
-                        size_t dir_index = DIRECTIONS_ROOK[i];
-                        ssize_t dx = DIRECTIONS[dir_index][1];
-                        ssize_t dy = DIRECTIONS[dir_index][0];
-                        size_t new_file = file + dx;
-                        size_t new_rank = rank + dy;
-
-                        while (new_file <= 8 && new_rank <= 8) {
-                            if (bitboard_get(cb->locations[BB_IDX_COLOR(color)], new_file, new_rank)) break;
-                            out[move_idx++] = position | ((new_file + new_rank * 8) << 6);
-
-                            new_file += dx;
-                            new_rank += dy;
-
-                            if (bitboard_get(cb->locations[BB_IDX_COLOR(enemy_color)], new_file, new_rank)) break;
-                        }
-                    }
-
-                    break;
-                case QUEEN:
-
-                    for (size_t i = 0; i < sizeof(DIRECTIONS_QUEEN)/sizeof(size_t); i++) {
-                        size_t dir_index = DIRECTIONS_QUEEN[i];
-                        ssize_t dx = DIRECTIONS[dir_index][1];
-                        ssize_t dy = DIRECTIONS[dir_index][0];
-                        size_t new_file = file + dx;
-                        size_t new_rank = rank + dy;
-
-                        while (new_file <= 8 && new_rank <= 8) {
-                            if (bitboard_get(cb->locations[BB_IDX_COLOR(color)], new_file, new_rank)) break;
-                            out[move_idx++] = position | ((new_file + new_rank * 8) << 6);
-
-                            new_file += dx;
-                            new_rank += dy;
-
-                            if (bitboard_get(cb->locations[BB_IDX_COLOR(enemy_color)], new_file, new_rank)) break;
-                        }
-                    }
-
-                    break;
-                case KING:
-
-                    for (size_t i = 0; i < 8; i++) {
-                        size_t new_file = file + DIRECTIONS[i][1];
-                        size_t new_rank = rank + DIRECTIONS[i][0];
-
-                        if (new_file >= 8 || new_rank >= 8) continue;
-                        if (bitboard_get(cb->locations[BB_IDX_COLOR(color)], new_file, new_rank)) continue;
-                        if (bitboard_get(cb->targets[BB_IDX_COLOR(enemy_color)], new_file, new_rank)) continue;
-
-                        out[move_idx++] = position | ((new_file + new_rank * 8) << 6);
-                    }
-
-                    break;
-                default:
-                    out[0] = 0;
-                    fprintf(stderr, "chessboard_pseudolegal_moves\n");
-                    return 0;
-            }
-        }
-    }
-
-    out[move_idx] = 0;
-    return move_idx;
-}
-
+// libchess
+// Jack O'Connor 2025
+// src/chessboard_ng.c
+
+#include <assert.h>
+#include <ctype.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include "chessboard.h"
+#include "magic.h"
+#include "zobrist.h"
+
+
+/* Constants */
+
+const char *DEFAULT_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+const char *PIECE_CHARS = "pnbrqk";
+
+// FEN characters by BB_IDX_PIECE (and back), for the FEN parser and writer
+static const char FEN_PIECE_CHARS[16] = {
+    [PAWN | WHITE] = 'P', [KNIGHT | WHITE] = 'N', [BISHOP | WHITE] = 'B',
+    [ROOK | WHITE] = 'R', [QUEEN | WHITE] = 'Q',  [KING | WHITE] = 'K',
+    [PAWN | BLACK] = 'p', [KNIGHT | BLACK] = 'n', [BISHOP | BLACK] = 'b',
+    [ROOK | BLACK] = 'r', [QUEEN | BLACK] = 'q',  [KING | BLACK] = 'k',
+};
+static const ChessPiece FEN_CHAR_PIECES[128] = {
+    ['P'] = PAWN | WHITE, ['N'] = KNIGHT | WHITE, ['B'] = BISHOP | WHITE,
+    ['R'] = ROOK | WHITE, ['Q'] = QUEEN | WHITE,  ['K'] = KING | WHITE,
+    ['p'] = PAWN | BLACK, ['n'] = KNIGHT | BLACK, ['b'] = BISHOP | BLACK,
+    ['r'] = ROOK | BLACK, ['q'] = QUEEN | BLACK,  ['k'] = KING | BLACK,
+};
+
+const int DIRECTIONS[][2] = {
+    {-1, -1}, {0, -1}, {1, -1},
+    {-1,  0},          {1,  0},
+    {-1,  1}, {0,  1}, {1,  1}
+};
+
+const size_t DIRECTIONS_BISHOP[] = {0, 2, 5, 7};
+const size_t DIRECTIONS_ROOK[]   = {1, 3, 4, 6};
+const size_t DIRECTIONS_QUEEN[]  = {0, 1, 2, 3, 4, 5, 6, 7};
+
+
+/* Globals */
+
+static enum ChessSliderMode SLIDER_MODE = SLIDERS_MAGIC;
+
+
+
+/* Functions */
+
+/**
+ * Get the ASCII character associated with piece.
+ *
+ * @param   piece   ChessPiece to convert to character.
+ * @return  Character ASCII piece or 0 if error.
+**/
+char            get_piece_char(ChessPiece piece) {
+    
+    ChessPiece color = piece_color(piece);
+    piece = piece & PIECE_TYPE_BITMASK;
+    for (int i = 0; i < 6; i++) {
+        if (piece == PAWN) {
+            if (color == WHITE) return toupper(PIECE_CHARS[i]);
+            else return PIECE_CHARS[i];
+        }
+        piece--;
+    }
+
+    return '\0';
+}
+
+/**
+ * Get the ChessPiece associated with ASCII character.
+ *
+ * @param   c   ASCII character to convert to piece.
+ * @return  ChessPiece or 0 if error.
+**/
+ChessPiece      get_char_piece(char c) {
+
+    ChessPiece color = (isupper(c)) ? WHITE : BLACK;
+    c = tolower(c);
+    ChessPiece piece = PAWN;
+    for (char *cmp = (char *)PIECE_CHARS; *cmp; cmp++) {
+        if (c == *cmp) return piece | color;
+        piece++;
+    }
+
+    return EMPTY;
+}
+
+/**
+ * Diagonal slider attacks using the selected slider generator.
+ *
+ * @param   square      Square (0-63) of the slider.
+ * @param   occupancy   Bitboard of blocking pieces.
+ *
+ * @return  Bitboard of attacked squares.
+**/
+static inline Bitboard bishop_attacks(uint8_t square, Bitboard occupancy) {
+    if (SLIDER_MODE == SLIDERS_MAGIC) return magic_bishop_attacks(square, occupancy);
+    return magic_slow_attacks(square, occupancy, true);
+}
+
+/**
+ * Orthogonal slider attacks using the selected slider generator.
+ *
+ * @param   square      Square (0-63) of the slider.
+ * @param   occupancy   Bitboard of blocking pieces.
+ *
+ * @return  Bitboard of attacked squares.
+**/
+static inline Bitboard rook_attacks(uint8_t square, Bitboard occupancy) {
+    if (SLIDER_MODE == SLIDERS_MAGIC) return magic_rook_attacks(square, occupancy);
+    return magic_slow_attacks(square, occupancy, false);
+}
+
+/**
+ * Squares attacked by every piece on one piece bitboard.
+ *
+ * @param   cb      Pointer to ChessBoard structure.
+ * @param   index   Piece bitboard index (BB_IDX_PIECE of a coloured piece).
+ *
+ * @return  Bitboard of attacked squares.
+**/
+static inline Bitboard  piece_targets(ChessBoard *cb, uint8_t index) {
+
+    Bitboard pieces = cb->locations[index];
+    Bitboard occupancy = cb->locations[BB_IDX_ALL];
+    Bitboard targets = 0lu;
+
+    switch (piece_type(index)) {
+        case PAWN:      return bitboard_pawn_attacks(pieces, piece_color(index) == BLACK);
+        case KNIGHT:    return bitboard_knight_attacks(pieces);
+        case KING:      return bitboard_king_attacks(pieces);
+        case BISHOP:
+            while (pieces) targets |= bishop_attacks(bitboard_pop_lsb(pieces), occupancy);
+            return targets;
+        case ROOK:
+            while (pieces) targets |= rook_attacks(bitboard_pop_lsb(pieces), occupancy);
+            return targets;
+        case QUEEN:
+            while (pieces) {
+                uint8_t square = bitboard_pop_lsb(pieces);
+                targets |= bishop_attacks(square, occupancy) | rook_attacks(square, occupancy);
+            }
+            return targets;
+        default:
+            return 0lu;
+    }
+}
+
+/**
+ * Bring the attack maps up to date after pieces were moved.
+ *
+ * Only the piece bitboards flagged dirty (their pieces moved, appeared or
+ * disappeared) and the sliders whose current attacks reach a changed
+ * square (a ray that was blocked there or ran through it) are recomputed.
+ * Pawn, knight and king maps never depend on occupancy.
+ *
+ * @param   cb      Pointer to ChessBoard structure.
+ * @param   changed Bitboard of squares whose contents changed.
+ * @param   dirty   Mask with bit BB_IDX_PIECE(piece) set for every piece bitboard that changed.
+**/
+static inline void  update_targets(ChessBoard *cb, Bitboard changed, uint16_t dirty) {
+
+    for (uint8_t index = BB_IDX_PIECE(PAWN | WHITE); index <= BB_IDX_PIECE(KING | BLACK); index++) {
+        if (index == BB_IDX_ALL || index == BB_IDX_COLOR(BLACK)) continue;
+
+        ChessPiece type = piece_type(index);
+        bool slider = type == BISHOP || type == ROOK || type == QUEEN;
+        if ((dirty & (1u << index)) || (slider && (cb->targets[index] & changed)))
+            cb->targets[index] = piece_targets(cb, index);
+    }
+
+    Bitboard white = 0lu, black = 0lu;
+    for (ChessPiece type = PAWN; type <= KING; type++) {
+        white |= cb->targets[BB_IDX_PIECE(type | WHITE)];
+        black |= cb->targets[BB_IDX_PIECE(type | BLACK)];
+    }
+    cb->targets[BB_IDX_COLOR(WHITE)] = white;
+    cb->targets[BB_IDX_COLOR(BLACK)] = black;
+    cb->targets[BB_IDX_ALL] = white | black;
+}
+
+/**
+ * Step over the spaces before the next FEN field.
+ *
+ * @param   c       Pointer to the character after the last field.
+ *
+ * @return  Pointer to the next field, or NULL if there is none.
+**/
+static inline const char *  fen_next_field(const char *c) {
+    if (*c != ' ') return NULL;
+    while (*c == ' ') c++;
+    return (*c) ? c : NULL;
+}
+
+/**
+ * Parse a FEN string into a caller-owned ChessBoard structure. Fields after
+ * the piece placement may be missing (as in EPD, where operations follow the
+ * en passant square); missing fields keep their defaults.
+ *
+ * @param   cb      Pointer to ChessBoard structure to initialize.
+ * @param   fen     Forsyth-Edwards Notation string (if NULL, default initial position is used).
+ *
+ * @return  Pointer to the first character after the FEN, or NULL if the
+ *          piece placement is invalid.
+**/
+const char *        chessboard_parse_fen(ChessBoard *cb, const char *fen) {
+
+    // Handle event that fen is NULL.
+    if (!fen) fen = DEFAULT_FEN;
+
+    memset(cb, 0, sizeof(ChessBoard));
+    cb->to_move = WHITE;
+    cb->enpassant_target = -1;
+    cb->halfmove_clock = 0;
+    cb->fullmove_counter = 1;
+
+    // Process position string
+    const char *c = fen, *field;
+    uint8_t file = 0, rank = 7;
+    for (; *c && *c != ' '; c++) {
+        if (*c == '/') {
+            if (!rank--) return NULL;
+            file = 0;
+        } else if (*c >= '1' && *c <= '8') {
+            file += *c - '0';
+            if (file > 8) return NULL;
+        } else {
+            ChessPiece piece = ((uint8_t) *c < 128) ? FEN_CHAR_PIECES[(uint8_t) *c] : EMPTY;
+            if (!piece || file >= 8) return NULL;
+
+            if (piece == (KING | WHITE)) cb->king_pos_w = (rank * 8) + file;
+            if (piece == (KING | BLACK)) cb->king_pos_b = (rank * 8) + file;
+            cb->board[(rank * 8) + file++] = piece;
+        }
+    }
+
+    // Process side-to-move
+    if (!(field = fen_next_field(c))) goto FEN_COMPLETE;
+    if (*field == 'w') cb->to_move = WHITE;
+    else if (*field == 'b') cb->to_move = BLACK;
+    else goto FEN_COMPLETE;
+    c = field + 1;
+
+    // Process castling ability
+    if (!(field = fen_next_field(c))) goto FEN_COMPLETE;
+    for (c = field; *c && *c != ' '; c++) {
+        switch (*c) {
+            case 'K':
+                cb->castle_ability_w |= CAN_CASTLE_SHORT;
+                break;
+            case 'Q':
+                cb->castle_ability_w |= CAN_CASTLE_LONG;
+                break;
+            case 'k':
+                cb->castle_ability_b |= CAN_CASTLE_SHORT;
+                break;
+            case 'q':
+                cb->castle_ability_b |= CAN_CASTLE_LONG;
+                break;
+            case '-':
+                break;
+            default:
+                goto FEN_COMPLETE;
+        }
+    }
+
+    // Process enpassant target square
+    if (!(field = fen_next_field(c))) goto FEN_COMPLETE;
+    if (*field == '-') {
+        c = field + 1;
+    } else {
+        uint8_t ep_file = field[0] - 'a';
+        uint8_t ep_rank = field[1] - '1';
+        if (ep_file >= 8 || ep_rank >= 8) goto FEN_COMPLETE;
+        cb->enpassant_target = (ep_rank * 8) + ep_file;
+        c = field + 2;
+    }
+
+    // Process move counters (EPD operations are not counters)
+    if (!(field = fen_next_field(c)) || !isdigit(*field)) goto FEN_COMPLETE;
+    for (cb->halfmove_clock = 0, c = field; isdigit(*c); c++) cb->halfmove_clock = cb->halfmove_clock * 10 + *c - '0';
+
+    if (!(field = fen_next_field(c)) || !isdigit(*field)) goto FEN_COMPLETE;
+    for (cb->fullmove_counter = 0, c = field; isdigit(*c); c++) cb->fullmove_counter = cb->fullmove_counter * 10 + *c - '0';
+
+FEN_COMPLETE:
+    chessboard_refresh(cb);
+    return c;
+}
+
+/**
+ * Rebuild the location bitboards, attack maps and key of a ChessBoard
+ * structure from its mailbox and state fields.
+ *
+ * @param   cb      Pointer to ChessBoard structure.
+**/
+void                chessboard_refresh(ChessBoard *cb) {
+
+    memset(cb->locations, 0, sizeof(cb->locations));
+    for (uint8_t square = 0; square < 64; square++) {
+        ChessPiece piece = cb->board[square];
+        if (!piece) continue;
+
+        Bitboard bit = 1lu << square;
+        cb->locations[BB_IDX_ALL] |= bit;
+        cb->locations[BB_IDX_COLOR(piece_color(piece))] |= bit;
+        cb->locations[BB_IDX_PIECE(piece)] |= bit;
+    }
+
+    update_targets(cb, ~0lu, 0xFFFF);
+
+    cb->key = chessboard_compute_key(cb);
+}
+
+/**
+ * Initialize a caller-owned ChessBoard structure from a FEN string.
+ *
+ * @param   cb      Pointer to ChessBoard structure to initialize.
+ * @param   fen     Forsyth-Edwards Notation string (if NULL, default initial position is used).
+ *
+ * @return  `true` if successful, `false` if the FEN is invalid.
+**/
+bool                chessboard_init(ChessBoard *cb, const char *fen) {
+    return chessboard_parse_fen(cb, fen) != NULL;
+}
+
+/**
+ * Create ChessBoard structure.
+ *
+ * @param   fen     Forsyth-Edwards Notation string representing position (if NULL, default initial position is created).
+ *
+ * @return  Pointer to new ChessBoard structure, or NULL if error.
+**/
+ChessBoard *        chessboard_create(const char *fen) {
+
+    ChessBoard *cb = (ChessBoard *) malloc(sizeof(ChessBoard));
+    if (cb && !chessboard_init(cb, fen)) {
+        free(cb);
+        return NULL;
+    }
+
+    return cb;
+}
+
+/**
+ * Create ChessBoard structure in an arena. It is released with the arena
+ * and must not be passed to chessboard_delete.
+ *
+ * @param   arena   Pointer to Arena structure.
+ * @param   fen     Forsyth-Edwards Notation string representing position (if NULL, default initial position is created).
+ *
+ * @return  Pointer to new ChessBoard structure, or NULL if error.
+**/
+ChessBoard *        chessboard_create_in(Arena *arena, const char *fen) {
+
+    ChessBoard *cb = (ChessBoard *) arena_alloc(arena, sizeof(ChessBoard));
+    if (cb && !chessboard_init(cb, fen)) return NULL;
+
+    return cb;
+}
+
+
+/**
+ * Deallocate ChessBoard structure.
+ *
+ * @param   cb  Pointer to ChessBoard structure to delete.
+**/
+void                chessboard_delete(ChessBoard *cb) {
+    free(cb);
+}
+
+
+void                chessboard_dump(ChessBoard *cb, FILE *stream) {
+
+    for (ssize_t rank = 7; rank >= 0; rank--) {
+        fprintf(stream, "  +---+---+---+---+---+---+---+---+\n");
+        fprintf(stream, "%ld ", rank + 1);
+        for (ssize_t file = 0; file < 8; file++) {
+            ChessPiece piece = cb->board[rank * 8 + file];
+            char piece_char;
+            if (piece) {
+                piece_char = get_piece_char(piece);
+            } else {
+                piece_char = ' ';
+            }
+            
+            fprintf(stream, "| %c ", piece_char);
+        }
+        fprintf(stream, "|\n");
+    }
+    fprintf(stream, "  +---+---+---+---+---+---+---+---+\n");
+    fprintf(stream, "    a   b   c   d   e   f   g   h  \n");
+}
+
+
+/**
+ * Write the FEN representation of a ChessBoard structure's position into a
+ * caller-provided buffer.
+ *
+ * @param   cb      Pointer to ChessBoard structure.
+ * @param   buf     Buffer to write to (NUL-terminated, truncated if too small).
+ * @param   size    Size of buf (CHESSBOARD_FEN_SIZE always suffices).
+ *
+ * @return  Length of the FEN, not counting the NUL.
+**/
+size_t              chessboard_write_fen(const ChessBoard *cb, char *buf, size_t size) {
+
+    char fen_buf[CHESSBOARD_FEN_SIZE];
+
+    // Process piece position.
+    char *c = fen_buf;
+    for (ssize_t rank = 7; rank >= 0; rank--) {
+        int empty = 0;
+        for (ssize_t file = 0; file < 8; file++) {
+            ChessPiece piece = cb->board[(rank * 8) + file];
+            if (!piece) {
+                empty++;
+                continue;
+            }
+
+            if (empty) {
+                *(c++) = '0' + empty;
+                empty = 0;
+            }
+            *(c++) = FEN_PIECE_CHARS[BB_IDX_PIECE(piece)];
+        }
+
+        if (empty) *(c++) = '0' + empty;
+        if (rank) *(c++) = '/';
+    }
+    *(c++) = ' ';
+
+    // Process side-to-move
+    *(c++) = (cb->to_move == WHITE) ? 'w' : 'b';
+    *(c++) = ' ';
+
+    // Process castle availability
+    char *castle = c;
+    if (cb->castle_ability_w & CAN_CASTLE_SHORT) *(c++) = 'K';
+    if (cb->castle_ability_w & CAN_CASTLE_LONG) *(c++) = 'Q';
+    if (cb->castle_ability_b & CAN_CASTLE_SHORT) *(c++) = 'k';
+    if (cb->castle_ability_b & CAN_CASTLE_LONG) *(c++) = 'q';
+    if (c == castle) *(c++) = '-';
+    *(c++) = ' ';
+
+    // Process enpassant target square
+    if (cb->enpassant_target == -1) {
+        *(c++) = '-';
+    } else {
+        *(c++) = 'a' + cb->enpassant_target % 8;
+        *(c++) = '1' + cb->enpassant_target / 8;
+    }
+
+    // Process move counters (digits are produced backwards, then reversed)
+    size_t counters[] = { cb->halfmove_clock, cb->fullmove_counter };
+    for (size_t i = 0; i < 2; i++) {
+        *(c++) = ' ';
+        char *digits = c;
+        size_t counter = counters[i];
+        do {
+            *(c++) = '0' + counter % 10;
+            counter /= 10;
+        } while (counter);
+        for (char *last = c - 1; digits < last; digits++, last--) {
+            char swap = *digits;
+            *digits = *last;
+            *last = swap;
+        }
+    }
+
+    size_t length = c - fen_buf;
+    if (size) {
+        size_t copied = (length < size) ? length : size - 1;
+        memcpy(buf, fen_buf, copied);
+        buf[copied] = '\0';
+    }
+    return length;
+}
+
+/**
+ * Get the FEN representation of a ChessBoard structure's position.
+ *
+ * @param   cb  Pointer to ChessBoard structure.
+ *
+ * @return  FEN string (must be freed) or NULL if error.
+**/
+char *              chessboard_to_fen(ChessBoard *cb) {
+
+    char fen_buf[CHESSBOARD_FEN_SIZE];
+    chessboard_write_fen(cb, fen_buf, sizeof(fen_buf));
+    return strdup(fen_buf);
+}
+
+
+/**
+ * Zobrist key contribution of castle ability and en passant file.
+ *
+ * @param   cb      Pointer to ChessBoard structure.
+ *
+ * @return  Key to XOR out before (and back in after) a state change.
+**/
+static inline uint64_t zobrist_state_key(ChessBoard *cb) {
+
+    uint64_t key = ZOBRIST_CASTLE[zobrist_castle_index(cb->castle_ability_w, cb->castle_ability_b)];
+    if (cb->enpassant_target != -1) key ^= ZOBRIST_ENPASSANT[cb->enpassant_target % 8];
+    return key;
+}
+
+/**
+ * Compute the Zobrist key of a position from scratch.
+ *
+ * @param   cb      Pointer to ChessBoard structure.
+ *
+ * @return  64-bit key of pieces, side to move, castle ability and en passant file.
+**/
+uint64_t            chessboard_compute_key(ChessBoard *cb) {
+
+    uint64_t key = 0;
+    for (uint8_t square = 0; square < 64; square++) {
+        if (cb->board[square]) key ^= ZOBRIST_PIECES[BB_IDX_PIECE(cb->board[square])][square];
+    }
+
+    key ^= zobrist_state_key(cb);
+    if (cb->to_move == BLACK) key ^= ZOBRIST_SIDE;
+    return key;
+}
+
+/**
+ * Place a piece on an empty square, keeping the location bitboards in sync.
+ *
+ * @param   cb      Pointer to ChessBoard structure.
+ * @param   square  Square (0-63) to place the piece on.
+ * @param   piece   ChessPiece to place.
+**/
+static inline void  put_piece(ChessBoard *cb, uint8_t square, ChessPiece piece) {
+
+    Bitboard bb = 1lu << square;
+    cb->board[square] = piece;
+    cb->key ^= ZOBRIST_PIECES[BB_IDX_PIECE(piece)][square];
+    cb->locations[BB_IDX_ALL]                       |= bb;
+    cb->locations[BB_IDX_COLOR(piece_color(piece))] |= bb;
+    cb->locations[BB_IDX_PIECE(piece)]              |= bb;
+}
+
+/**
+ * Remove the piece on a square, keeping the location bitboards in sync.
+ *
+ * @param   cb      Pointer to ChessBoard structure.
+ * @param   square  Square (0-63) to clear.
+ *
+ * @return  ChessPiece that was removed.
+**/
+static inline ChessPiece remove_piece(ChessBoard *cb, uint8_t square) {
+
+    Bitboard bb = 1lu << square;
+    ChessPiece piece = cb->board[square];
+    cb->board[square] = EMPTY;
+    cb->key ^= ZOBRIST_PIECES[BB_IDX_PIECE(piece)][square];
+    cb->locations[BB_IDX_ALL]                       &= ~bb;
+    cb->locations[BB_IDX_COLOR(piece_color(piece))] &= ~bb;
+    cb->locations[BB_IDX_PIECE(piece)]              &= ~bb;
+    return piece;
+}
+
+/**
+ * Revoke castle ability when a king or rook square is vacated or captured on.
+ *
+ * @param   cb      Pointer to ChessBoard structure.
+ * @param   square  Square (0-63) touched by the move.
+**/
+static inline void  update_castle_ability(ChessBoard *cb, uint8_t square) {
+
+    switch (square) {
+        case 0:  cb->castle_ability_w &= ~CAN_CASTLE_LONG;  break;
+        case 7:  cb->castle_ability_w &= ~CAN_CASTLE_SHORT; break;
+        case 4:  cb->castle_ability_w = 0;                  break;
+        case 56: cb->castle_ability_b &= ~CAN_CASTLE_LONG;  break;
+        case 63: cb->castle_ability_b &= ~CAN_CASTLE_SHORT; break;
+        case 60: cb->castle_ability_b = 0;                  break;
+        default: break;
+    }
+}
+
+/**
+ * Perform a ChessMove action for the current player, saving irreversible
+ * state to undo.
+ *
+ * @param   cb      Pointer to ChessBoard structure.
+ * @param   move    ChessMove object containing encoded move information.
+ * @param   undo    Pointer to ChessUndo structure to populate (untouched on failure).
+ *
+ * @return  `true` if operation was successful, `false` otherwise.
+**/
+static inline bool  make_move(ChessBoard *cb, ChessMove move, ChessUndo *undo) {
+
+    uint8_t position_from   = MOVE_FROM(move);
+    uint8_t position_to     = MOVE_TO(move);
+    ChessPiece promotion    = MOVE_PROMOTION(move);
+
+    ChessPiece color = cb->to_move;
+
+    // TODO: Check legality
+    ChessPiece piece = cb->board[position_from];
+    ChessPiece captured = cb->board[position_to];
+
+    if (!piece || piece_color(piece) != color) return false;
+    if (captured && piece_color(captured) == color) return false;
+
+    Bitboard occupancy = cb->locations[BB_IDX_ALL];
+    uint16_t dirty = 1u << BB_IDX_PIECE(piece);
+
+    undo->castle_ability_w  = cb->castle_ability_w;
+    undo->castle_ability_b  = cb->castle_ability_b;
+    undo->enpassant_target  = cb->enpassant_target;
+    undo->king_pos_w        = cb->king_pos_w;
+    undo->king_pos_b        = cb->king_pos_b;
+    undo->halfmove_clock    = cb->halfmove_clock;
+    undo->key               = cb->key;
+
+    cb->key ^= zobrist_state_key(cb);
+
+    ChessPiece type = piece_type(piece);
+    cb->halfmove_clock++;
+
+    // Captures (en passant removes the pawn behind the target square)
+    if (type == PAWN && position_to == cb->enpassant_target) {
+        uint8_t position_captured = (color == WHITE) ? position_to - 8 : position_to + 8;
+        captured = remove_piece(cb, position_captured);
+    } else if (captured) {
+        remove_piece(cb, position_to);
+    }
+    undo->captured = captured;
+    if (captured) dirty |= 1u << BB_IDX_PIECE(captured);
+    if (promotion) dirty |= 1u << BB_IDX_PIECE(promotion | color);
+
+    remove_piece(cb, position_from);
+    put_piece(cb, position_to, (promotion) ? (promotion | color) : piece);
+
+    // Castling moves the rook alongside the king
+    if (type == KING) {
+        if (color == WHITE) cb->king_pos_w = position_to;
+        else cb->king_pos_b = position_to;
+
+        if (position_to == position_from + 2) {
+            put_piece(cb, position_from + 1, remove_piece(cb, position_from + 3));
+            dirty |= 1u << BB_IDX_PIECE(ROOK | color);
+        } else if (position_from == position_to + 2) {
+            put_piece(cb, position_from - 1, remove_piece(cb, position_from - 4));
+            dirty |= 1u << BB_IDX_PIECE(ROOK | color);
+        }
+    }
+
+    update_castle_ability(cb, position_from);
+    update_castle_ability(cb, position_to);
+
+    cb->enpassant_target = -1;
+    if (type == PAWN) {
+        cb->halfmove_clock = 0;
+        if (position_to == position_from + 16 || position_from == position_to + 16)
+            cb->enpassant_target = (position_from + position_to) / 2;
+    }
+    if (captured) cb->halfmove_clock = 0;
+
+    if (color == BLACK) cb->fullmove_counter++;
+    cb->to_move = (color == WHITE) ? BLACK : WHITE;
+
+    cb->key ^= zobrist_state_key(cb) ^ ZOBRIST_SIDE;
+    if (cb->prefetch) cb->prefetch(cb->prefetch_arg, cb->key);
+#ifdef CHESSBOARD_DEBUG
+    assert(cb->key == chessboard_compute_key(cb));
+#endif
+
+    // The attack map update overlaps with the prefetch
+    update_targets(cb, (occupancy ^ cb->locations[BB_IDX_ALL]) | (1lu << position_to), dirty);
+    return true;
+}
+
+/**
+ * Perform a ChessMove action for the current player
+ *
+ * The irreversible state is discarded, so the move cannot be unmade; use
+ * chessboard_make_move_with to keep it.
+ * 
+ * @param   cb      Pointer to ChessBoard structure.
+ * @param   move    ChessMove object containing encoded move information.
+ * 
+ * @return  `true` if operation was successful, `false` otherwise.
+ */
+bool                chessboard_make_move(ChessBoard *cb, ChessMove move) {
+
+    ChessUndo undo;
+    return make_move(cb, move, &undo);
+}
+
+/**
+ * Perform a ChessMove action for the current player, saving irreversible
+ * state in caller-owned memory (a search keeps one per ply, a game one per
+ * record).
+ *
+ * @param   cb      Pointer to ChessBoard structure.
+ * @param   move    ChessMove object containing encoded move information.
+ * @param   undo    Pointer to ChessUndo structure to populate.
+ *
+ * @return  `true` if operation was successful, `false` otherwise.
+**/
+bool                chessboard_make_move_with(ChessBoard *cb, ChessMove move, ChessUndo *undo) {
+    return make_move(cb, move, undo);
+}
+
+
+/**
+ * Undo a ChessMove action for the previous player from saved state.
+ *
+ * @param   cb      Pointer to ChessBoard structure.
+ * @param   move    ChessMove object (must be the last move made on cb).
+ * @param   undo    Pointer to ChessUndo structure the move populated.
+**/
+static inline void  unmake_move(ChessBoard *cb, ChessMove move, const ChessUndo *undo) {
+
+    uint8_t position_from   = MOVE_FROM(move);
+    uint8_t position_to     = MOVE_TO(move);
+
+    ChessPiece color = (cb->to_move == WHITE) ? BLACK : WHITE;
+    cb->key ^= zobrist_state_key(cb) ^ ZOBRIST_SIDE;
+
+    Bitboard occupancy = cb->locations[BB_IDX_ALL];
+    ChessPiece piece = remove_piece(cb, position_to);
+    uint16_t dirty = 1u << BB_IDX_PIECE(piece);
+    if (MOVE_PROMOTION(move)) piece = PAWN | color;
+    put_piece(cb, position_from, piece);
+    dirty |= 1u << BB_IDX_PIECE(piece);
+
+    ChessPiece type = piece_type(piece);
+    if (type == KING) {
+        if (position_to == position_from + 2) {
+            put_piece(cb, position_from + 3, remove_piece(cb, position_from + 1));
+            dirty |= 1u << BB_IDX_PIECE(ROOK | color);
+        } else if (position_from == position_to + 2) {
+            put_piece(cb, position_from - 4, remove_piece(cb, position_from - 1));
+            dirty |= 1u << BB_IDX_PIECE(ROOK | color);
+        }
+    }
+
+    if (undo->captured) {
+        uint8_t position_captured = position_to;
+        if (type == PAWN && position_to == undo->enpassant_target)
+            position_captured = (color == WHITE) ? position_to - 8 : position_to + 8;
+        put_piece(cb, position_captured, undo->captured);
+        dirty |= 1u << BB_IDX_PIECE(undo->captured);
+    }
+
+    update_targets(cb, (occupancy ^ cb->locations[BB_IDX_ALL]) | (1lu << position_to), dirty);
+
+    cb->castle_ability_w    = undo->castle_ability_w;
+    cb->castle_ability_b    = undo->castle_ability_b;
+    cb->enpassant_target    = undo->enpassant_target;
+    cb->king_pos_w          = undo->king_pos_w;
+    cb->king_pos_b          = undo->king_pos_b;
+    cb->halfmove_clock      = undo->halfmove_clock;
+
+    if (color == BLACK) cb->fullmove_counter--;
+    cb->to_move = color;
+
+    cb->key ^= zobrist_state_key(cb);
+#ifdef CHESSBOARD_DEBUG
+    assert(cb->key == undo->key);
+    assert(cb->key == chessboard_compute_key(cb));
+#endif
+}
+
+/**
+ * Undo a ChessMove action made with chessboard_make_move_with.
+ *
+ * @param   cb      Pointer to ChessBoard structure.
+ * @param   move    ChessMove object (must be the last move made on cb).
+ * @param   undo    Pointer to ChessUndo structure the move populated.
+ *
+ * @return  `true` if operation was successful, `false` otherwise.
+**/
+bool                chessboard_unmake_move_with(ChessBoard *cb, ChessMove move, const ChessUndo *undo) {
+    unmake_move(cb, move, undo);
+    return true;
+}
+
+
+/**
+ * Determine whether a square is attacked by any piece of a color (a single
+ * lookup in the maintained attack map).
+ *
+ * @param   cb      Pointer to ChessBoard structure.
+ * @param   square  Square (0-63) to test.
+ * @param   color   Color of the attacking side.
+ *
+ * @return  `true` if the square is attacked, `false` otherwise.
+**/
+bool                chessboard_square_attacked(ChessBoard *cb, uint8_t square, ChessPiece color) {
+    return (cb->targets[BB_IDX_COLOR(color)] >> square) & 1;
+}
+
+
+/**
+ * Determine whether the king of a color is in check.
+ *
+ * @param   cb      Pointer to ChessBoard structure.
+ * @param   color   Color of the king.
+ *
+ * @return  `true` if the king is attacked, `false` otherwise.
+**/
+bool                chessboard_in_check(ChessBoard *cb, ChessPiece color) {
+
+    uint8_t king_pos = (color == WHITE) ? cb->king_pos_w : cb->king_pos_b;
+    return chessboard_square_attacked(cb, king_pos, (color == WHITE) ? BLACK : WHITE);
+}
+
+
+/**
+ * Generate sliding piece moves by walking each ray one square at a time.
+ *
+ * @param   cb          Pointer to ChessBoard structure.
+ * @param   position    Square (0-63) of the sliding piece.
+ * @param   type        Piece type (BISHOP, ROOK, or QUEEN).
+ * @param   out         Pointer to array of ChessMoves to populate.
+ *
+ * @return  Number of moves written to out.
+**/
+static size_t       slider_moves_rays(ChessBoard *cb, uint8_t position, ChessPiece type, ChessMove *out) {
+
+    size_t move_idx = 0;
+    ChessPiece color = cb->to_move;
+    ChessPiece enemy_color = (color == WHITE) ? BLACK : WHITE;
+
+    const size_t *directions = DIRECTIONS_QUEEN;
+    size_t directions_count = sizeof(DIRECTIONS_QUEEN)/sizeof(size_t);
+    if (type == BISHOP) {
+        directions = DIRECTIONS_BISHOP;
+        directions_count = sizeof(DIRECTIONS_BISHOP)/sizeof(size_t);
+    } else if (type == ROOK) {
+        directions = DIRECTIONS_ROOK;
+        directions_count = sizeof(DIRECTIONS_ROOK)/sizeof(size_t);
+    }
+
+    for (size_t i = 0; i < directions_count; i++) {
+        size_t dir_index = directions[i];
+        ssize_t dx = DIRECTIONS[dir_index][1];
+        ssize_t dy = DIRECTIONS[dir_index][0];
+        size_t new_file = (position % 8) + dx;
+        size_t new_rank = (position / 8) + dy;
+
+        while (new_file < 8 && new_rank < 8) {
+            if (bitboard_get(cb->locations[BB_IDX_COLOR(color)], new_file, new_rank)) break;
+            out[move_idx++] = position | ((new_file + new_rank * 8) << 6);
+            if (bitboard_get(cb->locations[BB_IDX_COLOR(enemy_color)], new_file, new_rank)) break;
+
+            new_file += dx;
+            new_rank += dy;
+        }
+    }
+
+    return move_idx;
+}
+
+/**
+ * Generate sliding piece moves from the magic attack tables.
+ *
+ * @param   cb          Pointer to ChessBoard structure.
+ * @param   position    Square (0-63) of the sliding piece.
+ * @param   type        Piece type (BISHOP, ROOK, or QUEEN).
+ * @param   out         Pointer to array of ChessMoves to populate.
+ *
+ * @return  Number of moves written to out.
+**/
+static size_t       slider_moves_magic(ChessBoard *cb, uint8_t position, ChessPiece type, ChessMove *out) {
+
+    size_t move_idx = 0;
+    Bitboard occupancy = cb->locations[BB_IDX_ALL];
+
+    Bitboard targets = 0lu;
+    if (type != ROOK)   targets |= magic_bishop_attacks(position, occupancy);
+    if (type != BISHOP) targets |= magic_rook_attacks(position, occupancy);
+    targets &= ~cb->locations[BB_IDX_COLOR(cb->to_move)];
+
+    while (targets) {
+        uint8_t target = bitboard_pop_lsb(targets);
+        out[move_idx++] = position | (target << 6);
+    }
+
+    return move_idx;
+}
+
+
+/**
+ * Write a move for every target square (or only count them).
+ *
+ * @param   from        Square (0-63) the piece moves from.
+ * @param   targets     Bitboard of destination squares.
+ * @param   out         Pointer to array of ChessMoves to populate (NULL to count only).
+ * @param   move_idx    Index in out of the first move to write.
+ *
+ * @return  Number of moves added.
+**/
+static inline size_t    serialize_moves(uint8_t from, Bitboard targets, ChessMove *out, size_t move_idx) {
+
+    if (!out) return bitboard_popcount(targets);
+
+    size_t start = move_idx;
+    while (targets) {
+        uint8_t to = bitboard_pop_lsb(targets);
+        out[move_idx++] = MOVE_CREATE(from, to, 0);
+    }
+    return move_idx - start;
+}
+
+/**
+ * Write a pawn move, expanding it into four moves if it promotes (or only count them).
+ *
+ * @param   from        Square (0-63) the pawn moves from.
+ * @param   to          Square (0-63) the pawn moves to.
+ * @param   out         Pointer to array of ChessMoves to populate (NULL to count only).
+ * @param   move_idx    Index in out of the first move to write.
+ *
+ * @return  Number of moves added.
+**/
+static inline size_t    serialize_pawn_move(uint8_t from, uint8_t to, ChessMove *out, size_t move_idx) {
+
+    if (to < 8 || to >= 56) {
+        if (out) {
+            out[move_idx + 0] = MOVE_CREATE(from, to, QUEEN);
+            out[move_idx + 1] = MOVE_CREATE(from, to, ROOK);
+            out[move_idx + 2] = MOVE_CREATE(from, to, BISHOP);
+            out[move_idx + 3] = MOVE_CREATE(from, to, KNIGHT);
+        }
+        return 4;
+    }
+
+    if (out) out[move_idx] = MOVE_CREATE(from, to, 0);
+    return 1;
+}
+
+/**
+ * Write (or count) a pawn move for every target square of one set-wise shift.
+ *
+ * @param   targets     Bitboard of destination squares.
+ * @param   offset      Square difference from origin to destination.
+ * @param   out         Pointer to array of ChessMoves to populate (NULL to count only).
+ * @param   move_idx    Index in out of the first move to write.
+ *
+ * @return  Number of moves added.
+**/
+static inline size_t    serialize_pawn_targets(Bitboard targets, int offset, ChessMove *out, size_t move_idx) {
+
+    Bitboard promotions = BB_RANK_1 | BB_RANK_8;
+    if (!out) return bitboard_popcount(targets & ~promotions) + 4 * bitboard_popcount(targets & promotions);
+
+    size_t start = move_idx;
+    while (targets) {
+        uint8_t to = bitboard_pop_lsb(targets);
+        move_idx += serialize_pawn_move(to - offset, to, out, move_idx);
+    }
+    return move_idx - start;
+}
+
+/**
+ * Generate (or count) pushes, double pushes, captures and promotions for a
+ * set of pawns at once (en passant is left to the caller).
+ *
+ * @param   pawns       Bitboard of pawns to move.
+ * @param   color       Color of the pawns.
+ * @param   occupancy   Bitboard of all pieces.
+ * @param   enemy       Bitboard of capturable pieces.
+ * @param   allowed     Bitboard of permitted destination squares.
+ * @param   out         Pointer to array of ChessMoves to populate (NULL to count only).
+ * @param   move_idx    Index in out of the first move to write.
+ *
+ * @return  Number of moves added.
+**/
+static inline size_t    pawn_moves(Bitboard pawns, ChessPiece color, Bitboard occupancy, Bitboard enemy,
+                                   Bitboard allowed, ChessMove *out, size_t move_idx) {
+
+    Bitboard single, double_push, west, east;
+    int direction;
+    if (color == WHITE) {
+        direction = 8;
+        single = bitboard_north(pawns) & ~occupancy;
+        double_push = bitboard_north(single & BB_RANK_3) & ~occupancy;
+        west = bitboard_north_west(pawns);
+        east = bitboard_north_east(pawns);
+    } else {
+        direction = -8;
+        single = bitboard_south(pawns) & ~occupancy;
+        double_push = bitboard_south(single & BB_RANK_6) & ~occupancy;
+        west = bitboard_south_west(pawns);
+        east = bitboard_south_east(pawns);
+    }
+
+    size_t start = move_idx;
+    move_idx += serialize_pawn_targets(single & allowed, direction, out, move_idx);
+    move_idx += serialize_pawn_targets(double_push & allowed, 2 * direction, out, move_idx);
+    move_idx += serialize_pawn_targets(west & enemy & allowed, direction - 1, out, move_idx);
+    move_idx += serialize_pawn_targets(east & enemy & allowed, direction + 1, out, move_idx);
+    return move_idx - start;
+}
+
+/**
+ * Generate list of pseudolegal moves for current player (may put the player in check)
+ *
+ * @param   cb      Pointer to ChessBoard structure.
+ * @param   out     Pointer to array of ChessMoves to populate 
+ *                      (MAX_MOVES elements, terminated with null move)
+ *
+ * @return  Number of moves written to out.
+**/
+size_t              chessboard_pseudolegal_moves(ChessBoard *cb, ChessMove *out) {
+
+    size_t move_idx = 0;
+    ChessPiece color = cb->to_move;
+    ChessPiece enemy_color = (color == WHITE) ? BLACK : WHITE;
+
+    // Pawns, all at once
+    Bitboard pawns = cb->locations[BB_IDX_PIECE(PAWN | color)];
+    move_idx += pawn_moves(pawns, color, cb->locations[BB_IDX_ALL], cb->locations[BB_IDX_COLOR(enemy_color)],
+                           ~0lu, out, move_idx);
+    if (cb->enpassant_target != -1) {
+        Bitboard capturers = PAWN_ATTACKS[COLOR_ARR_INDEX(enemy_color)][cb->enpassant_target] & pawns;
+        while (capturers) out[move_idx++] = MOVE_CREATE(bitboard_pop_lsb(capturers), cb->enpassant_target, 0);
+    }
+
+    Bitboard own = cb->locations[BB_IDX_COLOR(color)];
+    Bitboard knights = cb->locations[BB_IDX_PIECE(KNIGHT | color)];
+    while (knights) {
+        uint8_t position = bitboard_pop_lsb(knights);
+        move_idx += serialize_moves(position, KNIGHT_ATTACKS[position] & ~own, out, move_idx);
+    }
+
+    for (ChessPiece type = BISHOP; type <= QUEEN; type++) {
+        Bitboard sliders = cb->locations[BB_IDX_PIECE(type | color)];
+        while (sliders) {
+            uint8_t position = bitboard_pop_lsb(sliders);
+            if (SLIDER_MODE == SLIDERS_MAGIC) {
+                move_idx += slider_moves_magic(cb, position, type, out + move_idx);
+            } else {
+                move_idx += slider_moves_rays(cb, position, type, out + move_idx);
+            }
+        }
+    }
+
+    uint8_t position = (color == WHITE) ? cb->king_pos_w : cb->king_pos_b;
+    move_idx += serialize_moves(position, KING_ATTACKS[position] & ~own & ~cb->targets[BB_IDX_COLOR(enemy_color)], out, move_idx);
+
+    // Castling (the destination square is checked by the caller's legality test)
+    uint8_t castle_ability = (color == WHITE) ? cb->castle_ability_w : cb->castle_ability_b;
+    if (castle_ability && !chessboard_square_attacked(cb, position, enemy_color)) {
+        Bitboard occupancy = cb->locations[BB_IDX_ALL];
+        if ((castle_ability & CAN_CASTLE_SHORT) &&
+                !(occupancy & (0x06lu << position)) &&
+                !chessboard_square_attacked(cb, position + 1, enemy_color))
+            out[move_idx++] = MOVE_CREATE(position, position + 2, 0);
+        if ((castle_ability & CAN_CASTLE_LONG) &&
+                !(occupancy & (0x0Elu << (position - 4))) &&
+                !chessboard_square_attacked(cb, position - 1, enemy_color))
+            out[move_idx++] = MOVE_CREATE(position, position - 2, 0);
+    }
+
+    out[move_idx] = 0;
+    return move_idx;
+}
+
+
+
+/**
+ * Generate (or count) the legal moves for current player.
+ *
+ * Checkers and pinned pieces are computed once, and the squares attacked by
+ * the enemy come from the maintained attack maps (extended past the king
+ * along a checking ray, so it cannot step away along it); every emitted
+ * move is then legal without make/test/unmake. Always inlined
+ * so that the count-only caller gets its own copy with the stores removed.
+ *
+ * @param   cb      Pointer to ChessBoard structure.
+ * @param   out     Pointer to array of ChessMoves to populate 
+ *                      (MAX_MOVES elements, terminated with null move),
+ *                      or NULL to count only.
+ *
+ * @return  Number of legal moves.
+**/
+static inline __attribute__((always_inline))
+size_t              legal_moves(ChessBoard *cb, ChessMove *out) {
+
+    size_t move_idx = 0;
+    ChessPiece color = cb->to_move;
+    ChessPiece enemy_color = (color == WHITE) ? BLACK : WHITE;
+
+    Bitboard occupancy  = cb->locations[BB_IDX_ALL];
+    Bitboard own        = cb->locations[BB_IDX_COLOR(color)];
+    Bitboard enemy      = cb->locations[BB_IDX_COLOR(enemy_color)];
+
+    Bitboard enemy_pawns    = cb->locations[BB_IDX_PIECE(PAWN | enemy_color)];
+    Bitboard enemy_knights  = cb->locations[BB_IDX_PIECE(KNIGHT | enemy_color)];
+    Bitboard enemy_diagonal = cb->locations[BB_IDX_PIECE(BISHOP | enemy_color)] | cb->locations[BB_IDX_PIECE(QUEEN | enemy_color)];
+    Bitboard enemy_straight = cb->locations[BB_IDX_PIECE(ROOK | enemy_color)] | cb->locations[BB_IDX_PIECE(QUEEN | enemy_color)];
+
+    uint8_t king = (color == WHITE) ? cb->king_pos_w : cb->king_pos_b;
+    Bitboard king_bb = 1lu << king;
+
+    Bitboard checkers = 0lu;
+    if (cb->targets[BB_IDX_COLOR(enemy_color)] & king_bb) {
+        checkers = (KNIGHT_ATTACKS[king] & enemy_knights) |
+            (PAWN_ATTACKS[COLOR_ARR_INDEX(color)][king] & enemy_pawns) |
+            (bishop_attacks(king, occupancy) & enemy_diagonal) |
+            (rook_attacks(king, occupancy) & enemy_straight);
+    }
+
+    // Squares the king may not enter: the maintained attack map, plus the
+    // squares behind the king on a checking slider's line
+    Bitboard danger = cb->targets[BB_IDX_COLOR(enemy_color)];
+    Bitboard slider_checkers = checkers & (enemy_diagonal | enemy_straight);
+    while (slider_checkers) {
+        uint8_t checker = bitboard_pop_lsb(slider_checkers);
+        danger |= LINE[king][checker] & ~(1lu << checker);
+    }
+
+    move_idx += serialize_moves(king, KING_ATTACKS[king] & ~own & ~danger, out, move_idx);
+
+    // Double check: only the king may move
+    if (checkers & (checkers - 1)) {
+        if (out) out[move_idx] = 0;
+        return move_idx;
+    }
+
+    // Destinations that capture or block a single checker
+    Bitboard check_mask = ~0lu;
+    if (checkers) check_mask = checkers | BETWEEN[king][bitboard_lsb(checkers)];
+
+    // Pieces that are the only blocker between the king and an enemy slider
+    Bitboard pinned = 0lu;
+    Bitboard pinners = (bishop_attacks(king, enemy) & enemy_diagonal) | (rook_attacks(king, enemy) & enemy_straight);
+    while (pinners) {
+        Bitboard blockers = BETWEEN[king][bitboard_pop_lsb(pinners)] & occupancy;
+        if (!(blockers & (blockers - 1))) pinned |= blockers & own;
+    }
+
+    // Knights, bishops, rooks and queens
+    for (ChessPiece type = KNIGHT; type <= QUEEN; type++) {
+        Bitboard pieces = cb->locations[BB_IDX_PIECE(type | color)];
+        while (pieces) {
+            uint8_t from = bitboard_pop_lsb(pieces);
+
+            Bitboard targets;
+            if (type == KNIGHT) targets = KNIGHT_ATTACKS[from];
+            else if (type == BISHOP) targets = bishop_attacks(from, occupancy);
+            else if (type == ROOK) targets = rook_attacks(from, occupancy);
+            else targets = bishop_attacks(from, occupancy) | rook_attacks(from, occupancy);
+
+            targets &= ~own & check_mask;
+            if (pinned & (1lu << from)) targets &= LINE[king][from];
+            move_idx += serialize_moves(from, targets, out, move_idx);
+        }
+    }
+
+    // Pawns: unpinned ones set-wise, pinned ones along their pin line
+    Bitboard pawns = cb->locations[BB_IDX_PIECE(PAWN | color)];
+    move_idx += pawn_moves(pawns & ~pinned, color, occupancy, enemy, check_mask, out, move_idx);
+    Bitboard pinned_pawns = pawns & pinned;
+    while (pinned_pawns) {
+        uint8_t from = bitboard_pop_lsb(pinned_pawns);
+        move_idx += pawn_moves(1lu << from, color, occupancy, enemy, check_mask & LINE[king][from], out, move_idx);
+    }
+
+    // En passant: the captured pawn may be the checker, and removing both
+    // pawns from the rank may expose the king to a slider
+    if (cb->enpassant_target != -1) {
+        uint8_t to = cb->enpassant_target;
+        uint8_t captured = (color == WHITE) ? to - 8 : to + 8;
+        Bitboard capturers = PAWN_ATTACKS[COLOR_ARR_INDEX(enemy_color)][to] & pawns;
+        if (!(check_mask & ((1lu << to) | (1lu << captured)))) capturers = 0lu;
+        while (capturers) {
+            uint8_t from = bitboard_pop_lsb(capturers);
+            Bitboard from_bb = 1lu << from;
+            if ((pinned & from_bb) && !(LINE[king][from] & (1lu << to))) continue;
+
+            Bitboard after = (occupancy ^ from_bb ^ (1lu << captured)) | (1lu << to);
+            if (!(rook_attacks(king, after) & enemy_straight) && !(bishop_attacks(king, after) & enemy_diagonal))
+                move_idx += serialize_pawn_move(from, to, out, move_idx);
+        }
+    }
+
+    // Castling (never out of check, through check or into check)
+    uint8_t castle_ability = (color == WHITE) ? cb->castle_ability_w : cb->castle_ability_b;
+    if (castle_ability && !checkers) {
+        if ((castle_ability & CAN_CASTLE_SHORT) &&
+                !(occupancy & (0x06lu << king)) && !(danger & (0x06lu << king)))
+            move_idx += serialize_moves(king, 1lu << (king + 2), out, move_idx);
+        if ((castle_ability & CAN_CASTLE_LONG) &&
+                !(occupancy & (0x0Elu << (king - 4))) && !(danger & (0x06lu << (king - 3))))
+            move_idx += serialize_moves(king, 1lu << (king - 2), out, move_idx);
+    }
+
+    if (out) out[move_idx] = 0;
+    return move_idx;
+}
+
+/**
+ * Generate list of legal moves for current player
+ *
+ * @param   cb      Pointer to ChessBoard structure.
+ * @param   out     Pointer to array of ChessMoves to populate 
+ *                      (MAX_MOVES elements, terminated with null move)
+ *
+ * @return  Number of moves written to out.
+**/
+size_t              chessboard_legal_moves(ChessBoard *cb, ChessMove *out) {
+    return legal_moves(cb, out);
+}
+
+/**
+ * Count the legal moves for current player without writing them out.
+ *
+ * Sliders, knights and the king add the popcount of their target bitboard
+ * instead of serializing it, which makes this the cheap way to detect mate,
+ * stalemate or to count the last ply of a perft.
+ *
+ * @param   cb      Pointer to ChessBoard structure.
+ *
+ * @return  Number of legal moves.
+**/
+size_t              chessboard_count_legal_moves(ChessBoard *cb) {
+    return legal_moves(cb, NULL);
+}
+
+
+/**
+ * Select the sliding piece move generator (ray walker or magic bitboards).
+ *
+ * @param   mode    SLIDERS_RAYS or SLIDERS_MAGIC.
+**/
+void                chessboard_set_slider_mode(enum ChessSliderMode mode) {
+    SLIDER_MODE = mode;
+}
+
+
+/**
+ * Install a hook that make_move calls with the key of the new position, so
+ * that e.g. a transposition table bucket can be fetched while the rest of
+ * the move is applied.
+ *
+ * @param   cb      Pointer to ChessBoard structure.
+ * @param   func    Function to call (or NULL to remove the hook).
+ * @param   arg     First argument passed to func.
+**/
+void                chessboard_set_prefetch(ChessBoard *cb, ChessPrefetchFunc func, void *arg) {
+    cb->prefetch = func;
+    cb->prefetch_arg = arg;
+}
+
+
+/**
+ * Write a ChessMove in long algebraic (UCI) notation, e.g. "e2e4" or "e7e8q".
+ *
+ * @param   move    ChessMove to convert.
+ * @param   out     Buffer of at least 6 characters.
+**/
+void                chessmove_to_string(ChessMove move, char *out) {
+
+    uint8_t position_from = MOVE_FROM(move);
+    uint8_t position_to = MOVE_TO(move);
+    ChessPiece promotion = MOVE_PROMOTION(move);
+
+    *(out++) = 'a' + position_from % 8;
+    *(out++) = '1' + position_from / 8;
+    *(out++) = 'a' + position_to % 8;
+    *(out++) = '1' + position_to / 8;
+    if (promotion) *(out++) = get_piece_char(promotion | BLACK);
+    *out = '\0';
+}
+
+/**
+ * Parse a move in long algebraic (UCI) notation, e.g. "e2e4" or "e7e8q",
+ * and check that it is legal in the current position.
+ *
+ * @param   cb      Pointer to ChessBoard structure.
+ * @param   str     Move string (may be followed by whitespace or more text).
+ * @param   move    Pointer to ChessMove to populate.
+ *
+ * @return  `true` if the string names a legal move, `false` otherwise.
+**/
+bool                chessboard_move_from_string(ChessBoard *cb, const char *str, ChessMove *move) {
+
+    for (size_t i = 0; i < 4; i++) {
+        char low = (i % 2) ? '1' : 'a';
+        if (str[i] < low || str[i] > low + 7) return false;
+    }
+
+    uint8_t from = (str[0] - 'a') + (str[1] - '1') * 8;
+    uint8_t to = (str[2] - 'a') + (str[3] - '1') * 8;
+    ChessPiece promotion = EMPTY;
+    if (str[4] && !isspace(str[4])) {
+        promotion = piece_type(get_char_piece(tolower(str[4])));
+        if (promotion < KNIGHT || promotion > QUEEN) return false;
+        if (str[5] && !isspace(str[5])) return false;
+    }
+
+    ChessMove moves[MAX_MOVES];
+    size_t moves_count = chessboard_legal_moves(cb, moves);
+    for (size_t i = 0; i < moves_count; i++) {
+        if (moves[i] == MOVE_CREATE(from, to, promotion)) {
+            *move = moves[i];
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Parse a move in Standard Algebraic Notation, e.g. "Nbd7", "exd6", "e8=Q+"
+ * or "O-O-O", and check that it names exactly one legal move.
+ *
+ * @param   cb      Pointer to ChessBoard structure.
+ * @param   str     SAN string (may be followed by whitespace or more text).
+ * @param   move    Pointer to ChessMove to populate.
+ *
+ * @return  `true` if the string names one legal move, `false` otherwise.
+**/
+bool                chessboard_move_from_san(ChessBoard *cb, const char *str, ChessMove *move) {
+
+    const char *c = str;
+    ChessPiece piece = PAWN;
+    ChessPiece promotion = EMPTY;
+    int from_file = -1, from_rank = -1, to = -1, castle = 0;
+
+    if (*c == 'O' || *c == '0') {
+        // Castling is the king moving two squares (zeros are a common variant)
+        char letter = *c;
+        if (c[1] != '-' || c[2] != letter) return false;
+        castle = (c[3] == '-' && c[4] == letter) ? -2 : 2;
+        c += (castle < 0) ? 5 : 3;
+        piece = KING;
+    } else {
+        if (*c && strchr("NBRQK", *c)) piece = piece_type(get_char_piece(*(c++)));
+
+        // Files and ranks in order; the last pair is the destination, any before it disambiguate
+        char coords[4];
+        size_t n = 0;
+        for (; (*c >= 'a' && *c <= 'h') || (*c >= '1' && *c <= '8') || *c == 'x' || *c == '-'; c++) {
+            if (*c == 'x' || *c == '-') continue;
+            if (n == sizeof(coords)) return false;
+            coords[n++] = *c;
+        }
+        if (n < 2 || !islower(coords[n - 2]) || !isdigit(coords[n - 1])) return false;
+        to = (coords[n - 2] - 'a') + (coords[n - 1] - '1') * 8;
+        for (size_t i = 0; i + 2 < n; i++) {
+            if (islower(coords[i])) from_file = coords[i] - 'a';
+            else from_rank = coords[i] - '1';
+        }
+
+        if (*c == '=') c++;
+        if (*c && strchr("NBRQ", *c)) promotion = piece_type(get_char_piece(*(c++)));
+
+        // Pawn pushes stay on their file
+        if (piece == PAWN && from_file < 0) from_file = to % 8;
+    }
+
+    // Check, mate and annotation suffixes carry no move information
+    while (*c == '+' || *c == '#' || *c == '!' || *c == '?') c++;
+    if (*c && !isspace(*c)) return false;
+
+    ChessMove moves[MAX_MOVES];
+    size_t moves_count = chessboard_legal_moves(cb, moves);
+    size_t matches = 0;
+    for (size_t i = 0; i < moves_count; i++) {
+        uint8_t from = MOVE_FROM(moves[i]);
+        if (piece_type(cb->board[from]) != piece) continue;
+
+        if (castle) {
+            if (MOVE_TO(moves[i]) != from + castle) continue;
+        } else {
+            if (MOVE_TO(moves[i]) != to || MOVE_PROMOTION(moves[i]) != promotion) continue;
+            if (from_file >= 0 && from % 8 != from_file) continue;
+            if (from_rank >= 0 && from / 8 != from_rank) continue;
+        }
+
+        *move = moves[i];
+        matches++;
+    }
+
+    return matches == 1;
+}
+
+/**
+ * Count the leaf nodes of the legal move tree (make/unmake, no heap allocation).
+ * The last ply is bulk counted rather than made.
+ *
+ * @param   cb      Pointer to ChessBoard structure.
+ * @param   depth   Number of plies to search.
+ *
+ * @return  Number of leaf nodes at the given depth.
+**/
+size_t              chessboard_perft(ChessBoard *cb, size_t depth) {
+
+    if (depth == 0) return 1;
+    if (depth == 1) return chessboard_count_legal_moves(cb);
+
+    ChessMove moves[MAX_MOVES];
+    size_t moves_count = chessboard_legal_moves(cb, moves);
+
+    size_t nodes = 0;
+    ChessUndo undo;
+    for (size_t i = 0; i < moves_count; i++) {
+        chessboard_make_move_with(cb, moves[i], &undo);
+        nodes += chessboard_perft(cb, depth - 1);
+        chessboard_unmake_move_with(cb, moves[i], &undo);
+    }
+
+    return nodes;
+}
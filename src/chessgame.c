@@ -0,0 +1,274 @@
+/* libchess
+ * Jack O'Connor 2025
+ * src/chessgame.c
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "chess.h"
+
+#include "chessboard.h"
+
+
+/* Constants */
+
+#define CHESSGAME_RECORDS   (128)       // Initial history capacity in plies
+
+
+/* Internal Functions */
+
+/**
+ * Set the game result from the position after the last ply.
+ *
+ * @param   cg      Pointer to ChessGame structure.
+**/
+static void     chessgame_update_result(ChessGame *cg) {
+
+    cg->result = CHESSGAME_ONGOING;
+    if (chessboard_count_legal_moves(cg->board)) return;
+
+    if (!chessboard_in_check(cg->board, cg->board->to_move)) cg->result = CHESSGAME_DRAWN;
+    else cg->result = (cg->board->to_move == WHITE) ? CHESSGAME_BLACK_WON : CHESSGAME_WHITE_WON;
+}
+
+
+/* External Functions */
+
+/**
+ * Create ChessGame structure.
+ *
+ * @param   fen     Starting position (if NULL, default initial position is used).
+ * @param   event   Event tag (copied, or NULL).
+ * @param   site    Site tag (copied, or NULL).
+ * @param   date    Date tag (copied, or NULL).
+ * @param   time    Time tag (copied, or NULL).
+ * @param   round   Round number.
+ * @param   white   White player (copied, or NULL).
+ * @param   black   Black player (copied, or NULL).
+ *
+ * @return  Pointer to new ChessGame structure, or NULL if error.
+**/
+ChessGame *     chessgame_create(const char *fen, char *event, char *site, char *date, char *time, size_t round, char *white, char *black) {
+
+    ChessGame *cg = (ChessGame *) calloc(1, sizeof(ChessGame));
+    if (cg) {
+        cg->board = chessboard_create(fen);
+        cg->records = (ChessRecord *) malloc(CHESSGAME_RECORDS * sizeof(ChessRecord));
+        cg->records_capacity = CHESSGAME_RECORDS;
+        if (!cg->board || !cg->records) {
+            chessboard_delete(cg->board);
+            free(cg->records);
+            free(cg);
+            return NULL;
+        }
+
+        cg->event = event ? strdup(event) : NULL;
+        cg->site = site ? strdup(site) : NULL;
+        cg->date = date ? strdup(date) : NULL;
+        cg->time = time ? strdup(time) : NULL;
+        cg->round = round;
+        cg->white = white ? strdup(white) : NULL;
+        cg->black = black ? strdup(black) : NULL;
+
+        chessgame_update_result(cg);
+    }
+    return cg;
+}
+
+/**
+ * Create ChessGame structure in an arena. The game, its board, tags and
+ * history are released with the arena; chessgame_delete does nothing.
+ *
+ * @param   arena   Pointer to Arena structure.
+ * @param   fen     Starting position (if NULL, default initial position is used).
+ * @param   event   Event tag (copied, or NULL).
+ * @param   site    Site tag (copied, or NULL).
+ * @param   date    Date tag (copied, or NULL).
+ * @param   time    Time tag (copied, or NULL).
+ * @param   round   Round number.
+ * @param   white   White player (copied, or NULL).
+ * @param   black   Black player (copied, or NULL).
+ *
+ * @return  Pointer to new ChessGame structure, or NULL if error.
+**/
+ChessGame *     chessgame_create_in(Arena *arena, const char *fen, char *event, char *site, char *date, char *time, size_t round, char *white, char *black) {
+
+    ChessGame *cg = (ChessGame *) arena_calloc(arena, 1, sizeof(ChessGame));
+    if (cg) {
+        cg->arena = arena;
+        cg->board = chessboard_create_in(arena, fen);
+        cg->records = (ChessRecord *) arena_alloc(arena, CHESSGAME_RECORDS * sizeof(ChessRecord));
+        cg->records_capacity = CHESSGAME_RECORDS;
+        if (!cg->board || !cg->records) return NULL;
+
+        cg->event = event ? arena_strdup(arena, event) : NULL;
+        cg->site = site ? arena_strdup(arena, site) : NULL;
+        cg->date = date ? arena_strdup(arena, date) : NULL;
+        cg->time = time ? arena_strdup(arena, time) : NULL;
+        cg->round = round;
+        cg->white = white ? arena_strdup(arena, white) : NULL;
+        cg->black = black ? arena_strdup(arena, black) : NULL;
+
+        chessgame_update_result(cg);
+    }
+    return cg;
+}
+
+/**
+ * Deallocate ChessGame structure (unless an arena owns it).
+ *
+ * @param   cg      Pointer to ChessGame structure to delete.
+**/
+void            chessgame_delete(ChessGame *cg) {
+    if (!cg || cg->arena) return;
+    chessboard_delete(cg->board);
+    free(cg->event);
+    free(cg->site);
+    free(cg->date);
+    free(cg->time);
+    free(cg->white);
+    free(cg->black);
+    free(cg->records);
+    free(cg);
+}
+
+/**
+ * Play a legal move, discarding any plies that could have been redone.
+ *
+ * @param   cg      Pointer to ChessGame structure.
+ * @param   move    ChessMove to play.
+ *
+ * @return  `true` if the move was legal and played, `false` otherwise.
+**/
+bool            chessgame_move(ChessGame *cg, ChessMove move) {
+
+    if (cg->result) return false;
+
+    ChessMove moves[MAX_MOVES];
+    size_t moves_count = chessboard_legal_moves(cg->board, moves);
+    size_t i = 0;
+    while (i < moves_count && moves[i] != move) i++;
+    if (i == moves_count) return false;
+
+    if (cg->ply_count == cg->records_capacity) {
+        size_t capacity = cg->records_capacity * 2;
+        ChessRecord *records;
+        if (cg->arena) {
+            // The old array stays in the arena until it is reset
+            records = (ChessRecord *) arena_alloc(cg->arena, capacity * sizeof(ChessRecord));
+            if (records) memcpy(records, cg->records, cg->ply_count * sizeof(ChessRecord));
+        } else {
+            records = (ChessRecord *) realloc(cg->records, capacity * sizeof(ChessRecord));
+        }
+        if (!records) return false;
+        cg->records = records;
+        cg->records_capacity = capacity;
+    }
+
+    ChessRecord *record = &cg->records[cg->ply_count];
+    record->move = move;
+    if (!chessboard_make_move_with(cg->board, move, &record->undo)) return false;
+    record->key = cg->board->key;
+
+    cg->records_count = ++cg->ply_count;
+    chessgame_update_result(cg);
+    return true;
+}
+
+/**
+ * Play a move given in Standard Algebraic Notation.
+ *
+ * @param   cg      Pointer to ChessGame structure.
+ * @param   pgn     SAN move, e.g. "Nf3" or "exd8=Q+".
+ *
+ * @return  `true` if the move was legal and played, `false` otherwise.
+**/
+bool            chessgame_move_pgn(ChessGame *cg, const char *pgn) {
+
+    ChessMove move;
+    if (cg->result || !chessboard_move_from_san(cg->board, pgn, &move)) return false;
+    return chessgame_move(cg, move);
+}
+
+/**
+ * Take back the last ply. It stays recorded until another move is played.
+ *
+ * @param   cg      Pointer to ChessGame structure.
+ *
+ * @return  `true` if a ply was taken back, `false` at the start of the game.
+**/
+bool            chessgame_undo(ChessGame *cg) {
+
+    if (!cg->ply_count) return false;
+
+    ChessRecord *record = &cg->records[--cg->ply_count];
+    chessboard_unmake_move_with(cg->board, record->move, &record->undo);
+    cg->result = CHESSGAME_ONGOING;
+    return true;
+}
+
+/**
+ * Replay the ply after the current one.
+ *
+ * @param   cg      Pointer to ChessGame structure.
+ *
+ * @return  `true` if a ply was replayed, `false` if there is none.
+**/
+bool            chessgame_redo(ChessGame *cg) {
+
+    if (cg->ply_count == cg->records_count) return false;
+
+    ChessRecord *record = &cg->records[cg->ply_count++];
+    chessboard_make_move_with(cg->board, record->move, &record->undo);
+
+    // Only the last recorded position can be terminal
+    if (cg->ply_count == cg->records_count) chessgame_update_result(cg);
+    return true;
+}
+
+/**
+ * Access one ply of history.
+ *
+ * @param   cg      Pointer to ChessGame structure.
+ * @param   ply     Ply number (0 is the first move).
+ *
+ * @return  Pointer to ChessRecord structure, or NULL if the ply was not played.
+**/
+const ChessRecord * chessgame_record(const ChessGame *cg, size_t ply) {
+    return (ply < cg->ply_count) ? &cg->records[ply] : NULL;
+}
+
+/**
+ * Count earlier occurrences of the current position since the last capture
+ * or pawn move (two make a threefold repetition).
+ *
+ * @param   cg      Pointer to ChessGame structure.
+ *
+ * @return  Number of earlier plies with the same position key.
+**/
+size_t          chessgame_repetitions(const ChessGame *cg) {
+
+    size_t repetitions = 0;
+    size_t window = cg->board->halfmove_clock;
+    for (size_t back = 2; back <= window && back <= cg->ply_count; back += 2) {
+        size_t ply = cg->ply_count - back;
+        uint64_t key = (ply) ? cg->records[ply - 1].key : cg->records[0].undo.key;
+        if (key == cg->board->key) repetitions++;
+    }
+
+    return repetitions;
+}
+
+/**
+ * Write the FEN of the current position.
+ *
+ * @param   cg      Pointer to ChessGame structure.
+ * @param   fen     Buffer to write to (CHESSBOARD_FEN_SIZE always suffices).
+ * @param   size    Size of fen.
+ *
+ * @return  Length of the FEN, not counting the NUL.
+**/
+size_t          chessgame_to_fen(ChessGame *cg, char *fen, size_t size) {
+    return chessboard_write_fen(cg->board, fen, size);
+}
@@ -0,0 +1,146 @@
+/* libchess
+ * Jack O'Connor 2025
+ * src/epd.c
+ */
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "epd.h"
+
+
+/* Internal Functions */
+
+/**
+ * Parse the NUL-terminated lines of an EpdFile's text in place. Blank lines
+ * and lines starting with '#' are skipped.
+ *
+ * @param   epd     Pointer to EpdFile structure holding text.
+ * @param   length  Length of the text.
+ *
+ * @return  `true` if successful, `false` otherwise.
+**/
+static bool epd_parse_text(EpdFile *epd, size_t length) {
+
+    // Size every array once: one slot per line
+    size_t lines = 1;
+    for (char *c = memchr(epd->text, '\n', length); c; c = memchr(c + 1, '\n', epd->text + length - c - 1)) lines++;
+
+    epd->boards = (ChessBoard *) malloc(lines * sizeof(ChessBoard));
+    epd->fens = (const char **) malloc(lines * sizeof(char *));
+    epd->operations = (const char **) malloc(lines * sizeof(char *));
+    if (!epd->boards || !epd->fens || !epd->operations) return false;
+
+    char *end = epd->text + length;
+    for (char *line = epd->text, *next; line < end; line = next) {
+        char *newline = memchr(line, '\n', end - line);
+        next = (newline) ? newline + 1 : end;
+        if (newline) *newline = '\0';
+        if (newline > line && newline[-1] == '\r') newline[-1] = '\0';
+
+        while (*line == ' ' || *line == '\t') line++;
+        if (!*line || *line == '#') continue;
+
+        char *rest = (char *) chessboard_parse_fen(&epd->boards[epd->count], line);
+        if (!rest) {
+            epd->invalid++;
+            continue;
+        }
+
+        char *operations = rest;
+        while (*operations == ' ' || *operations == '\t') operations++;
+        *rest = '\0';
+
+        epd->fens[epd->count] = line;
+        epd->operations[epd->count] = operations;
+        epd->count++;
+    }
+
+    return true;
+}
+
+
+/* External Functions */
+
+/**
+ * Read a whole EPD file and parse every position.
+ *
+ * @param   path    Path of the EPD file.
+ *
+ * @return  Pointer to new EpdFile structure, or NULL if error.
+**/
+EpdFile *   epd_load(const char *path) {
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+
+    struct stat st;
+    EpdFile *epd = (EpdFile *) calloc(1, sizeof(EpdFile));
+    if (fstat(fd, &st) || !epd || !(epd->text = (char *) malloc(st.st_size + 1))) {
+        close(fd);
+        free(epd);
+        return NULL;
+    }
+
+    size_t length = 0;
+    ssize_t bytes;
+    while (length < (size_t) st.st_size && (bytes = read(fd, epd->text + length, st.st_size - length)) > 0) {
+        length += bytes;
+    }
+    epd->text[length] = '\0';
+    close(fd);
+
+    if (!epd_parse_text(epd, length)) {
+        epd_delete(epd);
+        return NULL;
+    }
+
+    return epd;
+}
+
+/**
+ * Parse every position of EPD text.
+ *
+ * @param   text    EPD text (need not be NUL-terminated; it is copied).
+ * @param   length  Length of text in bytes.
+ *
+ * @return  Pointer to new EpdFile structure, or NULL if error.
+**/
+EpdFile *   epd_parse(const char *text, size_t length) {
+
+    EpdFile *epd = (EpdFile *) calloc(1, sizeof(EpdFile));
+    if (!epd) return NULL;
+
+    epd->text = (char *) malloc(length + 1);
+    if (!epd->text) {
+        free(epd);
+        return NULL;
+    }
+    memcpy(epd->text, text, length);
+    epd->text[length] = '\0';
+
+    if (!epd_parse_text(epd, length)) {
+        epd_delete(epd);
+        return NULL;
+    }
+
+    return epd;
+}
+
+/**
+ * Deallocate EpdFile structure and its positions.
+ *
+ * @param   epd     Pointer to EpdFile structure.
+**/
+void        epd_delete(EpdFile *epd) {
+
+    if (!epd) return;
+    free(epd->text);
+    free(epd->boards);
+    free(epd->fens);
+    free(epd->operations);
+    free(epd);
+}
@@ -0,0 +1,169 @@
+/* libchess
+ * Jack O'Connor 2025
+ * src/gen_tables.c
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bitboard.h"
+#include "magic.h"
+#include "tables.h"
+
+
+/* Constants */
+
+#define VALUES_PER_LINE     (4)
+
+
+/* Types */
+
+typedef struct { // Everything src/tables.c defines, computed at build time
+    Bitboard    knight[64];
+    Bitboard    king[64];
+    Bitboard    pawn[2][64];
+
+    Magic       bishop[64];
+    Magic       rook[64];
+    Bitboard    bishop_table[MAGIC_BISHOP_TABLE_SIZE];
+    Bitboard    rook_table[MAGIC_ROOK_TABLE_SIZE];
+
+    Bitboard    between[64][64];
+    Bitboard    line[64][64];
+
+    uint64_t    zobrist_pieces[16][64];
+    uint64_t    zobrist_castle[16];
+    uint64_t    zobrist_enpassant[8];
+    uint64_t    zobrist_side;
+} Tables;
+
+
+/* Functions */
+
+void    usage(const char *program, int status) {
+    fprintf(stderr, "Usage: %s [OUTPUT]\n", program);
+    fprintf(stderr, "Writes the lookup tables as C source (default: stdout)\n");
+    exit(status);
+}
+
+/**
+ * Write the values of one array (or one row of a 2D array).
+ *
+ * @param   out     Stream to write to.
+ * @param   values  Array of 64-bit values.
+ * @param   count   Number of values.
+ * @param   indent  Indentation of each line.
+**/
+void    emit_values(FILE *out, const uint64_t *values, size_t count, const char *indent) {
+
+    for (size_t i = 0; i < count; i++) {
+        if (i % VALUES_PER_LINE == 0) fprintf(out, "%s", indent);
+        fprintf(out, "0x%016lxlu,", values[i]);
+        fprintf(out, (i % VALUES_PER_LINE == VALUES_PER_LINE - 1 || i == count - 1) ? "\n" : " ");
+    }
+}
+
+/**
+ * Write a 1D array definition.
+ *
+ * @param   out     Stream to write to.
+ * @param   decl    Declaration, e.g. "const Bitboard KNIGHT_ATTACKS[64]".
+ * @param   values  Array of 64-bit values.
+ * @param   count   Number of values.
+**/
+void    emit_array(FILE *out, const char *decl, const uint64_t *values, size_t count) {
+
+    fprintf(out, "%s = {\n", decl);
+    emit_values(out, values, count, "    ");
+    fprintf(out, "};\n\n");
+}
+
+/**
+ * Write a 2D array definition, one braced row per outer index.
+ *
+ * @param   out     Stream to write to.
+ * @param   decl    Declaration, e.g. "const Bitboard LINE[64][64]".
+ * @param   values  Array of rows * columns 64-bit values.
+ * @param   rows    Number of rows.
+ * @param   columns Number of values per row.
+**/
+void    emit_array_2d(FILE *out, const char *decl, const uint64_t *values, size_t rows, size_t columns) {
+
+    fprintf(out, "%s = {\n", decl);
+    for (size_t row = 0; row < rows; row++) {
+        fprintf(out, "    { // %lu\n", row);
+        emit_values(out, values + row * columns, columns, "        ");
+        fprintf(out, "    },\n");
+    }
+    fprintf(out, "};\n\n");
+}
+
+/**
+ * Write the Magic entries of one slider type.
+ *
+ * @param   out     Stream to write to.
+ * @param   decl    Declaration, e.g. "const Magic MAGIC_ROOK[64]".
+ * @param   magics  Array of 64 Magic structures.
+**/
+void    emit_magics(FILE *out, const char *decl, const Magic *magics) {
+
+    fprintf(out, "%s = { // mask, magic, offset, shift\n", decl);
+    for (size_t square = 0; square < 64; square++) {
+        const Magic *m = &magics[square];
+        fprintf(out, "    { 0x%016lxlu, 0x%016lxlu, %6u, %2u },\n", m->mask, m->magic, m->offset, m->shift);
+    }
+    fprintf(out, "};\n\n");
+}
+
+
+/* Main Execution */
+
+int main(int argc, char *argv[]) {
+
+    if (argc > 2 || (argc == 2 && argv[1][0] == '-')) usage(argv[0], (argc == 2) ? EXIT_SUCCESS : EXIT_FAILURE);
+
+    FILE *out = (argc == 2) ? fopen(argv[1], "w") : stdout;
+    Tables *t = (Tables *) malloc(sizeof(Tables));
+    if (!out || !t) {
+        fprintf(stderr, "Unable to open %s\n", (argc == 2) ? argv[1] : "stdout");
+        free(t);
+        return EXIT_FAILURE;
+    }
+
+    tables_compute_leapers(t->knight, t->king, t->pawn);
+    tables_compute_magics(t->bishop, t->bishop_table, true);
+    tables_compute_magics(t->rook, t->rook_table, false);
+    tables_compute_lines(t->between, t->line);
+    tables_compute_zobrist(t->zobrist_pieces, t->zobrist_castle, t->zobrist_enpassant, &t->zobrist_side);
+
+    fprintf(out, "/* libchess\n * Generated by bin/gen_tables (src/gen_tables.c), do not edit\n * src/tables.c\n */\n\n");
+    fprintf(out, "#include <stdint.h>\n\n#include \"bitboard.h\"\n#include \"magic.h\"\n#include \"zobrist.h\"\n\n\n");
+
+    fprintf(out, "/* Attack Tables */\n\n");
+    emit_array(out, "const Bitboard KNIGHT_ATTACKS[64]", t->knight, 64);
+    emit_array(out, "const Bitboard KING_ATTACKS[64]", t->king, 64);
+    emit_array_2d(out, "const Bitboard PAWN_ATTACKS[2][64]", &t->pawn[0][0], 2, 64);
+
+    fprintf(out, "\n/* Magic Tables */\n\n");
+    emit_magics(out, "const Magic MAGIC_BISHOP[64]", t->bishop);
+    emit_magics(out, "const Magic MAGIC_ROOK[64]", t->rook);
+    emit_array(out, "const Bitboard MAGIC_BISHOP_TABLE[MAGIC_BISHOP_TABLE_SIZE]", t->bishop_table, MAGIC_BISHOP_TABLE_SIZE);
+    emit_array(out, "const Bitboard MAGIC_ROOK_TABLE[MAGIC_ROOK_TABLE_SIZE]", t->rook_table, MAGIC_ROOK_TABLE_SIZE);
+
+    fprintf(out, "\n/* Line Tables */\n\n");
+    emit_array_2d(out, "const Bitboard BETWEEN[64][64]", &t->between[0][0], 64, 64);
+    emit_array_2d(out, "const Bitboard LINE[64][64]", &t->line[0][0], 64, 64);
+
+    fprintf(out, "\n/* Zobrist Keys */\n\n");
+    emit_array_2d(out, "const uint64_t ZOBRIST_PIECES[16][64]", &t->zobrist_pieces[0][0], 16, 64);
+    emit_array(out, "const uint64_t ZOBRIST_CASTLE[16]", t->zobrist_castle, 16);
+    emit_array(out, "const uint64_t ZOBRIST_ENPASSANT[8]", t->zobrist_enpassant, 8);
+    fprintf(out, "const uint64_t ZOBRIST_SIDE = 0x%016lxlu;\n", t->zobrist_side);
+
+    free(t);
+    bool failed = ferror(out);
+    if (out != stdout) failed = fclose(out) || failed;
+    return (failed) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
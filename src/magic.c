@@ -0,0 +1,26 @@
+/* libchess
+ * Jack O'Connor 2025
+ * src/magic.c
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "magic.h"
+#include "tables.h"
+
+
+/* External Functions */
+
+/**
+ * Compute slider attacks without the magic tables (reference implementation).
+ *
+ * @param   square      Square (0-63) of the sliding piece.
+ * @param   occupancy   Bitboard of all pieces on the board.
+ * @param   bishop      `true` for diagonal rays, `false` for orthogonal rays.
+ *
+ * @return  Bitboard of attacked squares.
+**/
+Bitboard    magic_slow_attacks(uint8_t square, Bitboard occupancy, bool bishop) {
+    return tables_ray_attacks(square, occupancy, bishop);
+}
@@ -0,0 +1,276 @@
+/* libchess
+ * Jack O'Connor 2025
+ * src/perft.c
+ */
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "perft.h"
+#include "chessboard.h"
+#include "threadpool.h"
+
+
+/* Constants */
+
+#define PERFT_SPLIT_DEPTH   (3)     // Subtrees shallower than this are never split
+
+
+/* Types */
+
+typedef struct {
+    ThreadPool     *pool;
+    PerftHash      *hash;               // NULL when hashing is disabled
+    atomic_size_t   nodes[MAX_MOVES];   // Indexed like PerftResult.divide
+} PerftShared;
+
+typedef struct {
+    size_t          hits;
+    size_t          misses;
+    size_t          overwrites;
+} PerftHashStats;
+
+typedef struct {
+    PerftShared    *shared;
+    size_t          root;
+    size_t          depth;
+    ChessBoard      board;              // Owned by whichever worker runs the task
+} PerftTask;
+
+
+/* Internal Functions */
+
+/**
+ * Count the leaf nodes of the legal move tree, caching subtree counts.
+ *
+ * @param   cb      Pointer to ChessBoard structure.
+ * @param   depth   Number of plies to search.
+ * @param   hash    Pointer to shared PerftHash structure.
+ * @param   stats   Pointer to thread-local hash counters.
+ *
+ * @return  Number of leaf nodes at the given depth.
+**/
+static size_t   perft_hashed(ChessBoard *cb, size_t depth, PerftHash *hash, PerftHashStats *stats) {
+
+    if (depth <= 1) return chessboard_perft(cb, depth);
+
+    PerftHashEntry *entry = &hash->entries[cb->key & hash->mask];
+    uint64_t data = atomic_load_explicit(&entry->data, memory_order_relaxed);
+    uint64_t check = atomic_load_explicit(&entry->check, memory_order_relaxed);
+    if ((check ^ data) == cb->key && (data & 0xFF) == depth) {
+        stats->hits++;
+        return data >> 8;
+    }
+    stats->misses++;
+
+    ChessMove moves[MAX_MOVES];
+    size_t moves_count = chessboard_legal_moves(cb, moves);
+
+    size_t nodes = 0;
+    ChessUndo undo;
+    for (size_t i = 0; i < moves_count; i++) {
+        chessboard_make_move_with(cb, moves[i], &undo);
+        nodes += perft_hashed(cb, depth - 1, hash, stats);
+        chessboard_unmake_move_with(cb, moves[i], &undo);
+    }
+
+    // A torn write from another thread simply fails the XOR check on probe
+    if (data && (check ^ data) != cb->key) stats->overwrites++;
+    data = ((uint64_t)nodes << 8) | depth;
+    atomic_store_explicit(&entry->data, data, memory_order_relaxed);
+    atomic_store_explicit(&entry->check, cb->key ^ data, memory_order_relaxed);
+
+    return nodes;
+}
+
+/**
+ * Count a subtree with or without the shared hash table.
+ *
+ * @param   shared  Pointer to PerftShared structure.
+ * @param   cb      Pointer to ChessBoard structure.
+ * @param   depth   Number of plies to search.
+ *
+ * @return  Number of leaf nodes at the given depth.
+**/
+static size_t   perft_count(PerftShared *shared, ChessBoard *cb, size_t depth) {
+
+    if (!shared->hash) return chessboard_perft(cb, depth);
+
+    PerftHashStats stats = { 0 };
+    size_t nodes = perft_hashed(cb, depth, shared->hash, &stats);
+
+    atomic_fetch_add(&shared->hash->hits, stats.hits);
+    atomic_fetch_add(&shared->hash->misses, stats.misses);
+    atomic_fetch_add(&shared->hash->overwrites, stats.overwrites);
+    return nodes;
+}
+
+/**
+ * Count a subtree, splitting it into child tasks when workers are idle.
+ *
+ * @param   arg     Pointer to PerftTask structure (freed on completion).
+**/
+static void     perft_task(void *arg) {
+
+    PerftTask *task = (PerftTask *) arg;
+    PerftShared *shared = task->shared;
+    ChessBoard *cb = &task->board;
+
+    if (task->depth >= PERFT_SPLIT_DEPTH && threadpool_idle(shared->pool)) {
+        ChessMove moves[MAX_MOVES];
+        size_t moves_count = chessboard_legal_moves(cb, moves);
+
+        ChessUndo undo;
+        for (size_t i = 0; i < moves_count; i++) {
+            chessboard_make_move_with(cb, moves[i], &undo);
+
+            PerftTask *child = (PerftTask *) malloc(sizeof(PerftTask));
+            if (child) {
+                *child = *task;
+                child->depth = task->depth - 1;
+                if (!threadpool_submit(shared->pool, perft_task, child)) {
+                    free(child);
+                    child = NULL;
+                }
+            }
+            if (!child) atomic_fetch_add(&shared->nodes[task->root], perft_count(shared, cb, task->depth - 1));
+
+            chessboard_unmake_move_with(cb, moves[i], &undo);
+        }
+    } else {
+        atomic_fetch_add(&shared->nodes[task->root], perft_count(shared, cb, task->depth));
+    }
+
+    free(task);
+}
+
+/**
+ * Read the monotonic clock.
+ *
+ * @return  Seconds since an arbitrary fixed point.
+**/
+static double   perft_clock() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+/* External Functions */
+
+/**
+ * Create a PerftHash structure shared by all perft workers.
+ *
+ * @param   megabytes   Table size in MB (rounded down to a power-of-two entry count).
+ *
+ * @return  Pointer to new PerftHash structure, or NULL if error.
+**/
+PerftHash *     perft_hash_create(size_t megabytes) {
+
+    size_t entries = (megabytes << 20) / sizeof(PerftHashEntry);
+    if (!entries) return NULL;
+    while (entries & (entries - 1)) entries &= entries - 1;
+
+    PerftHash *hash = (PerftHash *) calloc(1, sizeof(PerftHash));
+    if (hash) {
+        hash->entries = (PerftHashEntry *) calloc(entries, sizeof(PerftHashEntry));
+        if (!hash->entries) {
+            free(hash);
+            return NULL;
+        }
+        hash->mask = entries - 1;
+    }
+
+    return hash;
+}
+
+/**
+ * Deallocate PerftHash structure.
+ *
+ * @param   hash    Pointer to PerftHash structure.
+**/
+void            perft_hash_delete(PerftHash *hash) {
+    if (!hash) return;
+    free(hash->entries);
+    free(hash);
+}
+
+/**
+ * Count the leaf nodes of the legal move tree across a work-stealing pool.
+ *
+ * Every legal root move becomes one task; a worker that finds other workers
+ * idle splits its subtree into child tasks for them to steal. Each task owns
+ * its own ChessBoard copy.
+ *
+ * @param   cb          Pointer to ChessBoard structure (unchanged on return).
+ * @param   depth       Number of plies to search.
+ * @param   threads     Number of worker threads (0 for one per online CPU).
+ * @param   hash        Pointer to PerftHash structure shared by all workers (or NULL).
+ * @param   result      Pointer to PerftResult structure to populate.
+ *
+ * @return  `true` if successful, `false` otherwise.
+**/
+bool            perft_run(ChessBoard *cb, size_t depth, size_t threads, PerftHash *hash, PerftResult *result) {
+
+    double start = perft_clock();
+    memset(result, 0, sizeof(PerftResult));
+
+    PerftShared *shared = (PerftShared *) calloc(1, sizeof(PerftShared));
+    if (!shared) return false;
+
+    shared->hash = hash;
+    shared->pool = threadpool_create(threads);
+    if (!shared->pool) {
+        free(shared);
+        return false;
+    }
+
+    bool success = true;
+    if (depth == 0) {
+        result->nodes = 1;
+    } else {
+        ChessMove moves[MAX_MOVES];
+        size_t moves_count = chessboard_legal_moves(cb, moves);
+
+        ChessUndo undo;
+        for (size_t i = 0; i < moves_count; i++) {
+            chessboard_make_move_with(cb, moves[i], &undo);
+
+            size_t root = result->moves_count++;
+            result->divide[root].move = moves[i];
+
+            PerftTask *task = (PerftTask *) malloc(sizeof(PerftTask));
+            if (task) {
+                task->shared = shared;
+                task->root = root;
+                task->depth = depth - 1;
+                task->board = *cb;
+                if (!threadpool_submit(shared->pool, perft_task, task)) {
+                    free(task);
+                    task = NULL;
+                }
+            }
+            success = success && task;
+
+            chessboard_unmake_move_with(cb, moves[i], &undo);
+        }
+
+        threadpool_wait(shared->pool);
+
+        for (size_t i = 0; i < result->moves_count; i++) {
+            result->divide[i].nodes = atomic_load(&shared->nodes[i]);
+            result->nodes += result->divide[i].nodes;
+        }
+    }
+
+    result->steals = atomic_load(&shared->pool->steals);
+    threadpool_delete(shared->pool);
+    free(shared);
+
+    result->seconds = perft_clock() - start;
+    result->nps = (result->seconds > 0) ? result->nodes / result->seconds : 0;
+    return success;
+}
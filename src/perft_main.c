@@ -0,0 +1,170 @@
+/* libchess
+ * Jack O'Connor 2025
+ * src/perft_main.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "chessboard.h"
+#include "perft.h"
+#include "position.h"
+
+
+/* Functions */
+
+void    usage(const char *program, int status) {
+    fprintf(stderr, "Usage: %s [options] DEPTH [FEN]\n", program);
+    fprintf(stderr, "    -t THREADS  Worker threads (default: one per CPU)\n");
+    fprintf(stderr, "    -H MB       Shared transposition cache size (default: off)\n");
+    fprintf(stderr, "    -q          Omit per-move divide counts\n");
+    fprintf(stderr, "    -c          Serial copy-make perft on the compact Position\n");
+    exit(status);
+}
+
+
+/**
+ * Run a serial copy-make perft on the compact Position representation.
+ *
+ * @param   cb      Pointer to ChessBoard structure to start from.
+ * @param   depth   Number of plies to search.
+ * @param   divide  Whether to print per-move counts.
+ *
+ * @return  EXIT_SUCCESS.
+**/
+int     perft_copy_make(ChessBoard *cb, size_t depth, bool divide) {
+
+    Position pos;
+    position_from_chessboard(&pos, cb);
+
+    struct timespec start, stop;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    size_t nodes = 0;
+    if (depth == 0) {
+        nodes = 1;
+    } else {
+        ChessMove moves[MAX_MOVES];
+        size_t moves_count = position_legal_moves(&pos, moves);
+        for (size_t i = 0; i < moves_count; i++) {
+            Position child = pos;
+            position_make_move(&child, moves[i]);
+            size_t move_nodes = position_perft(&child, depth - 1);
+            nodes += move_nodes;
+
+            if (divide) {
+                char move[6];
+                chessmove_to_string(moves[i], move);
+                fprintf(stdout, "%s: %lu\n", move, move_nodes);
+            }
+        }
+        if (divide) fprintf(stdout, "\n");
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    double seconds = (stop.tv_sec - start.tv_sec) + (stop.tv_nsec - start.tv_nsec) / 1e9;
+
+    fprintf(stdout, "Nodes:  %lu\n", nodes);
+    fprintf(stdout, "Time:   %.3fs\n", seconds);
+    fprintf(stdout, "NPS:    %.0f\n", (seconds > 0) ? nodes / seconds : 0);
+    fprintf(stdout, "Size:   %lu bytes per position (ChessBoard %lu)\n", sizeof(Position), sizeof(ChessBoard));
+    return EXIT_SUCCESS;
+}
+
+
+/* Main Execution */
+
+int main(int argc, char *argv[]) {
+
+    size_t threads = 0;
+    size_t hash_mb = 0;
+    bool divide = true;
+    bool copy_make = false;
+
+    int option;
+    while ((option = getopt(argc, argv, "t:H:qch")) != -1) {
+        switch (option) {
+            case 't':
+                threads = strtoul(optarg, NULL, 10);
+                break;
+            case 'H':
+                hash_mb = strtoul(optarg, NULL, 10);
+                break;
+            case 'q':
+                divide = false;
+                break;
+            case 'c':
+                copy_make = true;
+                break;
+            case 'h':
+                usage(argv[0], EXIT_SUCCESS);
+                break;
+            default:
+                usage(argv[0], EXIT_FAILURE);
+        }
+    }
+
+    if (optind >= argc) usage(argv[0], EXIT_FAILURE);
+    size_t depth = strtoul(argv[optind++], NULL, 10);
+    const char *fen = (optind < argc) ? argv[optind] : NULL;
+
+    ChessBoard *cb = chessboard_create(fen);
+    if (!cb) {
+        fprintf(stderr, "Unable to create board\n");
+        return EXIT_FAILURE;
+    }
+
+    if (copy_make) {
+        int status = perft_copy_make(cb, depth, divide);
+        chessboard_delete(cb);
+        return status;
+    }
+
+    PerftHash *hash = NULL;
+    if (hash_mb && !(hash = perft_hash_create(hash_mb))) {
+        fprintf(stderr, "Unable to allocate %lu MB hash\n", hash_mb);
+        chessboard_delete(cb);
+        return EXIT_FAILURE;
+    }
+
+    PerftResult *result = (PerftResult *) malloc(sizeof(PerftResult));
+    if (!result || !perft_run(cb, depth, threads, hash, result)) {
+        fprintf(stderr, "perft failed\n");
+        free(result);
+        perft_hash_delete(hash);
+        chessboard_delete(cb);
+        return EXIT_FAILURE;
+    }
+
+    if (divide) {
+        for (size_t i = 0; i < result->moves_count; i++) {
+            char move[6];
+            chessmove_to_string(result->divide[i].move, move);
+            fprintf(stdout, "%s: %lu\n", move, result->divide[i].nodes);
+        }
+        fprintf(stdout, "\n");
+    }
+
+    fprintf(stdout, "Nodes:  %lu\n", result->nodes);
+    fprintf(stdout, "Time:   %.3fs\n", result->seconds);
+    fprintf(stdout, "NPS:    %.0f\n", result->nps);
+    fprintf(stdout, "Steals: %lu\n", result->steals);
+
+    if (hash) {
+        size_t hits = atomic_load(&hash->hits);
+        size_t misses = atomic_load(&hash->misses);
+        fprintf(stdout, "Hash:   %lu MB, %lu entries\n", hash_mb, hash->mask + 1);
+        fprintf(stdout, "        %lu hits, %lu misses, %lu overwrites (%.1f%% hit rate)\n",
+                hits, misses, atomic_load(&hash->overwrites),
+                (hits + misses) ? 100.0 * hits / (hits + misses) : 0.0);
+    }
+
+    free(result);
+    perft_hash_delete(hash);
+    chessboard_delete(cb);
+
+    return EXIT_SUCCESS;
+}
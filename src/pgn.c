@@ -0,0 +1,421 @@
+/* libchess
+ * Jack O'Connor 2025
+ * src/pgn.c
+ */
+
+#include <ctype.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "pgn.h"
+
+
+/* Macro Functions */
+
+#define pgn_is_symbol(c)    (isalnum((unsigned char)(c)) || strchr("+#=:-_/!?", (c)))
+
+
+/* Internal Functions */
+
+/**
+ * Split a tag token into its name and value.
+ *
+ * @param   token   Pointer to PGN_TOKEN_TAG token.
+ * @param   tag     Pointer to PgnTag structure to populate.
+**/
+static void     pgn_parse_tag(const PgnToken *token, PgnTag *tag) {
+
+    const char *p = token->text.ptr + 1;
+    const char *end = token->text.ptr + token->text.length - 1;
+
+    while (p < end && isspace((unsigned char)*p)) p++;
+    tag->name.ptr = p;
+    while (p < end && !isspace((unsigned char)*p) && *p != '"') p++;
+    tag->name.length = p - tag->name.ptr;
+
+    // Value runs from the first quote to the last one
+    const char *open = memchr(p, '"', end - p);
+    const char *close = end;
+    while (close > p && *close != '"') close--;
+    if (open && close > open) {
+        tag->value.ptr = open + 1;
+        tag->value.length = close - open - 1;
+    } else {
+        tag->value.ptr = p;
+        tag->value.length = 0;
+    }
+}
+
+
+/**
+ * Check for the tags a game needs to be replayed from a custom position.
+ *
+ * @param   tag     Pointer to PgnTag structure.
+ *
+ * @return  `true` if the tag is FEN or SetUp, `false` otherwise.
+**/
+static bool     pgn_tag_is_setup(const PgnTag *tag) {
+
+    return (tag->name.length == 3 && !memcmp(tag->name.ptr, "FEN", 3)) ||
+           (tag->name.length == 5 && !memcmp(tag->name.ptr, "SetUp", 5));
+}
+
+
+/* External Functions */
+
+/**
+ * Open a PGN file for streaming by mapping it read-only.
+ *
+ * @param   path    Path of the PGN file.
+ *
+ * @return  Pointer to new PgnReader structure, or NULL if error.
+**/
+PgnReader *     pgn_open(const char *path) {
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) || !S_ISREG(st.st_mode)) {
+        close(fd);
+        return NULL;
+    }
+
+    PgnReader *reader = (PgnReader *) calloc(1, sizeof(PgnReader));
+    if (!reader) {
+        close(fd);
+        return NULL;
+    }
+    reader->fd = fd;
+    reader->size = st.st_size;
+
+    if (reader->size) {
+        void *data = mmap(NULL, reader->size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            close(fd);
+            free(reader);
+            return NULL;
+        }
+        madvise(data, reader->size, MADV_SEQUENTIAL);
+        reader->data = data;
+    }
+
+    return reader;
+}
+
+/**
+ * Stream PGN text already in memory. The buffer must outlive the reader.
+ *
+ * @param   data    PGN text (need not be NUL-terminated).
+ * @param   size    Length of data in bytes.
+ *
+ * @return  Pointer to new PgnReader structure, or NULL if error.
+**/
+PgnReader *     pgn_open_memory(const char *data, size_t size) {
+
+    PgnReader *reader = (PgnReader *) calloc(1, sizeof(PgnReader));
+    if (!reader) return NULL;
+
+    reader->fd = -1;
+    reader->data = data;
+    reader->size = size;
+    return reader;
+}
+
+/**
+ * Unmap the file (if any) and deallocate PgnReader structure.
+ *
+ * @param   reader  Pointer to PgnReader structure.
+**/
+void            pgn_close(PgnReader *reader) {
+
+    if (!reader) return;
+    if (reader->fd >= 0) {
+        if (reader->size) munmap((void *) reader->data, reader->size);
+        close(reader->fd);
+    }
+    free(reader);
+}
+
+/**
+ * Return the pages before an offset to the kernel so a long file does not
+ * stay resident. The mapping is read-only, so a page touched again is simply
+ * read back from the file.
+ *
+ * @param   reader  Pointer to PgnReader structure.
+ * @param   offset  Bytes before this offset are no longer needed.
+**/
+void            pgn_release(PgnReader *reader, size_t offset) {
+
+    if (reader->fd < 0) return;
+    while (offset - reader->released >= PGN_RELEASE_SIZE) {
+        madvise((char *) reader->data + reader->released, PGN_RELEASE_SIZE, MADV_DONTNEED);
+        reader->released += PGN_RELEASE_SIZE;
+    }
+}
+
+/**
+ * Read the next token of PGN text without copying it.
+ *
+ * @param   cursor  Pointer to read position, advanced past the token.
+ * @param   end     End of the text.
+ * @param   token   Pointer to PgnToken structure to populate.
+ *
+ * @return  `true` if a token was read, `false` at the end of the text.
+**/
+bool            pgn_next_token(const char **cursor, const char *end, PgnToken *token) {
+
+    const char *p = *cursor;
+    while (p < end && isspace((unsigned char)*p)) p++;
+    if (p >= end) {
+        *cursor = p;
+        return false;
+    }
+
+    const char *start = p;
+    int type = PGN_TOKEN_NONE;
+    switch (*p) {
+        case '[': {
+            // Brackets inside the quoted value do not end the tag
+            bool quoted = false;
+            for (p++; p < end && (quoted || *p != ']'); p++) {
+                if (*p == '\\' && quoted && p + 1 < end) p++;
+                else if (*p == '"') quoted = !quoted;
+            }
+            if (p < end) p++;
+            type = PGN_TOKEN_TAG;
+            break;
+        }
+        case '{':
+            p = memchr(p, '}', end - p);
+            p = (p) ? p + 1 : end;
+            type = PGN_TOKEN_COMMENT;
+            break;
+        case ';':
+        case '%':
+            p = memchr(p, '\n', end - p);
+            if (!p) p = end;
+            type = PGN_TOKEN_COMMENT;
+            break;
+        case '(':
+            p++;
+            type = PGN_TOKEN_VARIATION_START;
+            break;
+        case ')':
+            p++;
+            type = PGN_TOKEN_VARIATION_END;
+            break;
+        case '*':
+            p++;
+            type = PGN_TOKEN_RESULT;
+            break;
+        case '$':
+            for (p++; p < end && isdigit((unsigned char)*p); p++);
+            type = PGN_TOKEN_NAG;
+            break;
+        case '!':
+        case '?':
+            while (p < end && (*p == '!' || *p == '?')) p++;
+            type = PGN_TOKEN_NAG;
+            break;
+        case '.':
+            while (p < end && *p == '.') p++;
+            type = PGN_TOKEN_NUMBER;
+            break;
+        default:
+            if (isdigit((unsigned char)*p)) {
+                if (end - p >= 7 && !memcmp(p, "1/2-1/2", 7)) {
+                    p += 7;
+                    type = PGN_TOKEN_RESULT;
+                    break;
+                }
+                if (end - p >= 3 && (!memcmp(p, "1-0", 3) || !memcmp(p, "0-1", 3))) {
+                    p += 3;
+                    type = PGN_TOKEN_RESULT;
+                    break;
+                }
+
+                // "12." or "12..." (a bare number too), but "0-0" is castling
+                const char *q = p;
+                while (q < end && isdigit((unsigned char)*q)) q++;
+                if (q == end || *q == '.' || isspace((unsigned char)*q)) {
+                    for (p = q; p < end && *p == '.'; p++);
+                    type = PGN_TOKEN_NUMBER;
+                    break;
+                }
+            }
+
+            while (p < end && pgn_is_symbol(*p)) p++;
+            if (p == start) p++;
+            type = (p - start > 1 || isalpha((unsigned char)*start)) ? PGN_TOKEN_MOVE : PGN_TOKEN_NONE;
+    }
+
+    token->type = type;
+    token->text.ptr = start;
+    token->text.length = p - start;
+    *cursor = p;
+    return true;
+}
+
+/**
+ * Yield the next game. Spans in the game point into the reader's input and
+ * stay valid until the following call.
+ *
+ * A game ends at its termination marker outside any variation, or where the
+ * tags of the next game begin when the marker is missing. Tags beyond
+ * PGN_MAX_TAGS are skipped, except FEN and SetUp, which replace earlier tags.
+ *
+ * @param   reader  Pointer to PgnReader structure.
+ * @param   game    Pointer to PgnGame structure to populate.
+ *
+ * @return  `true` if a game was read, `false` at the end of the input.
+**/
+bool            pgn_next_game(PgnReader *reader, PgnGame *game) {
+
+    pgn_release(reader, reader->cursor);
+
+    const char *p = reader->data + reader->cursor;
+    const char *end = reader->data + reader->size;
+
+    game->tags_count = 0;
+    game->movetext = (PgnSpan){ NULL, 0 };
+    game->result = (PgnSpan){ NULL, 0 };
+
+    const char *start = NULL, *last = NULL;
+    size_t depth = 0;
+    PgnToken token;
+    while (true) {
+        const char *before = p;
+        if (!pgn_next_token(&p, end, &token)) break;
+
+        // Escape lines and comments ahead of the first tag or move are not a game
+        if (!start && token.type == PGN_TOKEN_COMMENT) continue;
+        if (!start) start = token.text.ptr;
+
+        if (token.type == PGN_TOKEN_TAG) {
+            if (game->movetext.ptr) {
+                p = before;
+                break;
+            }
+            if (game->tags_count < PGN_MAX_TAGS) {
+                pgn_parse_tag(&token, &game->tags[game->tags_count++]);
+            } else {
+                // FEN and SetUp take the place of the last other tag: the moves only replay from there
+                PgnTag tag;
+                pgn_parse_tag(&token, &tag);
+                size_t i = PGN_MAX_TAGS;
+                while (i && pgn_tag_is_setup(&game->tags[i - 1])) i--;
+                if (i && pgn_tag_is_setup(&tag)) game->tags[i - 1] = tag;
+            }
+            last = p;
+            continue;
+        }
+
+        if (!game->movetext.ptr) game->movetext.ptr = token.text.ptr;
+        if (token.type == PGN_TOKEN_VARIATION_START) {
+            depth++;
+        } else if (token.type == PGN_TOKEN_VARIATION_END) {
+            if (depth) depth--;
+        } else if (token.type == PGN_TOKEN_RESULT && !depth) {
+            game->result = token.text;
+            break;
+        }
+        last = p;
+    }
+
+    reader->cursor = p - reader->data;
+    if (!start) return false;
+
+    if (game->movetext.ptr) {
+        const char *movetext_end = (game->result.ptr) ? game->result.ptr : last;
+        game->movetext.length = (movetext_end > game->movetext.ptr) ? movetext_end - game->movetext.ptr : 0;
+    } else {
+        game->movetext = (PgnSpan){ last, 0 };
+    }
+
+    game->index = reader->games++;
+    game->offset = start - reader->data;
+    game->text.ptr = start;
+    game->text.length = ((game->result.ptr) ? p : last) - start;
+    return true;
+}
+
+/**
+ * Look up a tag of a game by name.
+ *
+ * @param   game    Pointer to PgnGame structure.
+ * @param   name    Tag name, e.g. "White".
+ * @param   value   Pointer to PgnSpan to populate with the value.
+ *
+ * @return  `true` if the tag is present, `false` otherwise.
+**/
+bool            pgn_game_tag(const PgnGame *game, const char *name, PgnSpan *value) {
+
+    size_t length = strlen(name);
+    for (size_t i = 0; i < game->tags_count; i++) {
+        if (game->tags[i].name.length == length && !memcmp(game->tags[i].name.ptr, name, length)) {
+            *value = game->tags[i].value;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Replay the main line of a game, checking that every move is legal.
+ * Comments, NAGs and variations are skipped.
+ *
+ * @param   game        Pointer to PgnGame structure.
+ * @param   cb          Pointer to ChessBoard structure, reset to the starting
+ *                      position (the FEN tag, if any) and left at the last legal move.
+ * @param   moves       Array to store the moves in (or NULL).
+ * @param   capacity    Length of moves; later moves are replayed but not stored.
+ * @param   plies       Pointer to count of moves replayed.
+ *
+ * @return  `true` if the whole main line is legal, `false` otherwise.
+**/
+bool            pgn_replay(const PgnGame *game, ChessBoard *cb, ChessMove *moves, size_t capacity, size_t *plies) {
+
+    *plies = 0;
+
+    char fen[CHESSBOARD_FEN_SIZE];
+    PgnSpan value;
+    bool setup = pgn_game_tag(game, "FEN", &value);
+    if (setup) {
+        if (value.length >= sizeof(fen)) return false;
+        memcpy(fen, value.ptr, value.length);
+        fen[value.length] = '\0';
+    }
+
+    if (!chessboard_init(cb, (setup) ? fen : NULL)) return false;
+
+    const char *p = game->movetext.ptr;
+    const char *end = p + game->movetext.length;
+    size_t depth = 0;
+    PgnToken token;
+    while (pgn_next_token(&p, end, &token)) {
+        if (token.type == PGN_TOKEN_VARIATION_START) depth++;
+        if (token.type == PGN_TOKEN_VARIATION_END && depth) depth--;
+        if (token.type != PGN_TOKEN_MOVE || depth) continue;
+
+        // The token is not terminated in the input
+        char san[PGN_MAX_SAN];
+        if (token.text.length >= sizeof(san)) return false;
+        memcpy(san, token.text.ptr, token.text.length);
+        san[token.text.length] = '\0';
+
+        ChessMove move;
+        if (!chessboard_move_from_san(cb, san, &move)) return false;
+        chessboard_make_move(cb, move);
+        if (moves && *plies < capacity) moves[*plies] = move;
+        (*plies)++;
+    }
+
+    return true;
+}
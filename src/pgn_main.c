@@ -0,0 +1,203 @@
+/* libchess
+ * Jack O'Connor 2025
+ * src/pgn_main.c
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "chessboard.h"
+#include "pgn.h"
+#include "pgn_pipeline.h"
+
+
+/* Types */
+
+typedef struct {
+    const char *path;                   // File being read
+    bool        verbose;
+    bool        quiet;
+} PgnMain;
+
+
+/* Functions */
+
+void    usage(const char *program, int status) {
+    fprintf(stderr, "Usage: %s [options] FILE...\n", program);
+    fprintf(stderr, "    -j WORKERS  Replay on a pipeline with this many workers (0 for one per CPU)\n");
+    fprintf(stderr, "    -c KB       Pipeline chunk size (default: %d)\n", PGN_CHUNK_SIZE >> 10);
+    fprintf(stderr, "    -v          Print one line per game\n");
+    fprintf(stderr, "    -q          Do not report illegal games\n");
+    exit(status);
+}
+
+double  now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * Append a tag value of a game, or "?" if the tag is missing.
+ *
+ * @param   out     Pointer to PgnOutput structure.
+ * @param   game    Pointer to PgnGame structure.
+ * @param   name    Tag name.
+**/
+void    format_tag(PgnOutput *out, const PgnGame *game, const char *name) {
+    PgnSpan value;
+    if (pgn_game_tag(game, name, &value) && value.length) pgn_output_append(out, value.ptr, value.length);
+    else pgn_output_append(out, "?", 1);
+}
+
+/**
+ * Game callback: describe a game for -v (runs on a worker in pipeline mode).
+ *
+ * @param   replay  Pointer to PgnReplay structure.
+ * @param   out     Pointer to PgnOutput structure to append to.
+ * @param   arg     Pointer to PgnMain structure.
+**/
+void    format_game(const PgnReplay *replay, PgnOutput *out, void *arg) {
+
+    format_tag(out, replay->game, "White");
+    pgn_output_append(out, " - ", 3);
+    format_tag(out, replay->game, "Black");
+    pgn_output_printf(out, " %.*s (%lu plies%s)", (int) replay->game->result.length, replay->game->result.ptr,
+                      replay->plies, (replay->legal) ? "" : ", illegal");
+}
+
+/**
+ * Write callback: report a game in input order.
+ *
+ * @param   record  Pointer to PgnRecord structure.
+ * @param   arg     Pointer to PgnMain structure.
+**/
+void    write_game(const PgnRecord *record, void *arg) {
+
+    PgnMain *state = (PgnMain *) arg;
+    if (!record->legal && !state->quiet) {
+        fprintf(stderr, "%s: game %lu (byte %lu): illegal move at ply %lu\n",
+                state->path, record->index + 1, record->offset, record->plies + 1);
+    }
+    if (state->verbose) fprintf(stdout, "%8lu %.*s\n", record->index + 1, (int) record->length, record->data);
+}
+
+
+/* Main Execution */
+
+int main(int argc, char *argv[]) {
+
+    PgnMain state = { 0 };
+    PgnPipelineOptions options = { .chunk_size = PGN_CHUNK_SIZE, .write = write_game, .arg = &state };
+    bool pipeline = false;
+
+    int option;
+    while ((option = getopt(argc, argv, "j:c:vqh")) != -1) {
+        switch (option) {
+            case 'j':
+                pipeline = true;
+                options.workers = strtoul(optarg, NULL, 10);
+                break;
+            case 'c':
+                options.chunk_size = strtoul(optarg, NULL, 10) << 10;
+                break;
+            case 'v':
+                state.verbose = true;
+                options.game = format_game;
+                break;
+            case 'q':
+                state.quiet = true;
+                break;
+            case 'h':
+                usage(argv[0], EXIT_SUCCESS);
+                break;
+            default:
+                usage(argv[0], EXIT_FAILURE);
+        }
+    }
+    if (optind >= argc) usage(argv[0], EXIT_FAILURE);
+
+    ChessBoard *cb = chessboard_create(NULL);
+    if (!cb) {
+        fprintf(stderr, "Unable to create board\n");
+        return EXIT_FAILURE;
+    }
+
+    PgnPipelineStats total = { 0 };
+    PgnOutput out = { 0 };
+    ChessMove moves[PGN_MAX_PLIES];
+    double start = now();
+    for (int a = optind; a < argc; a++) {
+        state.path = argv[a];
+        PgnReader *reader = pgn_open(argv[a]);
+        if (!reader) {
+            fprintf(stderr, "Unable to open %s\n", argv[a]);
+            chessboard_delete(cb);
+            return EXIT_FAILURE;
+        }
+
+        if (pipeline) {
+            PgnPipelineStats stats;
+            if (!pgn_pipeline_run(reader, &options, &stats)) {
+                fprintf(stderr, "Pipeline failed on %s\n", argv[a]);
+                pgn_close(reader);
+                chessboard_delete(cb);
+                return EXIT_FAILURE;
+            }
+
+            fprintf(stdout, "%s: %lu chunks over %lu workers\n", argv[a], stats.chunks, stats.workers);
+            fprintf(stdout, "    %-8s %9s %9s %10s %10s\n", "Stage", "Busy", "Wait", "Queue max", "Queue mean");
+            fprintf(stdout, "    %-8s %8.3fs %8.3fs %10lu %10.2f\n", "reader",
+                    stats.reader_busy, stats.reader_wait, stats.work_depth_max, stats.work_depth_mean);
+            fprintf(stdout, "    %-8s %8.3fs %8.3fs %10lu %10.2f\n", "workers",
+                    stats.worker_busy, stats.worker_idle, stats.done_depth_max, stats.done_depth_mean);
+            fprintf(stdout, "    %-8s %8.3fs %8.3fs %10lu %10s\n", "writer",
+                    stats.writer_busy, stats.writer_wait, stats.reorder_max, "(held)");
+
+            total.games += stats.games;
+            total.illegal += stats.illegal;
+            total.plies += stats.plies;
+        } else {
+            PgnGame game;
+            while (pgn_next_game(reader, &game)) {
+                PgnReplay replay = { .game = &game, .board = cb, .moves = moves };
+                replay.legal = pgn_replay(&game, cb, moves, PGN_MAX_PLIES, &replay.plies);
+
+                out.length = 0;
+                if (options.game) options.game(&replay, &out, &state);
+
+                PgnRecord record = {
+                    .index  = game.index,
+                    .offset = game.offset,
+                    .plies  = replay.plies,
+                    .legal  = replay.legal,
+                    .data   = out.data,
+                    .length = out.length,
+                };
+                write_game(&record, &state);
+
+                total.games++;
+                total.plies += replay.plies;
+                if (!replay.legal) total.illegal++;
+            }
+        }
+
+        total.bytes += reader->size;
+        pgn_close(reader);
+    }
+    double seconds = now() - start;
+
+    fprintf(stdout, "Games:  %lu (%lu illegal)\n", total.games, total.illegal);
+    fprintf(stdout, "Plies:  %lu\n", total.plies);
+    fprintf(stdout, "Size:   %.1f MB\n", total.bytes / 1e6);
+    fprintf(stdout, "Time:   %.3fs\n", seconds);
+    fprintf(stdout, "Rate:   %.0f games/s, %.1f MB/s\n", total.games / seconds, total.bytes / 1e6 / seconds);
+
+    free(out.data);
+    chessboard_delete(cb);
+    return (total.illegal) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
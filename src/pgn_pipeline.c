@@ -0,0 +1,458 @@
+/* libchess
+ * Jack O'Connor 2025
+ * src/pgn_pipeline.c
+ */
+
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "pgn_pipeline.h"
+
+
+/* Types */
+
+typedef struct { // Bounded blocking FIFO of pointers
+    pthread_mutex_t lock;
+    pthread_cond_t  not_empty;
+    pthread_cond_t  not_full;
+
+    void          **items;
+    size_t          capacity;
+    size_t          head;
+    size_t          count;
+
+    size_t          pushes;
+    size_t          depth_sum;          // Depth after every push, for the mean
+    size_t          depth_max;
+} PgnQueue;
+
+typedef struct PgnPipeline PgnPipeline;
+
+typedef struct {
+    PgnPipeline    *pipeline;
+    size_t          sequence;           // Chunk number in input order
+    size_t          offset;
+    size_t          size;
+
+    PgnOutput       out;
+    PgnRecord      *records;            // data is filled in by the writer
+    size_t          records_count;
+    size_t          records_capacity;
+
+    ChessBoard      board;              // Owned by whichever worker runs the chunk
+    ChessMove       moves[PGN_MAX_PLIES];
+} PgnChunk;
+
+struct PgnPipeline {
+    PgnReader          *reader;
+    PgnPipelineOptions  options;
+    pthread_t          *threads;
+    size_t              workers;
+
+    PgnQueue            free;           // Chunks ready to be filled by the reader
+    PgnQueue            work;           // Filled chunks for the workers (NULL stops one worker)
+    PgnQueue            done;           // Replayed chunks for the writer (NULL ends the input)
+
+    size_t              chunks;         // Chunks produced, valid once NULL reaches done
+    double              reader_busy;
+    double              reader_wait;
+    atomic_size_t       worker_busy;    // Nanoseconds, summed over workers
+    atomic_bool         failed;
+};
+
+
+/* Internal Functions */
+
+static double   pipeline_clock() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static bool     queue_init(PgnQueue *q, size_t capacity) {
+
+    memset(q, 0, sizeof(PgnQueue));
+    q->items = (void **) calloc(capacity, sizeof(void *));
+    if (!q->items) return false;
+
+    q->capacity = capacity;
+    pthread_mutex_init(&q->lock, NULL);
+    pthread_cond_init(&q->not_empty, NULL);
+    pthread_cond_init(&q->not_full, NULL);
+    return true;
+}
+
+static void     queue_destroy(PgnQueue *q) {
+    if (!q->items) return;
+    pthread_mutex_destroy(&q->lock);
+    pthread_cond_destroy(&q->not_empty);
+    pthread_cond_destroy(&q->not_full);
+    free(q->items);
+}
+
+/**
+ * Append an item, blocking while the queue is full.
+ *
+ * @param   q       Pointer to PgnQueue structure.
+ * @param   item    Item to append.
+**/
+static void     queue_push(PgnQueue *q, void *item) {
+
+    pthread_mutex_lock(&q->lock);
+    while (q->count == q->capacity) pthread_cond_wait(&q->not_full, &q->lock);
+
+    q->items[(q->head + q->count) % q->capacity] = item;
+    q->count++;
+    q->pushes++;
+    q->depth_sum += q->count;
+    if (q->count > q->depth_max) q->depth_max = q->count;
+
+    pthread_cond_signal(&q->not_empty);
+    pthread_mutex_unlock(&q->lock);
+}
+
+/**
+ * Remove the oldest item, blocking while the queue is empty.
+ *
+ * @param   q       Pointer to PgnQueue structure.
+ * @param   wait    Pointer to seconds spent blocked, incremented.
+ *
+ * @return  The item.
+**/
+static void *   queue_pop(PgnQueue *q, double *wait) {
+
+    pthread_mutex_lock(&q->lock);
+    if (!q->count) {
+        double start = pipeline_clock();
+        while (!q->count) pthread_cond_wait(&q->not_empty, &q->lock);
+        *wait += pipeline_clock() - start;
+    }
+
+    void *item = q->items[q->head];
+    q->head = (q->head + 1) % q->capacity;
+    q->count--;
+
+    pthread_cond_signal(&q->not_full);
+    pthread_mutex_unlock(&q->lock);
+    return item;
+}
+
+/**
+ * Find where a chunk starting at offset should end: the first game boundary
+ * (a tag at the start of a line, after a blank line) past chunk_size bytes.
+ *
+ * @param   data        Input text.
+ * @param   size        Length of the input.
+ * @param   offset      Start of the chunk.
+ * @param   chunk_size  Minimum chunk length.
+ *
+ * @return  Offset of the end of the chunk.
+**/
+static size_t   pipeline_split(const char *data, size_t size, size_t offset, size_t chunk_size) {
+
+    if (size - offset <= chunk_size) return size;
+
+    const char *first = data + offset;
+    const char *end = data + size;
+    for (const char *p = first + chunk_size; (p = memchr(p, '\n', end - p)); ) {
+        p++;
+        if (p == end || *p != '[') continue;
+
+        const char *q = p - 2;
+        while (q >= first && (*q == ' ' || *q == '\t' || *q == '\r')) q--;
+        if (q < first || *q == '\n') return p - data;
+    }
+
+    return size;
+}
+
+/**
+ * Replay every game of a chunk.
+ *
+ * @param   chunk   Pointer to PgnChunk structure.
+**/
+static void     pipeline_replay_chunk(PgnChunk *chunk) {
+
+    PgnPipeline *pipeline = chunk->pipeline;
+
+    chunk->out.length = 0;
+    chunk->records_count = 0;
+
+    PgnReader reader = {
+        .data   = pipeline->reader->data + chunk->offset,
+        .size   = chunk->size,
+        .fd     = -1,
+    };
+
+    PgnGame game;
+    while (pgn_next_game(&reader, &game)) {
+        if (chunk->records_count == chunk->records_capacity) {
+            size_t capacity = (chunk->records_capacity) ? chunk->records_capacity * 2 : 256;
+            PgnRecord *records = (PgnRecord *) realloc(chunk->records, capacity * sizeof(PgnRecord));
+            if (!records) {
+                atomic_store(&pipeline->failed, true);
+                break;
+            }
+            chunk->records = records;
+            chunk->records_capacity = capacity;
+        }
+
+        PgnReplay replay = { .game = &game, .board = &chunk->board, .moves = chunk->moves };
+        replay.legal = pgn_replay(&game, &chunk->board, chunk->moves, PGN_MAX_PLIES, &replay.plies);
+
+        size_t length = chunk->out.length;
+        if (pipeline->options.game) pipeline->options.game(&replay, &chunk->out, pipeline->options.arg);
+
+        PgnRecord *record = &chunk->records[chunk->records_count++];
+        record->offset = chunk->offset + game.offset;
+        record->plies = replay.plies;
+        record->legal = replay.legal;
+        record->length = chunk->out.length - length;
+    }
+}
+
+/**
+ * Worker thread: replay chunks in the order the reader cut them and hand
+ * them to the writer.
+ *
+ * @param   arg     Pointer to PgnPipeline structure.
+ *
+ * @return  NULL.
+**/
+static void *   pipeline_worker_main(void *arg) {
+
+    PgnPipeline *pipeline = (PgnPipeline *) arg;
+    double wait = 0;
+
+    PgnChunk *chunk;
+    while ((chunk = (PgnChunk *) queue_pop(&pipeline->work, &wait))) {
+        double start = pipeline_clock();
+        pipeline_replay_chunk(chunk);
+        atomic_fetch_add(&pipeline->worker_busy, (size_t)((pipeline_clock() - start) * 1e9));
+        queue_push(&pipeline->done, chunk);
+    }
+
+    return NULL;
+}
+
+/**
+ * Reader thread: cut the input into chunks at game boundaries and queue
+ * them for the workers, waiting whenever every chunk is in flight.
+ *
+ * @param   arg     Pointer to PgnPipeline structure.
+ *
+ * @return  NULL.
+**/
+static void *   pipeline_reader_main(void *arg) {
+
+    PgnPipeline *pipeline = (PgnPipeline *) arg;
+    PgnReader *reader = pipeline->reader;
+
+    size_t offset = reader->cursor;
+    size_t sequence = 0;
+    while (offset < reader->size) {
+        PgnChunk *chunk = (PgnChunk *) queue_pop(&pipeline->free, &pipeline->reader_wait);
+        double start = pipeline_clock();
+
+        size_t end = pipeline_split(reader->data, reader->size, offset, pipeline->options.chunk_size);
+        chunk->sequence = sequence++;
+        chunk->offset = offset;
+        chunk->size = end - offset;
+        offset = end;
+
+        pipeline->reader_busy += pipeline_clock() - start;
+        queue_push(&pipeline->work, chunk);
+    }
+
+    pipeline->chunks = sequence;
+    for (size_t i = 0; i < pipeline->workers; i++) queue_push(&pipeline->work, NULL);
+    queue_push(&pipeline->done, NULL);
+    return NULL;
+}
+
+
+/* External Functions */
+
+/**
+ * Append bytes to an output buffer, growing it as needed.
+ *
+ * @param   out     Pointer to PgnOutput structure.
+ * @param   data    Bytes to append.
+ * @param   length  Number of bytes.
+ *
+ * @return  `true` if successful, `false` if the buffer could not grow.
+**/
+bool            pgn_output_append(PgnOutput *out, const void *data, size_t length) {
+
+    if (out->length + length > out->capacity) {
+        size_t capacity = (out->capacity) ? out->capacity : 4096;
+        while (capacity < out->length + length) capacity *= 2;
+        char *grown = (char *) realloc(out->data, capacity);
+        if (!grown) return false;
+        out->data = grown;
+        out->capacity = capacity;
+    }
+
+    memcpy(out->data + out->length, data, length);
+    out->length += length;
+    return true;
+}
+
+/**
+ * Append formatted text (without a terminating NUL) to an output buffer.
+ *
+ * @param   out     Pointer to PgnOutput structure.
+ * @param   format  printf format string.
+ *
+ * @return  `true` if successful, `false` otherwise.
+**/
+bool            pgn_output_printf(PgnOutput *out, const char *format, ...) {
+
+    char line[BUFSIZ];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+
+    if (length < 0) return false;
+    if ((size_t) length >= sizeof(line)) length = sizeof(line) - 1;
+    return pgn_output_append(out, line, length);
+}
+
+/**
+ * Replay every remaining game of a reader on a three-stage pipeline.
+ *
+ * A reader thread cuts the input into chunks at game boundaries, a pool of
+ * workers replays the games of each chunk, and the calling thread writes the
+ * results in input order. A fixed set of chunks cycles through the stages,
+ * so at most options->chunks are in memory however long the input is.
+ *
+ * Chunks are cut before a tag that starts a line after a blank line, as in
+ * export format PGN.
+ *
+ * @param   reader      Pointer to PgnReader structure, read from its cursor to the end.
+ * @param   options     Pointer to PgnPipelineOptions structure.
+ * @param   stats       Pointer to PgnPipelineStats structure to populate.
+ *
+ * @return  `true` if successful, `false` otherwise.
+**/
+bool            pgn_pipeline_run(PgnReader *reader, const PgnPipelineOptions *options, PgnPipelineStats *stats) {
+
+    double start = pipeline_clock();
+    memset(stats, 0, sizeof(PgnPipelineStats));
+
+    PgnPipeline *pipeline = (PgnPipeline *) calloc(1, sizeof(PgnPipeline));
+    if (!pipeline) return false;
+
+    pipeline->reader = reader;
+    pipeline->options = *options;
+    pipeline->workers = options->workers;
+    if (!pipeline->workers) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        pipeline->workers = (cpus > 0) ? (size_t)cpus : 1;
+    }
+    if (!pipeline->options.chunk_size) pipeline->options.chunk_size = PGN_CHUNK_SIZE;
+    if (!pipeline->options.chunks) pipeline->options.chunks = 2 * pipeline->workers + 2;
+    size_t count = pipeline->options.chunks;
+
+    // Every queue can hold all chunks plus the end markers, so only free blocks
+    PgnChunk *chunks = (PgnChunk *) calloc(count, sizeof(PgnChunk));
+    PgnChunk **pending = (PgnChunk **) calloc(count, sizeof(PgnChunk *));
+    pipeline->threads = (pthread_t *) calloc(pipeline->workers + 1, sizeof(pthread_t));
+    bool success = chunks && pending && pipeline->threads && queue_init(&pipeline->free, count) &&
+                   queue_init(&pipeline->work, count + pipeline->workers) && queue_init(&pipeline->done, count + 1);
+
+    size_t started = 0;
+    if (success) {
+        for (size_t i = 0; i < count; i++) {
+            chunks[i].pipeline = pipeline;
+            queue_push(&pipeline->free, &chunks[i]);
+        }
+        for (; started < pipeline->workers; started++) {
+            if (pthread_create(&pipeline->threads[started], NULL, pipeline_worker_main, pipeline)) break;
+        }
+        success = started == pipeline->workers &&
+                  !pthread_create(&pipeline->threads[pipeline->workers], NULL, pipeline_reader_main, pipeline);
+    }
+
+    if (success) {
+        // Writer: hold chunks that finish early until every earlier one is written
+        size_t next = 0, held = 0;
+        bool reader_done = false;
+        while (!reader_done || next < pipeline->chunks) {
+            PgnChunk *chunk = (PgnChunk *) queue_pop(&pipeline->done, &stats->writer_wait);
+            if (!chunk) {
+                reader_done = true;
+                continue;
+            }
+
+            double busy = pipeline_clock();
+            pending[chunk->sequence % count] = chunk;
+            if (++held > stats->reorder_max) stats->reorder_max = held;
+
+            while ((chunk = pending[next % count]) && chunk->sequence == next) {
+                pending[next % count] = NULL;
+                held--;
+
+                const char *data = chunk->out.data;
+                for (size_t i = 0; i < chunk->records_count; i++) {
+                    PgnRecord *record = &chunk->records[i];
+                    record->index = stats->games++;
+                    record->data = data;
+                    data += record->length;
+
+                    stats->plies += record->plies;
+                    if (!record->legal) stats->illegal++;
+                    if (options->write) options->write(record, options->arg);
+                }
+
+                stats->bytes += chunk->size;
+                stats->chunks++;
+                pgn_release(reader, chunk->offset + chunk->size);
+                next++;
+                queue_push(&pipeline->free, chunk);
+            }
+            stats->writer_busy += pipeline_clock() - busy;
+        }
+
+        pthread_join(pipeline->threads[pipeline->workers], NULL);
+        reader->cursor = reader->size;
+    } else {
+        // Release whichever workers did start
+        for (size_t i = 0; i < started; i++) queue_push(&pipeline->work, NULL);
+    }
+    for (size_t i = 0; i < started; i++) pthread_join(pipeline->threads[i], NULL);
+
+    stats->seconds = pipeline_clock() - start;
+    stats->workers = pipeline->workers;
+    stats->reader_busy = pipeline->reader_busy;
+    stats->reader_wait = pipeline->reader_wait;
+    stats->worker_busy = atomic_load(&pipeline->worker_busy) / 1e9;
+    stats->worker_idle = pipeline->workers * stats->seconds - stats->worker_busy;
+    stats->work_depth_max = pipeline->work.depth_max;
+    stats->work_depth_mean = (pipeline->work.pushes) ? (double) pipeline->work.depth_sum / pipeline->work.pushes : 0;
+    stats->done_depth_max = pipeline->done.depth_max;
+    stats->done_depth_mean = (pipeline->done.pushes) ? (double) pipeline->done.depth_sum / pipeline->done.pushes : 0;
+    success = success && !atomic_load(&pipeline->failed);
+
+    for (size_t i = 0; chunks && i < count; i++) {
+        free(chunks[i].out.data);
+        free(chunks[i].records);
+    }
+    free(chunks);
+    free(pending);
+    free(pipeline->threads);
+    queue_destroy(&pipeline->free);
+    queue_destroy(&pipeline->work);
+    queue_destroy(&pipeline->done);
+    free(pipeline);
+
+    return success;
+}
@@ -0,0 +1,552 @@
+/* libchess
+ * Jack O'Connor 2025
+ * src/position.c
+ */
+
+#include <string.h>
+
+#include "position.h"
+
+#include "magic.h"
+#include "zobrist.h"
+
+
+/* Constants */
+
+static const uint8_t CASTLE_MASK[64] = { // Castle flags kept when a move touches a square
+    [0 ... 63] = 0x0F,
+    [0]  = 0x0F & ~POSITION_CASTLE_W_LONG,
+    [4]  = 0x0F & ~(POSITION_CASTLE_W_LONG | POSITION_CASTLE_W_SHORT),
+    [7]  = 0x0F & ~POSITION_CASTLE_W_SHORT,
+    [56] = 0x0F & ~POSITION_CASTLE_B_LONG,
+    [60] = 0x0F & ~(POSITION_CASTLE_B_LONG | POSITION_CASTLE_B_SHORT),
+    [63] = 0x0F & ~POSITION_CASTLE_B_SHORT,
+};
+
+_Static_assert(sizeof(Position) <= 128, "Position should fit in two cache lines");
+
+
+/* Internal Functions */
+
+/**
+ * Find the type of the piece on a square.
+ *
+ * @param   pos     Pointer to Position structure.
+ * @param   bb      Bitboard of the square (must be occupied).
+ *
+ * @return  Piece type (PAWN to KING).
+**/
+static inline ChessPiece    type_at(const Position *pos, Bitboard bb) {
+
+    ChessPiece type = PAWN;
+    while (!(pos->pieces[type - 1] & bb)) type++;
+    return type;
+}
+
+/**
+ * Flip one piece on or off, keeping the key in sync.
+ *
+ * @param   pos     Pointer to Position structure.
+ * @param   square  Square (0-63).
+ * @param   type    Piece type (PAWN to KING).
+ * @param   color   WHITE or BLACK.
+**/
+static inline void  toggle_piece(Position *pos, uint8_t square, ChessPiece type, ChessPiece color) {
+
+    Bitboard bb = 1lu << square;
+    pos->pieces[type - 1] ^= bb;
+    pos->colors[COLOR_ARR_INDEX(color)] ^= bb;
+    pos->key ^= ZOBRIST_PIECES[BB_IDX_PIECE(type | color)][square];
+}
+
+/**
+ * Key of the castle flags and en passant file (XORed out before a move and
+ * back in after it).
+ *
+ * @param   pos     Pointer to Position structure.
+ *
+ * @return  Zobrist key of the irreversible state.
+**/
+static inline uint64_t  state_key(const Position *pos) {
+
+    uint64_t key = ZOBRIST_CASTLE[pos->castle];
+    if (pos->enpassant_target != -1) key ^= ZOBRIST_ENPASSANT[pos->enpassant_target % 8];
+    return key;
+}
+
+/**
+ * Compute every square attacked by one side.
+ *
+ * @param   pos         Pointer to Position structure.
+ * @param   color       Attacking color.
+ * @param   occupancy   Bitboard of blockers for the sliders.
+ *
+ * @return  Bitboard of attacked squares.
+**/
+static inline Bitboard  attacked_squares(const Position *pos, ChessPiece color, Bitboard occupancy) {
+
+    Bitboard own = pos->colors[COLOR_ARR_INDEX(color)];
+    Bitboard attacks = bitboard_pawn_attacks(pos->pieces[PAWN - 1] & own, color == BLACK) |
+        bitboard_knight_attacks(pos->pieces[KNIGHT - 1] & own) |
+        KING_ATTACKS[bitboard_lsb(pos->pieces[KING - 1] & own)];
+
+    // The magic macros evaluate the square more than once
+    Bitboard diagonal = (pos->pieces[BISHOP - 1] | pos->pieces[QUEEN - 1]) & own;
+    while (diagonal) {
+        uint8_t square = bitboard_pop_lsb(diagonal);
+        attacks |= magic_bishop_attacks(square, occupancy);
+    }
+    Bitboard straight = (pos->pieces[ROOK - 1] | pos->pieces[QUEEN - 1]) & own;
+    while (straight) {
+        uint8_t square = bitboard_pop_lsb(straight);
+        attacks |= magic_rook_attacks(square, occupancy);
+    }
+
+    return attacks;
+}
+
+/**
+ * Write moves from one square to every target square (or only count them).
+ *
+ * @param   from        Square (0-63) the piece moves from.
+ * @param   targets     Bitboard of destination squares.
+ * @param   out         Pointer to array of ChessMoves to populate (NULL to count only).
+ * @param   move_idx    Index in out of the first move to write.
+ *
+ * @return  Number of moves added.
+**/
+static inline size_t    serialize_moves(uint8_t from, Bitboard targets, ChessMove *out, size_t move_idx) {
+
+    if (!out) return bitboard_popcount(targets);
+
+    size_t start = move_idx;
+    while (targets) {
+        uint8_t to = bitboard_pop_lsb(targets);
+        out[move_idx++] = MOVE_CREATE(from, to, 0);
+    }
+    return move_idx - start;
+}
+
+/**
+ * Write (or count) a pawn move for every target square of one set-wise
+ * shift, expanding promotions into four moves.
+ *
+ * @param   targets     Bitboard of destination squares.
+ * @param   offset      Square difference from origin to destination.
+ * @param   out         Pointer to array of ChessMoves to populate (NULL to count only).
+ * @param   move_idx    Index in out of the first move to write.
+ *
+ * @return  Number of moves added.
+**/
+static inline size_t    serialize_pawn_targets(Bitboard targets, int offset, ChessMove *out, size_t move_idx) {
+
+    Bitboard promotions = BB_RANK_1 | BB_RANK_8;
+    if (!out) return bitboard_popcount(targets & ~promotions) + 4 * bitboard_popcount(targets & promotions);
+
+    size_t start = move_idx;
+    while (targets) {
+        uint8_t to = bitboard_pop_lsb(targets);
+        uint8_t from = to - offset;
+        if ((1lu << to) & promotions) {
+            out[move_idx++] = MOVE_CREATE(from, to, QUEEN);
+            out[move_idx++] = MOVE_CREATE(from, to, ROOK);
+            out[move_idx++] = MOVE_CREATE(from, to, BISHOP);
+            out[move_idx++] = MOVE_CREATE(from, to, KNIGHT);
+        } else {
+            out[move_idx++] = MOVE_CREATE(from, to, 0);
+        }
+    }
+    return move_idx - start;
+}
+
+/**
+ * Generate (or count) pushes, double pushes, captures and promotions for a
+ * set of pawns at once (en passant is left to the caller).
+ *
+ * @param   pawns       Bitboard of pawns to move.
+ * @param   color       Color of the pawns.
+ * @param   occupancy   Bitboard of all pieces.
+ * @param   enemy       Bitboard of capturable pieces.
+ * @param   allowed     Bitboard of permitted destination squares.
+ * @param   out         Pointer to array of ChessMoves to populate (NULL to count only).
+ * @param   move_idx    Index in out of the first move to write.
+ *
+ * @return  Number of moves added.
+**/
+static inline size_t    pawn_moves(Bitboard pawns, ChessPiece color, Bitboard occupancy, Bitboard enemy,
+                                   Bitboard allowed, ChessMove *out, size_t move_idx) {
+
+    Bitboard single, double_push, west, east;
+    int direction;
+    if (color == WHITE) {
+        direction = 8;
+        single = bitboard_north(pawns) & ~occupancy;
+        double_push = bitboard_north(single & BB_RANK_3) & ~occupancy;
+        west = bitboard_north_west(pawns);
+        east = bitboard_north_east(pawns);
+    } else {
+        direction = -8;
+        single = bitboard_south(pawns) & ~occupancy;
+        double_push = bitboard_south(single & BB_RANK_6) & ~occupancy;
+        west = bitboard_south_west(pawns);
+        east = bitboard_south_east(pawns);
+    }
+
+    size_t start = move_idx;
+    move_idx += serialize_pawn_targets(single & allowed, direction, out, move_idx);
+    move_idx += serialize_pawn_targets(double_push & allowed, 2 * direction, out, move_idx);
+    move_idx += serialize_pawn_targets(west & enemy & allowed, direction - 1, out, move_idx);
+    move_idx += serialize_pawn_targets(east & enemy & allowed, direction + 1, out, move_idx);
+    return move_idx - start;
+}
+
+/**
+ * Generate (or count) the legal moves for the side to move.
+ *
+ * Same pin and check masks as the ChessBoard generator, but with no
+ * maintained attack maps the squares the king may not enter are computed
+ * here, with the king removed so that it cannot step back along a checking
+ * ray. Always inlined so that the count-only caller drops the stores.
+ *
+ * @param   pos     Pointer to Position structure.
+ * @param   out     Pointer to array of ChessMoves to populate
+ *                      (MAX_MOVES elements, terminated with null move),
+ *                      or NULL to count only.
+ *
+ * @return  Number of legal moves.
+**/
+static inline __attribute__((always_inline))
+size_t              legal_moves(const Position *pos, ChessMove *out) {
+
+    size_t move_idx = 0;
+    ChessPiece color = pos->to_move;
+    ChessPiece enemy_color = (color == WHITE) ? BLACK : WHITE;
+
+    Bitboard own        = pos->colors[COLOR_ARR_INDEX(color)];
+    Bitboard enemy      = pos->colors[COLOR_ARR_INDEX(enemy_color)];
+    Bitboard occupancy  = own | enemy;
+
+    Bitboard enemy_pawns    = pos->pieces[PAWN - 1] & enemy;
+    Bitboard enemy_knights  = pos->pieces[KNIGHT - 1] & enemy;
+    Bitboard enemy_diagonal = (pos->pieces[BISHOP - 1] | pos->pieces[QUEEN - 1]) & enemy;
+    Bitboard enemy_straight = (pos->pieces[ROOK - 1] | pos->pieces[QUEEN - 1]) & enemy;
+
+    Bitboard king_bb = pos->pieces[KING - 1] & own;
+    uint8_t king = bitboard_lsb(king_bb);
+
+    Bitboard danger = attacked_squares(pos, enemy_color, occupancy ^ king_bb);
+    move_idx += serialize_moves(king, KING_ATTACKS[king] & ~own & ~danger, out, move_idx);
+
+    Bitboard checkers = 0lu;
+    if (danger & king_bb) {
+        checkers = (KNIGHT_ATTACKS[king] & enemy_knights) |
+            (PAWN_ATTACKS[COLOR_ARR_INDEX(color)][king] & enemy_pawns) |
+            (magic_bishop_attacks(king, occupancy) & enemy_diagonal) |
+            (magic_rook_attacks(king, occupancy) & enemy_straight);
+    }
+
+    // Double check: only the king may move
+    if (checkers & (checkers - 1)) {
+        if (out) out[move_idx] = 0;
+        return move_idx;
+    }
+
+    // Destinations that capture or block a single checker
+    Bitboard check_mask = ~0lu;
+    if (checkers) check_mask = checkers | BETWEEN[king][bitboard_lsb(checkers)];
+
+    // Pieces that are the only blocker between the king and an enemy slider
+    Bitboard pinned = 0lu;
+    Bitboard pinners = (magic_bishop_attacks(king, enemy) & enemy_diagonal) | (magic_rook_attacks(king, enemy) & enemy_straight);
+    while (pinners) {
+        Bitboard blockers = BETWEEN[king][bitboard_pop_lsb(pinners)] & occupancy;
+        if (!(blockers & (blockers - 1))) pinned |= blockers & own;
+    }
+
+    // Knights, bishops, rooks and queens
+    for (ChessPiece type = KNIGHT; type <= QUEEN; type++) {
+        Bitboard pieces = pos->pieces[type - 1] & own;
+        while (pieces) {
+            uint8_t from = bitboard_pop_lsb(pieces);
+
+            Bitboard targets;
+            if (type == KNIGHT) targets = KNIGHT_ATTACKS[from];
+            else if (type == BISHOP) targets = magic_bishop_attacks(from, occupancy);
+            else if (type == ROOK) targets = magic_rook_attacks(from, occupancy);
+            else targets = magic_queen_attacks(from, occupancy);
+
+            targets &= ~own & check_mask;
+            if (pinned & (1lu << from)) targets &= LINE[king][from];
+            move_idx += serialize_moves(from, targets, out, move_idx);
+        }
+    }
+
+    // Pawns: unpinned ones set-wise, pinned ones along their pin line
+    Bitboard pawns = pos->pieces[PAWN - 1] & own;
+    move_idx += pawn_moves(pawns & ~pinned, color, occupancy, enemy, check_mask, out, move_idx);
+    Bitboard pinned_pawns = pawns & pinned;
+    while (pinned_pawns) {
+        uint8_t from = bitboard_pop_lsb(pinned_pawns);
+        move_idx += pawn_moves(1lu << from, color, occupancy, enemy, check_mask & LINE[king][from], out, move_idx);
+    }
+
+    // En passant: the captured pawn may be the checker, and removing both
+    // pawns from the rank may expose the king to a slider
+    if (pos->enpassant_target != -1) {
+        uint8_t to = pos->enpassant_target;
+        uint8_t captured = (color == WHITE) ? to - 8 : to + 8;
+        Bitboard capturers = PAWN_ATTACKS[COLOR_ARR_INDEX(enemy_color)][to] & pawns;
+        if (!(check_mask & ((1lu << to) | (1lu << captured)))) capturers = 0lu;
+        while (capturers) {
+            uint8_t from = bitboard_pop_lsb(capturers);
+            Bitboard from_bb = 1lu << from;
+            if ((pinned & from_bb) && !(LINE[king][from] & (1lu << to))) continue;
+
+            Bitboard after = (occupancy ^ from_bb ^ (1lu << captured)) | (1lu << to);
+            if (!(magic_rook_attacks(king, after) & enemy_straight) && !(magic_bishop_attacks(king, after) & enemy_diagonal))
+                move_idx += serialize_moves(from, 1lu << to, out, move_idx);
+        }
+    }
+
+    // Castling (never out of check, through check or into check)
+    uint8_t castle = (color == WHITE) ? pos->castle : pos->castle >> 2;
+    if ((castle & (POSITION_CASTLE_W_LONG | POSITION_CASTLE_W_SHORT)) && !checkers) {
+        if ((castle & POSITION_CASTLE_W_SHORT) &&
+                !(occupancy & (0x06lu << king)) && !(danger & (0x06lu << king)))
+            move_idx += serialize_moves(king, 1lu << (king + 2), out, move_idx);
+        if ((castle & POSITION_CASTLE_W_LONG) &&
+                !(occupancy & (0x0Elu << (king - 4))) && !(danger & (0x06lu << (king - 3))))
+            move_idx += serialize_moves(king, 1lu << (king - 2), out, move_idx);
+    }
+
+    if (out) out[move_idx] = 0;
+    return move_idx;
+}
+
+
+/* External Functions */
+
+/**
+ * Initialize a Position structure from a FEN.
+ *
+ * @param   pos     Pointer to Position structure.
+ * @param   fen     FEN (if NULL, default initial position is used).
+ *
+ * @return  `true` if the FEN was valid, `false` otherwise.
+**/
+bool        position_init(Position *pos, const char *fen) {
+
+    ChessBoard cb;
+    if (!chessboard_init(&cb, fen)) return false;
+    position_from_chessboard(pos, &cb);
+    return true;
+}
+
+/**
+ * Copy the state of a ChessBoard structure.
+ *
+ * @param   pos     Pointer to Position structure to populate.
+ * @param   cb      Pointer to ChessBoard structure.
+**/
+void        position_from_chessboard(Position *pos, const ChessBoard *cb) {
+
+    memset(pos, 0, sizeof(Position));
+    pos->colors[0] = cb->locations[BB_IDX_COLOR(WHITE)];
+    pos->colors[1] = cb->locations[BB_IDX_COLOR(BLACK)];
+    for (ChessPiece type = PAWN; type <= KING; type++)
+        pos->pieces[type - 1] = cb->locations[BB_IDX_PIECE(type | WHITE)] | cb->locations[BB_IDX_PIECE(type | BLACK)];
+
+    pos->key                = cb->key;
+    pos->halfmove_clock     = (cb->halfmove_clock < UINT16_MAX) ? cb->halfmove_clock : UINT16_MAX;
+    pos->fullmove_counter   = (cb->fullmove_counter < UINT16_MAX) ? cb->fullmove_counter : UINT16_MAX;
+    pos->to_move            = cb->to_move;
+    pos->enpassant_target   = cb->enpassant_target;
+    pos->castle             = zobrist_castle_index(cb->castle_ability_w, cb->castle_ability_b);
+}
+
+/**
+ * Expand a Position structure into a ChessBoard structure, rebuilding the
+ * mailbox and attack maps. The prefetch hook is cleared.
+ *
+ * @param   pos     Pointer to Position structure.
+ * @param   cb      Pointer to ChessBoard structure to populate.
+**/
+void        position_to_chessboard(const Position *pos, ChessBoard *cb) {
+
+    memset(cb, 0, sizeof(ChessBoard));
+    for (ChessPiece type = PAWN; type <= KING; type++) {
+        for (Bitboard bb = pos->pieces[type - 1]; bb; bb &= bb - 1) {
+            uint8_t square = bitboard_lsb(bb);
+            cb->board[square] = type | ((pos->colors[0] & (1lu << square)) ? WHITE : BLACK);
+        }
+    }
+
+    cb->halfmove_clock      = pos->halfmove_clock;
+    cb->fullmove_counter    = pos->fullmove_counter;
+    cb->to_move             = pos->to_move;
+    cb->enpassant_target    = pos->enpassant_target;
+    cb->castle_ability_w    = (pos->castle & 3) << 4;
+    cb->castle_ability_b    = ((pos->castle >> 2) & 3) << 4;
+    cb->king_pos_w          = bitboard_lsb(pos->pieces[KING - 1] & pos->colors[0]);
+    cb->king_pos_b          = bitboard_lsb(pos->pieces[KING - 1] & pos->colors[1]);
+
+    chessboard_refresh(cb);
+}
+
+/**
+ * Look up the piece on a square.
+ *
+ * @param   pos     Pointer to Position structure.
+ * @param   square  Square (0-63).
+ *
+ * @return  ChessPiece on the square, or EMPTY.
+**/
+ChessPiece  position_piece_at(const Position *pos, uint8_t square) {
+
+    Bitboard bb = 1lu << square;
+    if (!((pos->colors[0] | pos->colors[1]) & bb)) return EMPTY;
+    return type_at(pos, bb) | ((pos->colors[0] & bb) ? WHITE : BLACK);
+}
+
+/**
+ * Determine whether a square is attacked by one side.
+ *
+ * @param   pos     Pointer to Position structure.
+ * @param   square  Square (0-63).
+ * @param   color   Attacking color.
+ *
+ * @return  `true` if any piece of color attacks the square.
+**/
+bool        position_square_attacked(const Position *pos, uint8_t square, ChessPiece color) {
+
+    Bitboard attackers = pos->colors[COLOR_ARR_INDEX(color)];
+    Bitboard occupancy = position_occupancy(pos);
+    ChessPiece defender = (color == WHITE) ? BLACK : WHITE;
+
+    return ((PAWN_ATTACKS[COLOR_ARR_INDEX(defender)][square] & pos->pieces[PAWN - 1]) |
+        (KNIGHT_ATTACKS[square] & pos->pieces[KNIGHT - 1]) |
+        (KING_ATTACKS[square] & pos->pieces[KING - 1]) |
+        (magic_bishop_attacks(square, occupancy) & (pos->pieces[BISHOP - 1] | pos->pieces[QUEEN - 1])) |
+        (magic_rook_attacks(square, occupancy) & (pos->pieces[ROOK - 1] | pos->pieces[QUEEN - 1]))) & attackers;
+}
+
+/**
+ * Determine whether the side to move is in check.
+ *
+ * @param   pos     Pointer to Position structure.
+ *
+ * @return  `true` if the king of the side to move is attacked.
+**/
+bool        position_in_check(const Position *pos) {
+
+    uint8_t king = bitboard_lsb(position_bitboard(pos, KING, pos->to_move));
+    return position_square_attacked(pos, king, (pos->to_move == WHITE) ? BLACK : WHITE);
+}
+
+/**
+ * Generate list of legal moves for the side to move.
+ *
+ * @param   pos     Pointer to Position structure.
+ * @param   out     Pointer to array of ChessMoves to populate
+ *                      (MAX_MOVES elements, terminated with null move)
+ *
+ * @return  Number of moves written to out.
+**/
+size_t      position_legal_moves(const Position *pos, ChessMove *out) {
+    return legal_moves(pos, out);
+}
+
+/**
+ * Count the legal moves for the side to move without writing them out.
+ *
+ * @param   pos     Pointer to Position structure.
+ *
+ * @return  Number of legal moves.
+**/
+size_t      position_count_legal_moves(const Position *pos) {
+    return legal_moves(pos, NULL);
+}
+
+/**
+ * Play a legal move in place. There is no undo: callers that need the old
+ * position copy it first (copy-make).
+ *
+ * @param   pos     Pointer to Position structure.
+ * @param   move    Legal ChessMove for the side to move.
+**/
+void        position_make_move(Position *pos, ChessMove move) {
+
+    uint8_t from        = MOVE_FROM(move);
+    uint8_t to          = MOVE_TO(move);
+    ChessPiece promotion = MOVE_PROMOTION(move);
+
+    ChessPiece color = pos->to_move;
+    ChessPiece enemy_color = (color == WHITE) ? BLACK : WHITE;
+    ChessPiece type = type_at(pos, 1lu << from);
+
+    pos->key ^= state_key(pos);
+    if (pos->halfmove_clock < UINT16_MAX) pos->halfmove_clock++;
+
+    // Captures (en passant removes the pawn behind the target square)
+    Bitboard to_bb = 1lu << to;
+    if (pos->colors[COLOR_ARR_INDEX(enemy_color)] & to_bb) {
+        toggle_piece(pos, to, type_at(pos, to_bb), enemy_color);
+        pos->halfmove_clock = 0;
+    } else if (type == PAWN && to == pos->enpassant_target) {
+        toggle_piece(pos, (color == WHITE) ? to - 8 : to + 8, PAWN, enemy_color);
+    }
+
+    toggle_piece(pos, from, type, color);
+    toggle_piece(pos, to, (promotion) ? promotion : type, color);
+
+    // Castling moves the rook alongside the king
+    if (type == KING) {
+        if (to == from + 2) {
+            toggle_piece(pos, from + 3, ROOK, color);
+            toggle_piece(pos, from + 1, ROOK, color);
+        } else if (from == to + 2) {
+            toggle_piece(pos, from - 4, ROOK, color);
+            toggle_piece(pos, from - 1, ROOK, color);
+        }
+    }
+
+    pos->castle &= CASTLE_MASK[from] & CASTLE_MASK[to];
+
+    pos->enpassant_target = -1;
+    if (type == PAWN) {
+        pos->halfmove_clock = 0;
+        if (to == from + 16 || from == to + 16) pos->enpassant_target = (from + to) / 2;
+    }
+
+    if (color == BLACK && pos->fullmove_counter < UINT16_MAX) pos->fullmove_counter++;
+    pos->to_move = enemy_color;
+
+    pos->key ^= state_key(pos) ^ ZOBRIST_SIDE;
+}
+
+/**
+ * Count leaf nodes with copy-make: each child is a copy of its parent with
+ * one move played, so nothing is ever unmade.
+ *
+ * @param   pos     Pointer to Position structure.
+ * @param   depth   Number of plies to search.
+ *
+ * @return  Number of leaf nodes at the given depth.
+**/
+size_t      position_perft(const Position *pos, size_t depth) {
+
+    if (depth == 0) return 1;
+    if (depth == 1) return position_count_legal_moves(pos);
+
+    ChessMove moves[MAX_MOVES];
+    size_t moves_count = position_legal_moves(pos, moves);
+
+    size_t nodes = 0;
+    for (size_t i = 0; i < moves_count; i++) {
+        Position child = *pos;
+        position_make_move(&child, moves[i]);
+        nodes += position_perft(&child, depth - 1);
+    }
+
+    return nodes;
+}
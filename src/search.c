@@ -0,0 +1,626 @@
+/* libchess
+ * Jack O'Connor 2025
+ * src/search.c
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "search.h"
+#include "chessboard.h"
+#include "ttable.h"
+
+
+/* Constants */
+
+#define SEARCH_CHECK_INTERVAL   (2048)  // Nodes between clock and stop flag checks
+#define SEARCH_SMP_TT_MB        (16)    // Table allocated for a threaded search given none
+
+static const int PIECE_VALUES[] = { 0, 100, 320, 330, 500, 900, 0 };
+
+// Piece-square tables from white's point of view, rank 8 first (index with square ^ 56 for white)
+static const int PIECE_SQUARES[7][64] = {
+    { 0 },
+    { // Pawn
+         0,  0,  0,  0,  0,  0,  0,  0,
+        50, 50, 50, 50, 50, 50, 50, 50,
+        10, 10, 20, 30, 30, 20, 10, 10,
+         5,  5, 10, 25, 25, 10,  5,  5,
+         0,  0,  0, 20, 20,  0,  0,  0,
+         5, -5,-10,  0,  0,-10, -5,  5,
+         5, 10, 10,-20,-20, 10, 10,  5,
+         0,  0,  0,  0,  0,  0,  0,  0 },
+    { // Knight
+       -50,-40,-30,-30,-30,-30,-40,-50,
+       -40,-20,  0,  0,  0,  0,-20,-40,
+       -30,  0, 10, 15, 15, 10,  0,-30,
+       -30,  5, 15, 20, 20, 15,  5,-30,
+       -30,  0, 15, 20, 20, 15,  0,-30,
+       -30,  5, 10, 15, 15, 10,  5,-30,
+       -40,-20,  0,  5,  5,  0,-20,-40,
+       -50,-40,-30,-30,-30,-30,-40,-50 },
+    { // Bishop
+       -20,-10,-10,-10,-10,-10,-10,-20,
+       -10,  0,  0,  0,  0,  0,  0,-10,
+       -10,  0,  5, 10, 10,  5,  0,-10,
+       -10,  5,  5, 10, 10,  5,  5,-10,
+       -10,  0, 10, 10, 10, 10,  0,-10,
+       -10, 10, 10, 10, 10, 10, 10,-10,
+       -10,  5,  0,  0,  0,  0,  5,-10,
+       -20,-10,-10,-10,-10,-10,-10,-20 },
+    { // Rook
+         0,  0,  0,  0,  0,  0,  0,  0,
+         5, 10, 10, 10, 10, 10, 10,  5,
+        -5,  0,  0,  0,  0,  0,  0, -5,
+        -5,  0,  0,  0,  0,  0,  0, -5,
+        -5,  0,  0,  0,  0,  0,  0, -5,
+        -5,  0,  0,  0,  0,  0,  0, -5,
+        -5,  0,  0,  0,  0,  0,  0, -5,
+         0,  0,  0,  5,  5,  0,  0,  0 },
+    { // Queen
+       -20,-10,-10, -5, -5,-10,-10,-20,
+       -10,  0,  0,  0,  0,  0,  0,-10,
+       -10,  0,  5,  5,  5,  5,  0,-10,
+        -5,  0,  5,  5,  5,  5,  0, -5,
+         0,  0,  5,  5,  5,  5,  0, -5,
+       -10,  5,  5,  5,  5,  5,  0,-10,
+       -10,  0,  5,  0,  0,  0,  0,-10,
+       -20,-10,-10, -5, -5,-10,-10,-20 },
+    { // King
+       -30,-40,-40,-50,-50,-40,-40,-30,
+       -30,-40,-40,-50,-50,-40,-40,-30,
+       -30,-40,-40,-50,-50,-40,-40,-30,
+       -30,-40,-40,-50,-50,-40,-40,-30,
+       -20,-30,-30,-40,-40,-30,-30,-20,
+       -10,-20,-20,-20,-20,-20,-20,-10,
+        20, 20,  0,  0,  0,  0, 20, 20,
+        20, 30, 10,  0,  0, 10, 30, 20 },
+};
+
+
+/* Types */
+
+typedef struct SearchHelper SearchHelper;
+
+typedef struct { // Lives on the caller's stack; nothing inside the tree allocates
+    ChessBoard         *cb;
+    const SearchLimits *limits;
+    size_t              id;                                     // 0 for the main thread
+
+    SearchHelper       *helpers;                                // Main thread only
+    size_t              helpers_count;
+    atomic_size_t      *published;                              // Helpers only: node count seen by main
+
+    size_t              nodes;
+    double              start;
+    bool                stopped;
+
+    ChessMove           pv[SEARCH_MAX_PLY][SEARCH_MAX_PLY];     // Triangular PV table
+    size_t              pv_length[SEARCH_MAX_PLY];
+    ChessMove           previous_pv[SEARCH_MAX_PLY];            // PV of the last iteration
+    size_t              previous_pv_length;
+    ChessMove           killers[SEARCH_MAX_PLY][2];             // Quiet moves that caused cutoffs
+    ChessUndo           undo[SEARCH_MAX_PLY];                   // State destroyed by the move made at each ply
+} SearchState;
+
+struct SearchHelper { // Lazy SMP thread with its own board and stacks
+    pthread_t           thread;
+    ChessBoard          board;
+    SearchLimits        limits;
+    SearchState         state;
+    SearchResult        result;
+    atomic_size_t       nodes;
+};
+
+
+/* Internal Functions */
+
+/**
+ * Read the monotonic clock.
+ *
+ * @return  Seconds since an arbitrary fixed point.
+**/
+static double   search_clock() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * Count a node and periodically check the node, time and stop limits.
+ *
+ * @param   state   Pointer to SearchState structure.
+ *
+ * @return  `true` if the search must stop, `false` otherwise.
+**/
+static inline bool  search_tick(SearchState *state) {
+
+    const SearchLimits *limits = state->limits;
+    state->nodes++;
+
+    if (limits->nodes && state->nodes >= limits->nodes) state->stopped = true;
+    if (state->nodes % SEARCH_CHECK_INTERVAL == 0) {
+        if (state->published) atomic_store_explicit(state->published, state->nodes, memory_order_relaxed);
+        if (limits->stop && atomic_load_explicit(limits->stop, memory_order_relaxed)) state->stopped = true;
+        if (limits->seconds > 0 && search_clock() - state->start >= limits->seconds) state->stopped = true;
+    }
+
+    return state->stopped;
+}
+
+/**
+ * Determine whether the position is drawn by the fifty-move rule or by
+ * repeating a position on the current path or in the game history.
+ *
+ * @param   state   Pointer to SearchState structure.
+ * @param   ply     Distance from the root.
+ *
+ * @return  `true` if the position is a draw, `false` otherwise.
+**/
+static inline bool  search_is_draw(const SearchState *state, size_t ply) {
+
+    const ChessBoard *cb = state->cb;
+    const SearchLimits *limits = state->limits;
+    if (cb->halfmove_clock >= 100) return true;
+
+    // Only positions with the same side to move since the last irreversible move can repeat
+    for (size_t i = 2; i <= cb->halfmove_clock; i += 2) {
+        uint64_t key;
+        if (i <= ply) key = state->undo[ply - i].key;
+        else if (i - ply <= limits->history_count) key = limits->history[limits->history_count - (i - ply)];
+        else break;
+        if (key == cb->key) return true;
+    }
+
+    return false;
+}
+
+/**
+ * Convert a score for storage, making mate scores relative to the node.
+ *
+ * @param   score   Score relative to the root.
+ * @param   ply     Distance from the root.
+ *
+ * @return  Score relative to the node.
+**/
+static inline int   search_score_to_tt(int score, size_t ply) {
+    if (score > SEARCH_MATE - SEARCH_MAX_PLY) return score + (int)ply;
+    if (score < -SEARCH_MATE + SEARCH_MAX_PLY) return score - (int)ply;
+    return score;
+}
+
+/**
+ * Convert a stored score back, making mate scores relative to the root.
+ *
+ * @param   score   Score relative to the node.
+ * @param   ply     Distance from the root.
+ *
+ * @return  Score relative to the root.
+**/
+static inline int   search_score_from_tt(int score, size_t ply) {
+    if (score > SEARCH_MATE - SEARCH_MAX_PLY) return score - (int)ply;
+    if (score < -SEARCH_MATE + SEARCH_MAX_PLY) return score + (int)ply;
+    return score;
+}
+
+/**
+ * Determine whether a move captures something (including en passant).
+ *
+ * @param   cb      Pointer to ChessBoard structure.
+ * @param   move    ChessMove to test.
+ *
+ * @return  `true` if the move is a capture, `false` otherwise.
+**/
+static inline bool  search_is_capture(ChessBoard *cb, ChessMove move) {
+
+    uint8_t to = MOVE_TO(move);
+    if (cb->board[to]) return true;
+    return piece_type(cb->board[MOVE_FROM(move)]) == PAWN && to == cb->enpassant_target;
+}
+
+/**
+ * Score moves for ordering: PV move, transposition table move, then captures
+ * by most valuable victim / least valuable attacker, then promotions, then
+ * killers, then quiet moves.
+ *
+ * @param   state       Pointer to SearchState structure.
+ * @param   ply         Distance from the root.
+ * @param   tt_move     Best move stored in the transposition table (or 0).
+ * @param   moves       Array of ChessMoves.
+ * @param   moves_count Number of moves.
+ * @param   scores      Array to populate with one ordering score per move.
+**/
+static void     search_score_moves(SearchState *state, size_t ply, ChessMove tt_move, ChessMove *moves, size_t moves_count, int *scores) {
+
+    ChessBoard *cb = state->cb;
+    ChessMove pv_move = (ply < state->previous_pv_length) ? state->previous_pv[ply] : 0;
+
+    for (size_t i = 0; i < moves_count; i++) {
+        ChessMove move = moves[i];
+        ChessPiece attacker = piece_type(cb->board[MOVE_FROM(move)]);
+
+        if (move == pv_move) {
+            scores[i] = 1 << 20;
+        } else if (move == tt_move) {
+            scores[i] = 1 << 19;
+        } else if (search_is_capture(cb, move)) {
+            ChessPiece victim = (cb->board[MOVE_TO(move)]) ? piece_type(cb->board[MOVE_TO(move)]) : PAWN;
+            scores[i] = (1 << 16) + PIECE_VALUES[victim] * 8 - attacker;
+        } else if (MOVE_PROMOTION(move)) {
+            scores[i] = (1 << 15) + PIECE_VALUES[MOVE_PROMOTION(move)];
+        } else if (move == state->killers[ply][0]) {
+            scores[i] = (1 << 14) + 1;
+        } else if (move == state->killers[ply][1]) {
+            scores[i] = (1 << 14);
+        } else if (state->id) {
+            // Helper threads shuffle quiet moves so they explore different subtrees first
+            scores[i] = ((uint32_t)move * 2654435761u ^ (uint32_t)state->id * 40503u) >> 22;
+        } else {
+            scores[i] = 0;
+        }
+    }
+}
+
+/**
+ * Swap the best-scored remaining move into position i (selection sort step).
+ *
+ * @param   moves       Array of ChessMoves.
+ * @param   scores      Array of ordering scores.
+ * @param   i           Index to fill.
+ * @param   moves_count Number of moves.
+**/
+static inline void  search_pick_move(ChessMove *moves, int *scores, size_t i, size_t moves_count) {
+
+    size_t best = i;
+    for (size_t j = i + 1; j < moves_count; j++) {
+        if (scores[j] > scores[best]) best = j;
+    }
+
+    ChessMove move = moves[i];
+    moves[i] = moves[best];
+    moves[best] = move;
+    int score = scores[i];
+    scores[i] = scores[best];
+    scores[best] = score;
+}
+
+/**
+ * Search captures (or all evasions when in check) until the position is quiet.
+ *
+ * @param   state   Pointer to SearchState structure.
+ * @param   ply     Distance from the root.
+ * @param   alpha   Lower bound.
+ * @param   beta    Upper bound.
+ *
+ * @return  Score from the side to move's point of view.
+**/
+static int      search_quiescence(SearchState *state, size_t ply, int alpha, int beta) {
+
+    ChessBoard *cb = state->cb;
+    state->pv_length[ply] = 0;
+    if (search_tick(state)) return 0;
+    if (ply >= SEARCH_MAX_PLY - 1) return search_evaluate(cb);
+
+    bool in_check = chessboard_in_check(cb, cb->to_move);
+    int best = -SEARCH_INFINITY;
+    if (!in_check) {
+        best = search_evaluate(cb);
+        if (best >= beta) return best;
+        if (best > alpha) alpha = best;
+    }
+
+    ChessMove moves[MAX_MOVES];
+    int scores[MAX_MOVES];
+    size_t moves_count = chessboard_legal_moves(cb, moves);
+    if (!moves_count) return (in_check) ? -SEARCH_MATE + (int)ply : 0;
+
+    if (!in_check) {
+        size_t kept = 0;
+        for (size_t i = 0; i < moves_count; i++) {
+            if (search_is_capture(cb, moves[i]) || MOVE_PROMOTION(moves[i]) == QUEEN) moves[kept++] = moves[i];
+        }
+        moves_count = kept;
+    }
+    search_score_moves(state, ply, 0, moves, moves_count, scores);
+
+    for (size_t i = 0; i < moves_count; i++) {
+        search_pick_move(moves, scores, i, moves_count);
+
+        chessboard_make_move_with(cb, moves[i], &state->undo[ply]);
+        int score = -search_quiescence(state, ply + 1, -beta, -alpha);
+        chessboard_unmake_move_with(cb, moves[i], &state->undo[ply]);
+        if (state->stopped) return 0;
+
+        if (score > best) best = score;
+        if (score > alpha) alpha = score;
+        if (alpha >= beta) break;
+    }
+
+    return best;
+}
+
+/**
+ * Negamax alpha-beta search with check extension.
+ *
+ * @param   state   Pointer to SearchState structure.
+ * @param   depth   Remaining depth in plies.
+ * @param   ply     Distance from the root.
+ * @param   alpha   Lower bound.
+ * @param   beta    Upper bound.
+ *
+ * @return  Score from the side to move's point of view.
+**/
+static int      search_negamax(SearchState *state, size_t depth, size_t ply, int alpha, int beta) {
+
+    ChessBoard *cb = state->cb;
+    state->pv_length[ply] = 0;
+    if (ply && search_is_draw(state, ply)) return 0;
+
+    bool in_check = chessboard_in_check(cb, cb->to_move);
+    if (in_check) depth++;
+    if (!depth) return search_quiescence(state, ply, alpha, beta);
+
+    if (search_tick(state)) return 0;
+    if (ply >= SEARCH_MAX_PLY - 1) return search_evaluate(cb);
+
+    TTable *tt = state->limits->tt;
+    TTableHit hit;
+    ChessMove tt_move = 0;
+    if (tt && ttable_probe(tt, cb->key, &hit)) {
+        tt_move = hit.move;
+        if (ply && hit.depth >= depth) {
+            int score = search_score_from_tt(hit.score, ply);
+            if (hit.bound == TTABLE_EXACT ||
+                    (hit.bound == TTABLE_LOWER && score >= beta) ||
+                    (hit.bound == TTABLE_UPPER && score <= alpha)) return score;
+        }
+    }
+
+    ChessMove moves[MAX_MOVES];
+    int scores[MAX_MOVES];
+    size_t moves_count = chessboard_legal_moves(cb, moves);
+    if (!moves_count) return (in_check) ? -SEARCH_MATE + (int)ply : 0;
+    search_score_moves(state, ply, tt_move, moves, moves_count, scores);
+
+    int alpha_original = alpha;
+    int best = -SEARCH_INFINITY;
+    ChessMove best_move = 0;
+    for (size_t i = 0; i < moves_count; i++) {
+        search_pick_move(moves, scores, i, moves_count);
+        ChessMove move = moves[i];
+        bool quiet = !search_is_capture(cb, move) && !MOVE_PROMOTION(move);
+
+        chessboard_make_move_with(cb, move, &state->undo[ply]);
+        int score = -search_negamax(state, depth - 1, ply + 1, -beta, -alpha);
+        chessboard_unmake_move_with(cb, move, &state->undo[ply]);
+        if (state->stopped) return 0;
+
+        if (score > best) {
+            best = score;
+            best_move = move;
+        }
+        if (score > alpha) {
+            alpha = score;
+
+            state->pv[ply][0] = move;
+            memcpy(&state->pv[ply][1], state->pv[ply + 1], state->pv_length[ply + 1] * sizeof(ChessMove));
+            state->pv_length[ply] = state->pv_length[ply + 1] + 1;
+        }
+        if (alpha >= beta) {
+            if (quiet && state->killers[ply][0] != move) {
+                state->killers[ply][1] = state->killers[ply][0];
+                state->killers[ply][0] = move;
+            }
+            break;
+        }
+    }
+
+    if (tt) {
+        uint8_t bound = (best >= beta) ? TTABLE_LOWER : (best > alpha_original) ? TTABLE_EXACT : TTABLE_UPPER;
+        ttable_store(tt, cb->key, best_move, search_score_to_tt(best, ply), depth, bound);
+    }
+
+    return best;
+}
+
+
+/**
+ * Total nodes searched by the helper threads so far.
+ *
+ * @param   state   Pointer to the main thread's SearchState structure.
+ *
+ * @return  Sum of the counts published by every helper.
+**/
+static size_t   search_helper_nodes(SearchState *state) {
+
+    size_t nodes = 0;
+    for (size_t i = 0; i < state->helpers_count; i++) {
+        nodes += atomic_load_explicit(&state->helpers[i].nodes, memory_order_relaxed);
+    }
+    return nodes;
+}
+
+/**
+ * Iterative deepening loop shared by the main thread and the helpers.
+ *
+ * Odd helpers search one ply deeper than the main thread at every
+ * iteration, so the threads are spread over two depths.
+ *
+ * @param   state   Pointer to SearchState structure.
+ * @param   result  Pointer to SearchResult structure to populate.
+**/
+static void     search_iterate(SearchState *state, SearchResult *result) {
+
+    const SearchLimits *limits = state->limits;
+    state->start = search_clock();
+
+    size_t max_depth = SEARCH_MAX_PLY - 1;
+    if (limits->depth && limits->depth < max_depth) max_depth = limits->depth;
+
+    for (size_t iteration = 1; iteration <= max_depth; iteration++) {
+        size_t depth = iteration + (state->id & 1);
+        if (depth > max_depth) depth = max_depth;
+
+        int score = search_negamax(state, depth, 0, -SEARCH_INFINITY, SEARCH_INFINITY);
+        if (state->stopped && (iteration > 1 || !state->pv_length[0])) break;
+
+        result->depth = depth;
+        result->score = score;
+        result->pv_length = state->pv_length[0];
+        memcpy(result->pv, state->pv[0], state->pv_length[0] * sizeof(ChessMove));
+        memcpy(state->previous_pv, state->pv[0], state->pv_length[0] * sizeof(ChessMove));
+        state->previous_pv_length = state->pv_length[0];
+
+        result->nodes = state->nodes + search_helper_nodes(state);
+        result->seconds = search_clock() - state->start;
+        result->nps = (result->seconds > 0) ? result->nodes / result->seconds : 0;
+        if (limits->info) limits->info(result, limits->info_arg);
+
+        if (state->stopped || !result->pv_length || depth == max_depth) break;
+        // The next iteration usually takes longer than all previous ones together
+        if (limits->seconds > 0 && result->seconds > limits->seconds / 2) break;
+    }
+
+    if (state->published) atomic_store(state->published, state->nodes);
+}
+
+/**
+ * Helper thread main function.
+ *
+ * @param   arg     Pointer to SearchHelper structure.
+ *
+ * @return  NULL.
+**/
+static void *   search_helper_main(void *arg) {
+    SearchHelper *helper = (SearchHelper *) arg;
+    search_iterate(&helper->state, &helper->result);
+    return NULL;
+}
+
+
+/* External Functions */
+
+/**
+ * Static evaluation: material plus piece-square tables.
+ *
+ * @param   cb      Pointer to ChessBoard structure.
+ *
+ * @return  Centipawns from the side to move's point of view.
+**/
+int             search_evaluate(ChessBoard *cb) {
+
+    int score = 0;
+    for (ChessPiece type = PAWN; type <= KING; type++) {
+        Bitboard white = cb->locations[BB_IDX_PIECE(type | WHITE)];
+        while (white) score += PIECE_VALUES[type] + PIECE_SQUARES[type][bitboard_pop_lsb(white) ^ 56];
+
+        Bitboard black = cb->locations[BB_IDX_PIECE(type | BLACK)];
+        while (black) score -= PIECE_VALUES[type] + PIECE_SQUARES[type][bitboard_pop_lsb(black)];
+    }
+
+    return (cb->to_move == WHITE) ? score : -score;
+}
+
+/**
+ * Search for the best move with iterative-deepening negamax alpha-beta.
+ *
+ * Each iteration searches one ply deeper, trying the previous principal
+ * variation first. An iteration cut short by a limit is discarded (unless
+ * it is the first), so the result always comes from a completed depth. The
+ * tree is searched with make/unmake on cb and never allocates. With a
+ * transposition table in limits, cb's prefetch hook is pointed at it for
+ * the duration of the search.
+ *
+ * With more than one thread the search is Lazy SMP: helper threads run the
+ * same iterative deepening on their own board copies, perturbed in depth
+ * and move order, and communicate only through the shared transposition
+ * table (a temporary one is created if limits has none). The main thread
+ * alone applies the node and time limits and stops the helpers when it
+ * finishes; the deepest completed result wins and node counts are summed.
+ *
+ * @param   cb      Pointer to ChessBoard structure (unchanged on return).
+ * @param   limits  Pointer to SearchLimits structure.
+ * @param   result  Pointer to SearchResult structure to populate
+ *                      (pv_length is 0 if there are no legal moves).
+ *
+ * @return  `true` if successful, `false` otherwise.
+**/
+bool            chessboard_search(ChessBoard *cb, const SearchLimits *limits, SearchResult *result) {
+
+    double start = search_clock();
+    memset(result, 0, sizeof(SearchResult));
+
+    SearchLimits main_limits = *limits;
+    size_t threads = (limits->threads) ? limits->threads : 1;
+
+    TTable *own_tt = NULL;
+    if (threads > 1 && !main_limits.tt) {
+        own_tt = ttable_create(SEARCH_SMP_TT_MB);
+        if (!own_tt) return false;
+        main_limits.tt = own_tt;
+    }
+    if (main_limits.tt) ttable_new_search(main_limits.tt);
+
+    SearchState *state = (SearchState *) calloc(1, sizeof(SearchState));
+    SearchHelper *helpers = (threads > 1) ? (SearchHelper *) calloc(threads - 1, sizeof(SearchHelper)) : NULL;
+    if (!state || (threads > 1 && !helpers)) {
+        free(state);
+        free(helpers);
+        ttable_delete(own_tt);
+        return false;
+    }
+
+    ChessPrefetchFunc prefetch = cb->prefetch;
+    void *prefetch_arg = cb->prefetch_arg;
+    if (main_limits.tt) chessboard_set_prefetch(cb, ttable_prefetch, main_limits.tt);
+
+    atomic_bool stop_helpers = false;
+    size_t helpers_count = 0;
+    for (size_t i = 0; i + 1 < threads; i++) {
+        SearchHelper *helper = &helpers[i];
+        helper->board = *cb;
+        helper->limits = (SearchLimits){
+            .depth          = main_limits.depth,
+            .tt             = main_limits.tt,
+            .stop           = &stop_helpers,
+            .history        = main_limits.history,
+            .history_count  = main_limits.history_count,
+        };
+        helper->state.cb = &helper->board;
+        helper->state.limits = &helper->limits;
+        helper->state.id = i + 1;
+        helper->state.published = &helper->nodes;
+        if (pthread_create(&helper->thread, NULL, search_helper_main, helper)) break;
+        helpers_count++;
+    }
+
+    state->cb = cb;
+    state->limits = &main_limits;
+    state->helpers = helpers;
+    state->helpers_count = helpers_count;
+    search_iterate(state, result);
+
+    atomic_store(&stop_helpers, true);
+    size_t nodes = state->nodes;
+    for (size_t i = 0; i < helpers_count; i++) {
+        pthread_join(helpers[i].thread, NULL);
+        nodes += helpers[i].state.nodes;
+
+        SearchResult *helper_result = &helpers[i].result;
+        if (helper_result->depth > result->depth && helper_result->pv_length) *result = *helper_result;
+    }
+
+    chessboard_set_prefetch(cb, prefetch, prefetch_arg);
+    free(helpers);
+    free(state);
+    ttable_delete(own_tt);
+
+    result->nodes = nodes;
+    result->seconds = search_clock() - start;
+    result->nps = (result->seconds > 0) ? result->nodes / result->seconds : 0;
+    return true;
+}
@@ -0,0 +1,112 @@
+/* libchess
+ * Jack O'Connor 2025
+ * src/smp_bench.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "chessboard.h"
+#include "search.h"
+#include "ttable.h"
+
+
+/* Constants */
+
+static const char *SUITE[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "r1bq1rk1/pp2bppp/2n1pn2/2pp4/3P4/2PBPN2/PP1N1PPP/R1BQ1RK1 w - - 0 8",
+    "2r3k1/pp3ppp/4p3/3n4/3P4/P4N2/1P3PPP/2R3K1 w - - 0 25",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+};
+
+static const size_t THREADS[] = { 1, 2, 4, 8, 16 };
+
+
+/* Functions */
+
+void    usage(const char *program, int status) {
+    fprintf(stderr, "Usage: %s [options]\n", program);
+    fprintf(stderr, "    -d DEPTH    Depth every position is searched to (default: 7)\n");
+    fprintf(stderr, "    -H MB       Shared transposition table size (default: 64)\n");
+    fprintf(stderr, "    -m THREADS  Largest thread count to run (default: 16)\n");
+    exit(status);
+}
+
+
+/* Main Execution */
+
+int main(int argc, char *argv[]) {
+
+    size_t depth = 7;
+    size_t hash_mb = 64;
+    size_t max_threads = 16;
+
+    int option;
+    while ((option = getopt(argc, argv, "d:H:m:h")) != -1) {
+        switch (option) {
+            case 'd':
+                depth = strtoul(optarg, NULL, 10);
+                break;
+            case 'H':
+                hash_mb = strtoul(optarg, NULL, 10);
+                break;
+            case 'm':
+                max_threads = strtoul(optarg, NULL, 10);
+                break;
+            case 'h':
+                usage(argv[0], EXIT_SUCCESS);
+                break;
+            default:
+                usage(argv[0], EXIT_FAILURE);
+        }
+    }
+
+    TTable *tt = ttable_create(hash_mb);
+    if (!tt) {
+        fprintf(stderr, "Unable to allocate %lu MB transposition table\n", hash_mb);
+        return EXIT_FAILURE;
+    }
+
+    fprintf(stdout, "Time to depth %lu over %lu positions (%lu MB table)\n\n",
+            depth, sizeof(SUITE) / sizeof(SUITE[0]), hash_mb);
+    fprintf(stdout, "%8s %10s %12s %12s %8s\n", "Threads", "Time", "Nodes", "NPS", "Speedup");
+
+    double baseline = 0;
+    for (size_t t = 0; t < sizeof(THREADS) / sizeof(THREADS[0]) && THREADS[t] <= max_threads; t++) {
+        double seconds = 0;
+        size_t nodes = 0;
+
+        for (size_t i = 0; i < sizeof(SUITE) / sizeof(SUITE[0]); i++) {
+            ChessBoard *cb = chessboard_create(SUITE[i]);
+            if (!cb) {
+                fprintf(stderr, "Unable to create board: %s\n", SUITE[i]);
+                return EXIT_FAILURE;
+            }
+
+            // Every run starts from an empty table so thread counts compare fairly
+            ttable_clear(tt);
+            SearchLimits limits = { .depth = depth, .threads = THREADS[t], .tt = tt };
+            SearchResult result;
+            if (!chessboard_search(cb, &limits, &result)) {
+                fprintf(stderr, "Search failed: %s\n", SUITE[i]);
+                return EXIT_FAILURE;
+            }
+
+            seconds += result.seconds;
+            nodes += result.nodes;
+            chessboard_delete(cb);
+        }
+
+        if (t == 0) baseline = seconds;
+        fprintf(stdout, "%8lu %9.3fs %12lu %12.0f %7.2fx\n",
+                THREADS[t], seconds, nodes, nodes / seconds, baseline / seconds);
+    }
+
+    ttable_delete(tt);
+    return EXIT_SUCCESS;
+}
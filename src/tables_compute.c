@@ -0,0 +1,234 @@
+/* libchess
+ * Jack O'Connor 2025
+ * src/tables_compute.c
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "tables.h"
+
+
+/* Constants */
+
+#define ZOBRIST_SEED    (0x6A09E667F3BCC909lu)
+
+static const int BISHOP_DIRECTIONS[][2] = {
+    {-1, -1}, {1, -1}, {-1, 1}, {1, 1}
+};
+
+static const int ROOK_DIRECTIONS[][2] = {
+    {0, -1}, {-1, 0}, {1, 0}, {0, 1}
+};
+
+// Found offline with a sparse random search (fixed seed), one per square
+static const Bitboard BISHOP_MAGICS[64] = {
+    0xA010041108003100ULL, 0x006082020A002900ULL, 0x6810010619200000ULL, 0x08281A0520000408ULL,
+    0x0001104001000400ULL, 0x0018901008048400ULL, 0x00040A0210245280ULL, 0x000200210808A402ULL,
+    0x9140048410821200ULL, 0x0800091010820041ULL, 0x20504804832202C0ULL, 0x0100091401081000ULL,
+    0x8021011140000012ULL, 0x0810020804450400ULL, 0x208B0542109008A2ULL, 0x0080084A08040204ULL,
+    0x0040E2A80811244CULL, 0x2505022008008108ULL, 0x0430220100420040ULL, 0x010A040420220040ULL,
+    0x1105000290400000ULL, 0x0093001200822120ULL, 0x4000A62048043004ULL, 0x280120048A015004ULL,
+    0x006090002A020814ULL, 0x44042000240800D0ULL, 0x01102800040A4400ULL, 0x1004080080220040ULL,
+    0x0001001011004024ULL, 0x0010044000805040ULL, 0x0914041200820100ULL, 0x0004821012821480ULL,
+    0x0024040500C05021ULL, 0x0088611002080200ULL, 0x0116080A00040020ULL, 0x4000020080080080ULL,
+    0x2450450140840040ULL, 0x0000880201484100ULL, 0x0222020404020092ULL, 0x8081110600002E00ULL,
+    0x2842101105000801ULL, 0x1100809008001025ULL, 0x00020202221C0400ULL, 0x0422014022009020ULL,
+    0x0210046102100C00ULL, 0xC004008082029102ULL, 0x00AA461801101200ULL, 0x0404080080201108ULL,
+    0x020542108C205002ULL, 0x0410544804100100ULL, 0x0040910841100000ULL, 0x0400200042021100ULL,
+    0x00004204850400C0ULL, 0x0200100410A42102ULL, 0x1040020801210102ULL, 0x0805040410420000ULL,
+    0x2884804130100200ULL, 0x800C262201242000ULL, 0x1058000194108800ULL, 0x0014221054420204ULL,
+    0x0104000012A02200ULL, 0x0200881003300100ULL, 0x0140400202840100ULL, 0x0402020801010201ULL,
+};
+
+static const Bitboard ROOK_MAGICS[64] = {
+    0x1080004008801020ULL, 0x0840092002C03000ULL, 0x1900200010400900ULL, 0x0880100008000480ULL,
+    0x4200100420080200ULL, 0x8100020100080400ULL, 0x0200040110886200ULL, 0x0200008040220411ULL,
+    0x0404800084400220ULL, 0x0000401000402000ULL, 0x0086001081220440ULL, 0x0408800800100280ULL,
+    0x000A001201040820ULL, 0x8848800200840080ULL, 0x4001000100040200ULL, 0x0442000102105084ULL,
+    0x9080010020804100ULL, 0x0040404000201009ULL, 0x0000808010002009ULL, 0x2200090021D00100ULL,
+    0x0008008008040080ULL, 0x0004004002010040ULL, 0x0011040008015042ULL, 0x00000A0001768104ULL,
+    0x0000800080204009ULL, 0x2010004140002001ULL, 0x9800200280100080ULL, 0x1000100080080080ULL,
+    0x0442000A00049020ULL, 0x2100040080020080ULL, 0x0800120400900148ULL, 0x0010040A00128541ULL,
+    0x2800804000800030ULL, 0x1010002000400041ULL, 0x4000200011004100ULL, 0x0610008410800800ULL,
+    0x0400802402800800ULL, 0xC100020080800400ULL, 0x0002000802000401ULL, 0x0182085882000401ULL,
+    0x0220204000808000ULL, 0x2860100040024022ULL, 0x0001002004110040ULL, 0x99101042000A0020ULL,
+    0x0004080004008080ULL, 0x0010040002008080ULL, 0x2012004881020004ULL, 0x8300842444820011ULL,
+    0x0088403882010200ULL, 0x0820400080210100ULL, 0x0110910040A00300ULL, 0x0801100280080480ULL,
+    0x0242009008200600ULL, 0x1002000489500200ULL, 0x0040800200010080ULL, 0x0091800041000080ULL,
+    0x0000209300488001ULL, 0x04C1002414824001ULL, 0x020020000B001041ULL, 0x7000100004200901ULL,
+    0x8002002004100802ULL, 0x30010002084C0007ULL, 0x0888221800813004ULL, 0x4000002840840112ULL,
+};
+
+
+/* Internal Functions */
+
+/**
+ * Walk the rays of a slider one square at a time.
+ *
+ * @param   square      Square (0-63) of the sliding piece.
+ * @param   occupancy   Bitboard of blocking pieces.
+ * @param   directions  Array of {file, rank} ray directions.
+ * @param   edges       Stop before the board edge (used to build relevance masks).
+ *
+ * @return  Bitboard of attacked squares (including the first blocker on each ray).
+**/
+static Bitboard ray_attacks(uint8_t square, Bitboard occupancy, const int directions[][2], bool edges) {
+
+    Bitboard attacks = 0lu;
+    for (size_t i = 0; i < 4; i++) {
+        int dx = directions[i][0];
+        int dy = directions[i][1];
+        int file = (square % 8) + dx;
+        int rank = (square / 8) + dy;
+
+        while (file >= 0 && file < 8 && rank >= 0 && rank < 8) {
+            if (edges && (file + dx < 0 || file + dx >= 8 || rank + dy < 0 || rank + dy >= 8)) break;
+
+            attacks |= 1lu << (rank * 8 + file);
+            if (bitboard_get(occupancy, file, rank)) break;
+
+            file += dx;
+            rank += dy;
+        }
+    }
+
+    return attacks;
+}
+
+/**
+ * Advance a xorshift64* generator.
+ *
+ * @param   state   Pointer to generator state (must be non-zero).
+ *
+ * @return  Next pseudorandom 64-bit value.
+**/
+static uint64_t zobrist_random(uint64_t *state) {
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 2685821657736338717lu;
+}
+
+
+/* External Functions */
+
+/**
+ * Compute the single-square attack tables from the set-wise generators.
+ *
+ * @param   knight  Array of 64 knight attack sets to populate.
+ * @param   king    Array of 64 king attack sets to populate.
+ * @param   pawn    Pawn attack sets to populate ([0] white, [1] black).
+**/
+void        tables_compute_leapers(Bitboard knight[64], Bitboard king[64], Bitboard pawn[2][64]) {
+
+    for (uint8_t square = 0; square < 64; square++) {
+        Bitboard b = 1lu << square;
+        knight[square] = bitboard_knight_attacks(b);
+        king[square] = bitboard_king_attacks(b);
+        pawn[0][square] = bitboard_pawn_attacks(b, false);
+        pawn[1][square] = bitboard_pawn_attacks(b, true);
+    }
+}
+
+/**
+ * Compute the Magic entries and the shared attack table of one slider type.
+ *
+ * @param   magics  Array of 64 Magic structures to populate.
+ * @param   table   Attack table to fill (MAGIC_BISHOP_TABLE_SIZE or
+ *                      MAGIC_ROOK_TABLE_SIZE elements).
+ * @param   bishop  `true` for diagonal rays, `false` for orthogonal rays.
+**/
+void        tables_compute_magics(Magic magics[64], Bitboard *table, bool bishop) {
+
+    const int (*directions)[2] = (bishop) ? BISHOP_DIRECTIONS : ROOK_DIRECTIONS;
+    const Bitboard *numbers = (bishop) ? BISHOP_MAGICS : ROOK_MAGICS;
+
+    uint32_t offset = 0;
+    for (uint8_t square = 0; square < 64; square++) {
+        Magic *m = &magics[square];
+        m->mask     = ray_attacks(square, 0lu, directions, true);
+        m->magic    = numbers[square];
+        m->offset   = offset;
+        m->shift    = 64 - __builtin_popcountll(m->mask);
+
+        // Enumerate every subset of the mask (Carry-Rippler)
+        Bitboard occupancy = 0lu;
+        do {
+            table[offset + magic_index(m, occupancy)] = ray_attacks(square, occupancy, directions, false);
+            occupancy = (occupancy - m->mask) & m->mask;
+        } while (occupancy);
+
+        offset += 1u << (64 - m->shift);
+    }
+}
+
+/**
+ * Compute the between and line tables for every pair of aligned squares.
+ *
+ * @param   between Squares strictly between two squares, to populate.
+ * @param   line    Full line through two squares, to populate.
+**/
+void        tables_compute_lines(Bitboard between[64][64], Bitboard line[64][64]) {
+
+    for (uint8_t a = 0; a < 64; a++) {
+        for (uint8_t b = 0; b < 64; b++) {
+            between[a][b] = line[a][b] = 0lu;
+            if (a == b) continue;
+
+            Bitboard bb_a = 1lu << a, bb_b = 1lu << b;
+            for (size_t bishop = 0; bishop < 2; bishop++) {
+                const int (*directions)[2] = (bishop) ? BISHOP_DIRECTIONS : ROOK_DIRECTIONS;
+                if (!(ray_attacks(a, 0lu, directions, false) & bb_b)) continue;
+
+                between[a][b] = ray_attacks(a, bb_b, directions, false) & ray_attacks(b, bb_a, directions, false);
+                line[a][b] = (ray_attacks(a, 0lu, directions, false) & ray_attacks(b, 0lu, directions, false)) | bb_a | bb_b;
+            }
+        }
+    }
+}
+
+/**
+ * Compute the Zobrist keys from a fixed seed.
+ *
+ * @param   pieces      Keys indexed by BB_IDX_PIECE(piece), square.
+ * @param   castle      Keys indexed by zobrist_castle_index.
+ * @param   enpassant   Keys indexed by en passant file.
+ * @param   side        Key of black to move.
+**/
+void        tables_compute_zobrist(uint64_t pieces[16][64], uint64_t castle[16], uint64_t enpassant[8], uint64_t *side) {
+
+    uint64_t state = ZOBRIST_SEED;
+    for (size_t piece = 0; piece < 16; piece++) {
+        for (size_t square = 0; square < 64; square++) {
+            pieces[piece][square] = zobrist_random(&state);
+        }
+    }
+
+    // Castle keys are XOR combinations of the four individual rights
+    uint64_t rights[4];
+    for (size_t i = 0; i < 4; i++) rights[i] = zobrist_random(&state);
+    for (size_t index = 0; index < 16; index++) {
+        castle[index] = 0;
+        for (size_t i = 0; i < 4; i++) {
+            if (index & (1 << i)) castle[index] ^= rights[i];
+        }
+    }
+
+    for (size_t file = 0; file < 8; file++) enpassant[file] = zobrist_random(&state);
+    *side = zobrist_random(&state);
+}
+
+/**
+ * Compute slider attacks by walking rays (reference for the magic tables).
+ *
+ * @param   square      Square (0-63) of the sliding piece.
+ * @param   occupancy   Bitboard of all pieces on the board.
+ * @param   bishop      `true` for diagonal rays, `false` for orthogonal rays.
+ *
+ * @return  Bitboard of attacked squares.
+**/
+Bitboard    tables_ray_attacks(uint8_t square, Bitboard occupancy, bool bishop) {
+    return ray_attacks(square, occupancy, (bishop) ? BISHOP_DIRECTIONS : ROOK_DIRECTIONS, false);
+}
@@ -0,0 +1,322 @@
+/* libchess
+ * Jack O'Connor 2025
+ * src/threadpool.c
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "threadpool.h"
+
+
+/* Constants */
+
+#define DEQUE_INITIAL_CAPACITY  (64)
+
+
+/* Globals */
+
+static __thread ThreadPoolWorker *CURRENT_WORKER = NULL;
+
+
+/* Internal Functions */
+
+/**
+ * Push a task onto the owner end of a worker's deque.
+ *
+ * @param   w       Pointer to ThreadPoolWorker structure.
+ * @param   task    Task to push.
+ *
+ * @return  `true` if successful, `false` if the deque could not grow.
+**/
+static bool     deque_push(ThreadPoolWorker *w, ThreadPoolTask task) {
+
+    pthread_mutex_lock(&w->lock);
+    if (w->bottom - w->top == w->capacity) {
+        size_t capacity = w->capacity * 2;
+        ThreadPoolTask *tasks = (ThreadPoolTask *) calloc(capacity, sizeof(ThreadPoolTask));
+        if (!tasks) {
+            pthread_mutex_unlock(&w->lock);
+            return false;
+        }
+
+        for (size_t i = w->top; i != w->bottom; i++) {
+            tasks[i & (capacity - 1)] = w->tasks[i & (w->capacity - 1)];
+        }
+        free(w->tasks);
+        w->tasks = tasks;
+        w->capacity = capacity;
+    }
+
+    w->tasks[w->bottom & (w->capacity - 1)] = task;
+    w->bottom++;
+    pthread_mutex_unlock(&w->lock);
+    return true;
+}
+
+/**
+ * Pop the newest task from a worker's own deque.
+ *
+ * @param   w       Pointer to ThreadPoolWorker structure.
+ * @param   task    Pointer to task to populate.
+ *
+ * @return  `true` if a task was taken, `false` if the deque was empty.
+**/
+static bool     deque_pop(ThreadPoolWorker *w, ThreadPoolTask *task) {
+
+    bool found = false;
+    pthread_mutex_lock(&w->lock);
+    if (w->bottom != w->top) {
+        w->bottom--;
+        *task = w->tasks[w->bottom & (w->capacity - 1)];
+        found = true;
+    }
+    pthread_mutex_unlock(&w->lock);
+    return found;
+}
+
+/**
+ * Steal the oldest task from another worker's deque.
+ *
+ * @param   w       Pointer to victim ThreadPoolWorker structure.
+ * @param   task    Pointer to task to populate.
+ *
+ * @return  `true` if a task was taken, `false` if the deque was empty.
+**/
+static bool     deque_steal(ThreadPoolWorker *w, ThreadPoolTask *task) {
+
+    bool found = false;
+    pthread_mutex_lock(&w->lock);
+    if (w->bottom != w->top) {
+        *task = w->tasks[w->top & (w->capacity - 1)];
+        w->top++;
+        found = true;
+    }
+    pthread_mutex_unlock(&w->lock);
+    return found;
+}
+
+/**
+ * Find work for a worker: its own deque first, then every other worker's.
+ *
+ * @param   w       Pointer to ThreadPoolWorker structure.
+ * @param   task    Pointer to task to populate.
+ *
+ * @return  `true` if a task was found, `false` otherwise.
+**/
+static bool     worker_find_task(ThreadPoolWorker *w, ThreadPoolTask *task) {
+
+    if (deque_pop(w, task)) return true;
+
+    ThreadPool *pool = w->pool;
+    for (size_t i = 1; i < pool->workers_count; i++) {
+        ThreadPoolWorker *victim = &pool->workers[(w->index + i) % pool->workers_count];
+        if (deque_steal(victim, task)) {
+            atomic_fetch_add(&pool->steals, 1);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Worker thread main loop.
+ *
+ * @param   arg     Pointer to the worker's ThreadPoolWorker structure.
+ *
+ * @return  NULL.
+**/
+static void *   worker_main(void *arg) {
+
+    ThreadPoolWorker *w = (ThreadPoolWorker *) arg;
+    ThreadPool *pool = w->pool;
+    CURRENT_WORKER = w;
+
+    while (true) {
+        ThreadPoolTask task;
+        if (worker_find_task(w, &task)) {
+            atomic_fetch_sub(&pool->queued, 1);
+            task.func(task.arg);
+
+            if (atomic_fetch_sub(&pool->pending, 1) == 1) {
+                pthread_mutex_lock(&pool->lock);
+                pthread_cond_broadcast(&pool->work_done);
+                pthread_mutex_unlock(&pool->lock);
+            }
+            continue;
+        }
+
+        pthread_mutex_lock(&pool->lock);
+        atomic_fetch_add(&pool->idle, 1);
+        while (!atomic_load(&pool->queued) && !pool->shutdown) {
+            pthread_cond_wait(&pool->work_ready, &pool->lock);
+        }
+        atomic_fetch_sub(&pool->idle, 1);
+        bool stop = pool->shutdown && !atomic_load(&pool->queued);
+        pthread_mutex_unlock(&pool->lock);
+
+        if (stop) break;
+    }
+
+    return NULL;
+}
+
+/**
+ * Stop the first `started` workers (after queued tasks finish) and
+ * deallocate every deque and the ThreadPool structure.
+ *
+ * @param   pool    Pointer to ThreadPool structure.
+ * @param   started Number of workers whose threads are running.
+**/
+static void     threadpool_destroy(ThreadPool *pool, size_t started) {
+
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = true;
+    pthread_cond_broadcast(&pool->work_ready);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (size_t i = 0; i < started; i++) pthread_join(pool->workers[i].thread, NULL);
+    for (size_t i = 0; i < pool->workers_count; i++) {
+        pthread_mutex_destroy(&pool->workers[i].lock);
+        free(pool->workers[i].tasks);
+    }
+
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->work_ready);
+    pthread_cond_destroy(&pool->work_done);
+    free(pool->workers);
+    free(pool);
+}
+
+
+/* External Functions */
+
+/**
+ * Create a work-stealing ThreadPool structure and start its workers.
+ *
+ * @param   threads     Number of worker threads (0 for one per online CPU).
+ *
+ * @return  Pointer to new ThreadPool structure, or NULL if error.
+**/
+ThreadPool *    threadpool_create(size_t threads) {
+
+    if (!threads) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = (cpus > 0) ? (size_t)cpus : 1;
+    }
+
+    ThreadPool *pool = (ThreadPool *) calloc(1, sizeof(ThreadPool));
+    if (!pool) return NULL;
+
+    pool->workers = (ThreadPoolWorker *) calloc(threads, sizeof(ThreadPoolWorker));
+    if (!pool->workers) {
+        free(pool);
+        return NULL;
+    }
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work_ready, NULL);
+    pthread_cond_init(&pool->work_done, NULL);
+
+    pool->workers_count = threads;
+    bool allocated = true;
+    for (size_t i = 0; i < threads; i++) {
+        ThreadPoolWorker *w = &pool->workers[i];
+        w->pool = pool;
+        w->index = i;
+        w->capacity = DEQUE_INITIAL_CAPACITY;
+        w->tasks = (ThreadPoolTask *) calloc(w->capacity, sizeof(ThreadPoolTask));
+        pthread_mutex_init(&w->lock, NULL);
+        allocated = allocated && w->tasks;
+    }
+    if (!allocated) {
+        threadpool_destroy(pool, 0);
+        return NULL;
+    }
+
+    // Running workers already steal across all workers_count deques, so a
+    // partial start is torn down rather than shrunk
+    size_t started = 0;
+    while (started < threads &&
+           !pthread_create(&pool->workers[started].thread, NULL, worker_main, &pool->workers[started])) started++;
+    if (started < threads) {
+        threadpool_destroy(pool, started);
+        return NULL;
+    }
+
+    return pool;
+}
+
+/**
+ * Stop the workers (after queued tasks finish) and deallocate ThreadPool structure.
+ *
+ * @param   pool    Pointer to ThreadPool structure.
+**/
+void            threadpool_delete(ThreadPool *pool) {
+    threadpool_destroy(pool, pool->workers_count);
+}
+
+/**
+ * Queue a task. Called from a worker, the task goes onto that worker's own
+ * deque (where idle workers can steal it); otherwise workers are chosen
+ * round-robin.
+ *
+ * @param   pool    Pointer to ThreadPool structure.
+ * @param   func    Function to run.
+ * @param   arg     Argument passed to func.
+ *
+ * @return  `true` if the task was queued, `false` otherwise.
+**/
+bool            threadpool_submit(ThreadPool *pool, ThreadPoolFunc func, void *arg) {
+
+    ThreadPoolWorker *w = CURRENT_WORKER;
+    if (!w || w->pool != pool) {
+        w = &pool->workers[atomic_fetch_add(&pool->next, 1) % pool->workers_count];
+    }
+
+    // Counted before the push: a thief may run the task and decrement them first
+    atomic_fetch_add(&pool->pending, 1);
+    atomic_fetch_add(&pool->queued, 1);
+    if (!deque_push(w, (ThreadPoolTask){ func, arg })) {
+        atomic_fetch_sub(&pool->queued, 1);
+        atomic_fetch_sub(&pool->pending, 1);
+        return false;
+    }
+
+    if (atomic_load(&pool->idle)) {
+        pthread_mutex_lock(&pool->lock);
+        pthread_cond_signal(&pool->work_ready);
+        pthread_mutex_unlock(&pool->lock);
+    }
+
+    return true;
+}
+
+/**
+ * Block until every submitted task (including tasks submitted by tasks) has finished.
+ *
+ * @param   pool    Pointer to ThreadPool structure.
+**/
+void            threadpool_wait(ThreadPool *pool) {
+
+    pthread_mutex_lock(&pool->lock);
+    while (atomic_load(&pool->pending)) {
+        pthread_cond_wait(&pool->work_done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/**
+ * Number of workers currently sleeping for lack of work.
+ *
+ * @param   pool    Pointer to ThreadPool structure.
+ *
+ * @return  Count of idle workers (a hint; may change immediately).
+**/
+size_t          threadpool_idle(ThreadPool *pool) {
+    return atomic_load(&pool->idle);
+}
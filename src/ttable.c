@@ -0,0 +1,195 @@
+/* libchess
+ * Jack O'Connor 2025
+ * src/ttable.c
+ */
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "ttable.h"
+
+
+/* Constants */
+
+#define TTABLE_AGE_MASK     (0x3F)      // Six bits of generation
+
+
+/* Macro Functions */
+
+#define ttable_pack(move, score, depth, bound, age) \
+    ((uint64_t)(move) | ((uint64_t)(uint16_t)(score) << 16) | ((uint64_t)(depth) << 32) | \
+     ((uint64_t)(bound) << 40) | ((uint64_t)(age) << 42))
+
+#define ttable_data_depth(data)     ((uint8_t)((data) >> 32))
+#define ttable_data_age(data)       ((uint8_t)(((data) >> 42) & TTABLE_AGE_MASK))
+
+
+/* External Functions */
+
+/**
+ * Create a TTable structure backed by an anonymous mapping advised for
+ * transparent huge pages.
+ *
+ * @param   megabytes   Table size in MB (rounded down to a power-of-two bucket count).
+ *
+ * @return  Pointer to new TTable structure, or NULL if error.
+**/
+TTable *        ttable_create(size_t megabytes) {
+
+    size_t buckets = (megabytes << 20) / sizeof(TTableBucket);
+    if (!buckets) return NULL;
+    while (buckets & (buckets - 1)) buckets &= buckets - 1;
+
+    TTable *tt = (TTable *) calloc(1, sizeof(TTable));
+    if (!tt) return NULL;
+
+    tt->size = buckets * sizeof(TTableBucket);
+    tt->buckets = mmap(NULL, tt->size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (tt->buckets == MAP_FAILED) {
+        free(tt);
+        return NULL;
+    }
+#ifdef MADV_HUGEPAGE
+    madvise(tt->buckets, tt->size, MADV_HUGEPAGE);
+#endif
+
+    tt->mask = buckets - 1;
+    return tt;
+}
+
+/**
+ * Unmap the table and deallocate TTable structure.
+ *
+ * @param   tt      Pointer to TTable structure.
+**/
+void            ttable_delete(TTable *tt) {
+    if (!tt) return;
+    munmap(tt->buckets, tt->size);
+    free(tt);
+}
+
+/**
+ * Forget every stored position (not thread safe; call between searches).
+ *
+ * @param   tt      Pointer to TTable structure.
+**/
+void            ttable_clear(TTable *tt) {
+    memset(tt->buckets, 0, tt->size);
+    tt->age = 0;
+}
+
+/**
+ * Start a new generation so entries from earlier searches are replaced first.
+ *
+ * @param   tt      Pointer to TTable structure.
+**/
+void            ttable_new_search(TTable *tt) {
+    tt->age = (tt->age + 1) & TTABLE_AGE_MASK;
+}
+
+/**
+ * Look up a position.
+ *
+ * @param   tt      Pointer to TTable structure.
+ * @param   key     Zobrist key of the position.
+ * @param   hit     Pointer to TTableHit structure to populate.
+ *
+ * @return  `true` if the position was found, `false` otherwise.
+**/
+bool            ttable_probe(TTable *tt, uint64_t key, TTableHit *hit) {
+
+    TTableBucket *bucket = &tt->buckets[key & tt->mask];
+    for (size_t i = 0; i < TTABLE_BUCKET_SIZE; i++) {
+        TTableEntry *entry = &bucket->entries[i];
+        uint64_t data = atomic_load_explicit(&entry->data, memory_order_relaxed);
+        uint64_t check = atomic_load_explicit(&entry->check, memory_order_relaxed);
+        if ((check ^ data) != key || !data) continue;
+
+        hit->move = (ChessMove)data;
+        hit->score = (int16_t)(data >> 16);
+        hit->depth = ttable_data_depth(data);
+        hit->bound = (data >> 40) & 0x3;
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * Store a search result, replacing the same position or else the entry of
+ * the bucket with the lowest depth (older generations count as shallower).
+ *
+ * @param   tt      Pointer to TTable structure.
+ * @param   key     Zobrist key of the position.
+ * @param   move    Best move found (or 0).
+ * @param   score   Score to store (mate scores already made relative to the node).
+ * @param   depth   Depth the score was searched to.
+ * @param   bound   TTABLE_UPPER, TTABLE_LOWER or TTABLE_EXACT.
+**/
+void            ttable_store(TTable *tt, uint64_t key, ChessMove move, int score, uint8_t depth, uint8_t bound) {
+
+    TTableBucket *bucket = &tt->buckets[key & tt->mask];
+    TTableEntry *replace = NULL;
+    int replace_value = 0;
+
+    for (size_t i = 0; i < TTABLE_BUCKET_SIZE; i++) {
+        TTableEntry *entry = &bucket->entries[i];
+        uint64_t data = atomic_load_explicit(&entry->data, memory_order_relaxed);
+        uint64_t check = atomic_load_explicit(&entry->check, memory_order_relaxed);
+
+        if ((check ^ data) == key) {
+            // Keep the old best move when the new result has none
+            if (!move) move = (ChessMove)data;
+            replace = entry;
+            break;
+        }
+
+        int age = (tt->age - ttable_data_age(data)) & TTABLE_AGE_MASK;
+        int value = ttable_data_depth(data) - 8 * age;
+        if (!replace || value < replace_value) {
+            replace = entry;
+            replace_value = value;
+        }
+    }
+
+    // A torn write from another thread simply fails the XOR check on probe
+    uint64_t data = ttable_pack(move, score, depth, bound, tt->age);
+    atomic_store_explicit(&replace->data, data, memory_order_relaxed);
+    atomic_store_explicit(&replace->check, key ^ data, memory_order_relaxed);
+}
+
+/**
+ * Pull the bucket of a position into cache ahead of a probe.
+ *
+ * Matches ChessPrefetchFunc so it can be installed with chessboard_set_prefetch.
+ *
+ * @param   tt      Pointer to TTable structure.
+ * @param   key     Zobrist key of the position.
+**/
+void            ttable_prefetch(void *tt, uint64_t key) {
+    TTable *table = (TTable *) tt;
+    __builtin_prefetch(&table->buckets[key & table->mask]);
+}
+
+/**
+ * Estimate table occupancy from the first thousand entries.
+ *
+ * @param   tt      Pointer to TTable structure.
+ *
+ * @return  Permille of sampled entries written during the current generation.
+**/
+size_t          ttable_hashfull(TTable *tt) {
+
+    size_t used = 0, sampled = 0;
+    for (size_t b = 0; b <= tt->mask && sampled < 1000; b++) {
+        for (size_t i = 0; i < TTABLE_BUCKET_SIZE && sampled < 1000; i++, sampled++) {
+            uint64_t data = atomic_load_explicit(&tt->buckets[b].entries[i].data, memory_order_relaxed);
+            if (data && ttable_data_age(data) == tt->age) used++;
+        }
+    }
+
+    return (sampled) ? used * 1000 / sampled : 0;
+}
@@ -0,0 +1,385 @@
+/* libchess
+ * Jack O'Connor 2025
+ * src/uci.c
+ */
+
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+
+#include "chessboard.h"
+#include "search.h"
+#include "ttable.h"
+
+
+/* Constants */
+
+#define UCI_NAME            "libchess"
+#define UCI_AUTHOR          "Jack O'Connor"
+
+#define UCI_HASH_DEFAULT    (16)
+#define UCI_HASH_MAX        (65536)
+#define UCI_THREADS_MAX     (256)
+
+#define UCI_MOVES_TO_GO     (30)        // Assumed moves left when the GUI does not say
+#define UCI_MOVE_OVERHEAD   (50)        // Milliseconds kept back for communication
+
+
+/* Types */
+
+typedef struct { // Keys of the positions a move list passed through, oldest first
+    uint64_t       *keys;
+    size_t          count;
+    size_t          capacity;
+} UciHistory;
+
+typedef struct {
+    ChessBoard     *board;              // Position set by the last "position" command
+    UciHistory      history;            // Positions before it
+    TTable         *tt;
+    size_t          hash_mb;
+    size_t          threads;
+
+    pthread_t       thread;
+    bool            searching;          // A search thread exists and has not been joined
+    bool            infinite;           // Hold bestmove until "stop"
+    atomic_bool     stop;
+    ChessBoard      search_board;       // Copy owned by the search thread
+    SearchLimits    limits;
+
+    pthread_mutex_t output;             // Serializes lines from both threads
+} Uci;
+
+
+/* Functions */
+
+/**
+ * Write one line to stdout without interleaving with the other thread.
+ *
+ * @param   uci     Pointer to Uci structure.
+ * @param   format  printf format string.
+**/
+void    uci_send(Uci *uci, const char *format, ...) {
+
+    va_list args;
+    va_start(args, format);
+    pthread_mutex_lock(&uci->output);
+    vfprintf(stdout, format, args);
+    fputc('\n', stdout);
+    fflush(stdout);
+    pthread_mutex_unlock(&uci->output);
+    va_end(args);
+}
+
+/**
+ * Report a completed iteration as an "info" line.
+ *
+ * @param   info    Pointer to SearchResult structure of the iteration.
+ * @param   arg     Pointer to Uci structure.
+**/
+void    uci_info(const SearchResult *info, void *arg) {
+
+    Uci *uci = (Uci *) arg;
+
+    char score[32];
+    if (search_is_mate(info->score)) {
+        int moves = (info->score > 0) ? (SEARCH_MATE - info->score + 1) / 2 : -(SEARCH_MATE + info->score) / 2;
+        snprintf(score, sizeof(score), "mate %d", moves);
+    } else {
+        snprintf(score, sizeof(score), "cp %d", info->score);
+    }
+
+    char pv[SEARCH_MAX_PLY * 6 + 1] = "";
+    char *p = pv;
+    for (size_t i = 0; i < info->pv_length; i++) {
+        if (i) *(p++) = ' ';
+        chessmove_to_string(info->pv[i], p);
+        p += strlen(p);
+    }
+
+    uci_send(uci, "info depth %lu score %s nodes %lu nps %.0f time %.0f hashfull %lu pv %s",
+             info->depth, score, info->nodes, info->nps, info->seconds * 1000,
+             (uci->tt) ? ttable_hashfull(uci->tt) : 0, pv);
+}
+
+/**
+ * Search thread main function: search, then report the best move.
+ *
+ * @param   arg     Pointer to Uci structure.
+ *
+ * @return  NULL.
+**/
+void *  uci_search_main(void *arg) {
+
+    Uci *uci = (Uci *) arg;
+    SearchResult result;
+    chessboard_search(&uci->search_board, &uci->limits, &result);
+
+    // "go infinite" must not answer before "stop"
+    struct timespec pause = { 0, 1000000 };
+    while (uci->infinite && !atomic_load(&uci->stop)) nanosleep(&pause, NULL);
+
+    char best[6] = "0000";
+    if (result.pv_length) chessmove_to_string(result.pv[0], best);
+    if (result.pv_length > 1) {
+        char ponder[6];
+        chessmove_to_string(result.pv[1], ponder);
+        uci_send(uci, "bestmove %s ponder %s", best, ponder);
+    } else {
+        uci_send(uci, "bestmove %s", best);
+    }
+
+    return NULL;
+}
+
+/**
+ * Stop a running search (if any) and wait for its thread.
+ *
+ * @param   uci     Pointer to Uci structure.
+**/
+void    uci_stop(Uci *uci) {
+
+    if (!uci->searching) return;
+    atomic_store(&uci->stop, true);
+    pthread_join(uci->thread, NULL);
+    uci->searching = false;
+}
+
+/**
+ * Append a position key to a game history.
+ *
+ * @param   history Pointer to UciHistory structure.
+ * @param   key     Zobrist key of the position being left.
+ *
+ * @return  `true` if successful, `false` otherwise.
+**/
+bool    uci_history_push(UciHistory *history, uint64_t key) {
+
+    if (history->count == history->capacity) {
+        size_t capacity = (history->capacity) ? history->capacity * 2 : 256;
+        uint64_t *keys = (uint64_t *) realloc(history->keys, capacity * sizeof(uint64_t));
+        if (!keys) return false;
+        history->keys = keys;
+        history->capacity = capacity;
+    }
+
+    history->keys[history->count++] = key;
+    return true;
+}
+
+/**
+ * Handle "position [startpos | fen FEN] [moves MOVE...]". The moves are
+ * played on a scratch board, so an illegal one keeps the previous position.
+ *
+ * @param   uci     Pointer to Uci structure.
+ * @param   args    Text after the command word.
+**/
+void    uci_position(Uci *uci, char *args) {
+
+    char *moves = strstr(args, "moves");
+    if (moves) *(moves - 1) = '\0';
+
+    const char *fen = NULL;
+    if (!strncmp(args, "fen ", 4)) fen = args + 4;
+    else if (strncmp(args, "startpos", 8)) return;
+
+    ChessBoard *board = chessboard_create(fen);
+    if (!board) return;
+
+    UciHistory history = { 0 };
+    char *word = (moves) ? strtok(moves + 5, " \t\n") : NULL;
+    for (; word; word = strtok(NULL, " \t\n")) {
+        ChessMove move;
+        if (!chessboard_move_from_string(board, word, &move)) {
+            uci_send(uci, "info string illegal move %s", word);
+            break;
+        }
+        if (!uci_history_push(&history, board->key)) {
+            uci_send(uci, "info string unable to allocate history");
+            break;
+        }
+        chessboard_make_move(board, move);
+    }
+
+    if (word) {
+        chessboard_delete(board);
+        free(history.keys);
+        return;
+    }
+
+    chessboard_delete(uci->board);
+    free(uci->history.keys);
+    uci->board = board;
+    uci->history = history;
+}
+
+/**
+ * Handle "go" and start the search thread.
+ *
+ * @param   uci     Pointer to Uci structure.
+ * @param   args    Text after the command word.
+**/
+void    uci_go(Uci *uci, char *args) {
+
+    long wtime = -1, btime = -1, winc = 0, binc = 0, movestogo = 0, movetime = 0;
+    size_t depth = 0, nodes = 0;
+    bool infinite = false;
+
+    for (char *word = strtok(args, " \t\n"); word; word = strtok(NULL, " \t\n")) {
+        char *value = NULL;
+        if (strcmp(word, "infinite") && strcmp(word, "ponder")) value = strtok(NULL, " \t\n");
+
+        if (!strcmp(word, "infinite"))          infinite = true;
+        else if (!value)                        break;
+        else if (!strcmp(word, "depth"))        depth = strtoul(value, NULL, 10);
+        else if (!strcmp(word, "nodes"))        nodes = strtoul(value, NULL, 10);
+        else if (!strcmp(word, "movetime"))     movetime = atol(value);
+        else if (!strcmp(word, "wtime"))        wtime = atol(value);
+        else if (!strcmp(word, "btime"))        btime = atol(value);
+        else if (!strcmp(word, "winc"))         winc = atol(value);
+        else if (!strcmp(word, "binc"))         binc = atol(value);
+        else if (!strcmp(word, "movestogo"))    movestogo = atol(value);
+    }
+
+    // Spend an even share of the remaining clock plus most of the increment
+    double seconds = 0;
+    long time = (uci->board->to_move == WHITE) ? wtime : btime;
+    long increment = (uci->board->to_move == WHITE) ? winc : binc;
+    if (movetime > 0) {
+        seconds = movetime / 1000.0;
+    } else if (time >= 0) {
+        long budget = time / ((movestogo > 0) ? movestogo : UCI_MOVES_TO_GO) + increment * 3 / 4;
+        if (budget > time - UCI_MOVE_OVERHEAD) budget = time - UCI_MOVE_OVERHEAD;
+        if (budget < 1) budget = 1;
+        seconds = budget / 1000.0;
+    }
+
+    atomic_store(&uci->stop, false);
+    uci->infinite = infinite;
+    uci->search_board = *uci->board;
+    uci->limits = (SearchLimits){
+        .depth          = depth,
+        .nodes          = nodes,
+        .seconds        = (infinite) ? 0 : seconds,
+        .threads        = uci->threads,
+        .tt             = uci->tt,
+        .stop           = &uci->stop,
+        .info           = uci_info,
+        .info_arg       = uci,
+        .history        = uci->history.keys,
+        .history_count  = uci->history.count,
+    };
+
+    if (pthread_create(&uci->thread, NULL, uci_search_main, uci)) {
+        uci_send(uci, "bestmove 0000");
+        return;
+    }
+    uci->searching = true;
+}
+
+/**
+ * Handle "setoption name NAME value VALUE".
+ *
+ * @param   uci     Pointer to Uci structure.
+ * @param   args    Text after the command word.
+**/
+void    uci_setoption(Uci *uci, char *args) {
+
+    char *name = strstr(args, "name ");
+    char *value = strstr(args, " value ");
+    if (!name || !value) return;
+    name += 5;
+    *value = '\0';
+    value += 7;
+
+    if (!strcasecmp(name, "Hash")) {
+        size_t hash_mb = strtoul(value, NULL, 10);
+        if (hash_mb < 1 || hash_mb > UCI_HASH_MAX) return;
+
+        TTable *tt = ttable_create(hash_mb);
+        if (!tt) {
+            uci_send(uci, "info string unable to allocate %lu MB hash", hash_mb);
+            return;
+        }
+        ttable_delete(uci->tt);
+        uci->tt = tt;
+        uci->hash_mb = hash_mb;
+    } else if (!strcasecmp(name, "Threads")) {
+        size_t threads = strtoul(value, NULL, 10);
+        if (threads >= 1 && threads <= UCI_THREADS_MAX) uci->threads = threads;
+    }
+}
+
+
+/* Main Execution */
+
+int main(int argc, char *argv[]) {
+
+    Uci uci = {
+        .board      = chessboard_create(NULL),
+        .tt         = ttable_create(UCI_HASH_DEFAULT),
+        .hash_mb    = UCI_HASH_DEFAULT,
+        .threads    = 1,
+    };
+    pthread_mutex_init(&uci.output, NULL);
+    if (!uci.board || !uci.tt) {
+        fprintf(stderr, "Unable to initialize engine\n");
+        return EXIT_FAILURE;
+    }
+
+    char line[BUFSIZ * 16];
+    while (fgets(line, sizeof(line), stdin)) {
+        line[strcspn(line, "\r\n")] = '\0';
+
+        char *args = line + strcspn(line, " \t");
+        if (*args) *(args++) = '\0';
+        args += strspn(args, " \t");
+
+        if (!strcmp(line, "uci")) {
+            uci_send(&uci, "id name " UCI_NAME);
+            uci_send(&uci, "id author " UCI_AUTHOR);
+            uci_send(&uci, "option name Hash type spin default %d min 1 max %d", UCI_HASH_DEFAULT, UCI_HASH_MAX);
+            uci_send(&uci, "option name Threads type spin default 1 min 1 max %d", UCI_THREADS_MAX);
+            uci_send(&uci, "uciok");
+        } else if (!strcmp(line, "isready")) {
+            uci_send(&uci, "readyok");
+        } else if (!strcmp(line, "ucinewgame")) {
+            uci_stop(&uci);
+            ttable_clear(uci.tt);
+        } else if (!strcmp(line, "setoption")) {
+            uci_stop(&uci);
+            uci_setoption(&uci, args);
+        } else if (!strcmp(line, "position")) {
+            uci_stop(&uci);
+            uci_position(&uci, args);
+        } else if (!strcmp(line, "go")) {
+            uci_stop(&uci);
+            uci_go(&uci, args);
+        } else if (!strcmp(line, "stop")) {
+            uci_stop(&uci);
+        } else if (!strcmp(line, "d")) {
+            char *fen = chessboard_to_fen(uci.board);
+            pthread_mutex_lock(&uci.output);
+            chessboard_dump(uci.board, stdout);
+            fprintf(stdout, "Fen: %s\n", fen);
+            fflush(stdout);
+            pthread_mutex_unlock(&uci.output);
+            free(fen);
+        } else if (!strcmp(line, "quit")) {
+            break;
+        }
+    }
+
+    uci_stop(&uci);
+    chessboard_delete(uci.board);
+    free(uci.history.keys);
+    ttable_delete(uci.tt);
+    pthread_mutex_destroy(&uci.output);
+    return EXIT_SUCCESS;
+}
@@ -1,109 +1,1643 @@
-/* libchess
- * Jack O'Connor 2025
- * tests/unit_chess.c
- */
-
-#include <stdbool.h>
-#include <stdio.h>
-#include <stdlib.h>
-
-#include "chessboard.h"
-
-
-/* Constants */
-
-// https://en.wikipedia.org/wiki/Shannon_number
-const size_t SHANNON[][2] = {
-    {1,     20},
-    {2,     400},
-    {3,     8902},
-    {4,     197281},
-    {5,     4865609},
-    // {6,     119060324},
-    // {7,     3195901860},
-    // {8,     84998978956},
-    // {9,     2439530234167},
-    // {10,   69352859712417},
-    // {11,   2097651003696806},
-    // {12,   62854969236701747},
-    // {13,   1981066775000396239},
-    // {14,   61885021521585529237},
-    // {15,   2015099950053364471960}
-};
-
-const char * KIWIPETE_FEN = "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq -";
-const size_t KIWIPETE[][2] = {
-    {1,		48},
-    {2,		2039},
-    {3,		97862},
-    {4,		4085603},
-    {5,		193690690},
-    {6,		8031647685}
-};
-
-
-/* Unit Tests */
-
-bool    test_01_perft_results() {
-    
-    fprintf(stdout, "Testing perft results...\n");
-
-    bool success = true;
-    fprintf(stdout, "Default initial positions...\n");
-    for (size_t i = 0; i < sizeof(SHANNON) / sizeof(SHANNON[0]); i++) {
-        size_t ply = SHANNON[i][0];
-        size_t target = SHANNON[i][1];
-
-        ChessBoard *cb = chessboard_create(NULL);
-        // size_t position_count = chessboard_count_moves(cb, WHITE, ply);
-        // size_t difference = (target > position_count) ? 
-        //     target - position_count : position_count - target;
-        // if (difference) success = false;
-
-        // fprintf(stdout, "[%c] (Ply=%2lu) Target=%10lu | Actual=%10lu",
-        //         (difference) ? 'X' : '.', ply, target, position_count);
-        // if (difference) fprintf(stdout, " (off by %lu)", difference);
-        // fprintf(stdout, "\n");
-
-        // success = success && !difference;
-        // if (!success) break;
-    }
-
-    fprintf(stdout, "\nKiwipete initial position...(%s)\n", KIWIPETE_FEN);
-    for (size_t i = 0; i < sizeof(KIWIPETE) / sizeof(KIWIPETE[0]); i++) {
-        size_t ply = KIWIPETE[i][0];
-        size_t target = KIWIPETE[i][1];
-
-        ChessBoard *cb = chessboard_create(KIWIPETE_FEN);
-        // size_t position_count = chessboard_count_moves(cb, WHITE, ply);
-        // size_t difference = (target > position_count) ? 
-        //     target - position_count : position_count - target;
-        // if (difference) success = false;
-
-        // fprintf(stdout, "[%c] (Ply=%2lu) Target=%10lu | Actual=%10lu",
-        //         (difference) ? 'X' : '.', ply, target, position_count);
-        // if (difference) fprintf(stdout, " (off by %lu)", difference);
-        // fprintf(stdout, "\n");
-
-        // success = success && !difference;
-        // if (!success) break;
-        
-    }
-
-
-    return success;
-}
-
-
-
-/* Main Execution */
-
-int main(int argc, char *argv[]) {
-
-    int failures = 0;
-
-    failures += test_01_perft_results() ? 0 : 1;
-
-    return EXIT_SUCCESS;
-}
-
+/* libchess
+ * Jack O'Connor 2025
+ * tests/unit_chess.c
+ */
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "arena.h"
+#include "archive.h"
+#include "chess.h"
+#include "chessboard.h"
+#include "epd.h"
+#include "list.h"
+#include "magic.h"
+#include "perft.h"
+#include "pgn.h"
+#include "pgn_pipeline.h"
+#include "position.h"
+#include "search.h"
+#include "tables.h"
+#include "threadpool.h"
+#include "ttable.h"
+#include "zobrist.h"
+
+
+/* Constants */
+
+// Perft expectations, one position per line: FEN ;D1 n ;D2 n ...
+#define PERFT_EPD_PATH      "tests/perft.epd"
+#define PERFT_EPD_MAX_DEPTH (16)
+#define PERFT_BUDGET        (0.5)   // Seconds per position unless PERFT_BUDGET is set
+
+#define PGN_SAMPLE_PATH     "tests/sample.pgn"
+#define UCI_PATH            "bin/uci"
+
+const char * KIWIPETE_FEN = "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq -";
+// Pins, en passant discovered checks, castling and promotion edge cases
+const struct {
+    const char *fen;
+    size_t      ply;
+    size_t      nodes;
+} TRICKY[] = {
+    {"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",                                  5, 674624},
+    {"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",           4, 422333},
+    {"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",                  3, 62379},
+    {"r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",   3, 89890},
+    {"3k4/3p4/8/K1P4r/8/8/8/8 b - - 0 1",                                          6, 1134888},
+    {"8/8/1k6/2b5/2pP4/8/5K2/8 b - d3 0 1",                                        6, 1440467},
+    {"r3k2r/1b4bq/8/8/8/8/7B/R3K2R w KQkq - 0 1",                                  4, 1274206},
+    {"2K2r2/4P3/8/8/8/8/8/3k4 w - - 0 1",                                          6, 3821001},
+};
+
+// {FEN, from, to, promotion, FEN after move}
+const struct {
+    const char *fen;
+    uint8_t     from;
+    uint8_t     to;
+    ChessPiece  promotion;
+    const char *expected;
+} SPECIAL_MOVES[] = {
+    {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 4, 6, 0,
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R4RK1 b kq - 1 1"},
+    {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 4, 2, 0,
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/2KR3R b kq - 1 1"},
+    {"r3k2r/8/8/8/8/8/8/R3K2R b KQkq - 0 1", 60, 58, 0,
+        "2kr3r/8/8/8/8/8/8/R3K2R w KQ - 1 2"},
+    {"rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3", 36, 45, 0,
+        "rnbqkbnr/ppp1p1pp/5P2/3p4/8/8/PPPP1PPP/RNBQKBNR b KQkq - 0 3"},
+    {"r3k3/1P6/8/8/8/8/8/4K3 w q - 0 1", 49, 56, QUEEN,
+        "Q3k3/8/8/8/8/8/8/4K3 b - - 0 1"},
+};
+
+
+/* Types */
+
+typedef struct { // One EPD line and what running it produced
+    const char *fen;
+    ChessBoard *board;                              // Parsed by epd_load
+    size_t      expected[PERFT_EPD_MAX_DEPTH + 1];  // 0 where the file gives no count
+    size_t      nodes[PERFT_EPD_MAX_DEPTH + 1];
+    double      seconds[PERFT_EPD_MAX_DEPTH + 1];
+    bool        ran[PERFT_EPD_MAX_DEPTH + 1];
+    double      budget;
+} PerftCase;
+
+typedef struct { // Write callback target of the PGN pipeline test
+    PgnRecord  *records;
+    size_t      capacity;
+    size_t      count;
+    bool        ordered;
+} PgnRecordLog;
+
+typedef struct { // Info callback target that raises a stop flag mid-search
+    atomic_bool    *stop;
+    size_t          depth;                          // Raise once an iteration this deep completes
+    struct timespec raised;
+} SearchStopper;
+
+
+/* Helper Functions */
+
+bool    walk_make_unmake(ChessBoard *cb, size_t depth) {
+
+    if (depth == 0) return true;
+
+    ChessMove moves[MAX_MOVES];
+    size_t moves_count = chessboard_pseudolegal_moves(cb, moves);
+    for (size_t i = 0; i < moves_count; i++) {
+        ChessBoard before = *cb;
+        ChessUndo undo;
+        if (!chessboard_make_move_with(cb, moves[i], &undo)) return false;
+        if (!walk_make_unmake(cb, depth - 1)) return false;
+        if (!chessboard_unmake_move_with(cb, moves[i], &undo)) return false;
+        if (memcmp(&before, cb, sizeof(ChessBoard))) return false;
+    }
+
+    return true;
+}
+
+bool    walk_zobrist(ChessBoard *cb, size_t depth) {
+
+    if (cb->key != chessboard_compute_key(cb)) return false;
+    if (depth == 0) return true;
+
+    ChessMove moves[MAX_MOVES];
+    size_t moves_count = chessboard_pseudolegal_moves(cb, moves);
+    for (size_t i = 0; i < moves_count; i++) {
+        uint64_t key = cb->key;
+        ChessUndo undo;
+        chessboard_make_move_with(cb, moves[i], &undo);
+        if (!walk_zobrist(cb, depth - 1)) return false;
+        chessboard_unmake_move_with(cb, moves[i], &undo);
+        if (cb->key != key) return false;
+    }
+
+    return true;
+}
+
+bool    walk_count(ChessBoard *cb, size_t depth) {
+
+    ChessMove moves[MAX_MOVES];
+    size_t moves_count = chessboard_legal_moves(cb, moves);
+    if (chessboard_count_legal_moves(cb) != moves_count) return false;
+    if (depth == 0) return true;
+
+    ChessUndo undo;
+    for (size_t i = 0; i < moves_count; i++) {
+        chessboard_make_move_with(cb, moves[i], &undo);
+        if (!walk_count(cb, depth - 1)) return false;
+        chessboard_unmake_move_with(cb, moves[i], &undo);
+    }
+
+    return true;
+}
+
+bool    walk_targets(ChessBoard *cb, size_t depth) {
+
+    char *fen = chessboard_to_fen(cb);
+    ChessBoard *fresh = chessboard_create(fen);
+    bool match = !memcmp(cb->targets, fresh->targets, sizeof(cb->targets));
+    chessboard_delete(fresh);
+    free(fen);
+
+    if (!match) return false;
+    if (depth == 0) return true;
+
+    ChessMove moves[MAX_MOVES];
+    size_t moves_count = chessboard_legal_moves(cb, moves);
+    ChessUndo undo;
+    for (size_t i = 0; i < moves_count; i++) {
+        chessboard_make_move_with(cb, moves[i], &undo);
+        if (!walk_targets(cb, depth - 1)) return false;
+        chessboard_unmake_move_with(cb, moves[i], &undo);
+    }
+
+    return true;
+}
+
+size_t  perft_pseudolegal(ChessBoard *cb, size_t depth) {
+
+    if (depth == 0) return 1;
+
+    ChessMove moves[MAX_MOVES];
+    size_t moves_count = chessboard_pseudolegal_moves(cb, moves);
+
+    size_t nodes = 0;
+    ChessPiece color = cb->to_move;
+    ChessUndo undo;
+    for (size_t i = 0; i < moves_count; i++) {
+        chessboard_make_move_with(cb, moves[i], &undo);
+        if (!chessboard_in_check(cb, color)) nodes += perft_pseudolegal(cb, depth - 1);
+        chessboard_unmake_move_with(cb, moves[i], &undo);
+    }
+
+    return nodes;
+}
+
+
+bool    walk_position(ChessBoard *cb, const Position *pos, size_t depth) {
+
+    Position expected;
+    position_from_chessboard(&expected, cb);
+    if (memcmp(&expected, pos, offsetof(Position, castle) + 1)) return false;
+    if (depth == 0) return true;
+
+    ChessMove moves[MAX_MOVES], position_moves[MAX_MOVES];
+    size_t moves_count = chessboard_legal_moves(cb, moves);
+    if (position_legal_moves(pos, position_moves) != moves_count) return false;
+    ChessUndo undo;
+    for (size_t i = 0; i < moves_count; i++) {
+        Position child = *pos;
+        position_make_move(&child, moves[i]);
+        chessboard_make_move_with(cb, moves[i], &undo);
+        bool match = walk_position(cb, &child, depth - 1);
+        chessboard_unmake_move_with(cb, moves[i], &undo);
+        if (!match) return false;
+    }
+
+    return true;
+}
+
+
+PerftCase * load_perft_cases(const EpdFile *epd) {
+
+    PerftCase *cases = (PerftCase *) calloc(epd->count, sizeof(PerftCase));
+    if (!cases) return NULL;
+
+    for (size_t i = 0; i < epd->count; i++) {
+        PerftCase *pc = &cases[i];
+        pc->fen = epd->fens[i];
+        pc->board = &epd->boards[i];
+
+        for (const char *field = strchr(epd->operations[i], ';'); field; field = strchr(field + 1, ';')) {
+            size_t depth, nodes;
+            if (sscanf(field + 1, " D%lu %lu", &depth, &nodes) == 2 && depth <= PERFT_EPD_MAX_DEPTH) {
+                pc->expected[depth] = nodes;
+            }
+        }
+    }
+
+    return cases;
+}
+
+/**
+ * Run one EPD position from its shallowest listed depth upward, stopping at
+ * the first depth projected to overrun the position's budget. The projection
+ * scales the last run by the ratio of expected node counts.
+ *
+ * @param   arg     Pointer to PerftCase structure.
+**/
+void    perft_case_task(void *arg) {
+
+    PerftCase *pc = (PerftCase *) arg;
+    ChessBoard *cb = pc->board;
+
+    double spent = 0;
+    size_t last = 0;
+    for (size_t depth = 1; depth <= PERFT_EPD_MAX_DEPTH; depth++) {
+        if (!pc->expected[depth]) continue;
+        if (last && spent + pc->seconds[last] * pc->expected[depth] / pc->expected[last] > pc->budget) break;
+
+        struct timespec start, stop;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        pc->nodes[depth] = chessboard_perft(cb, depth);
+        clock_gettime(CLOCK_MONOTONIC, &stop);
+
+        pc->seconds[depth] = (stop.tv_sec - start.tv_sec) + (stop.tv_nsec - start.tv_nsec) / 1e9;
+        pc->ran[depth] = true;
+        spent += pc->seconds[depth];
+        last = depth;
+    }
+}
+
+
+void    record_game(const PgnRecord *record, void *arg) {
+
+    PgnRecordLog *log = (PgnRecordLog *) arg;
+    log->ordered = log->ordered && record->index == log->count;
+    if (log->count < log->capacity) log->records[log->count] = *record;
+    log->count++;
+}
+
+
+/* Unit Tests */
+
+bool    test_01_perft_results() {
+
+    const char *path = (getenv("PERFT_EPD")) ? getenv("PERFT_EPD") : PERFT_EPD_PATH;
+    double budget = (getenv("PERFT_BUDGET")) ? strtod(getenv("PERFT_BUDGET"), NULL) : PERFT_BUDGET;
+
+    fprintf(stdout, "Testing perft results (%s, %.1fs per position)...\n", path, budget);
+
+    EpdFile *epd = epd_load(path);
+    PerftCase *cases = (epd) ? load_perft_cases(epd) : NULL;
+    ThreadPool *pool = threadpool_create(0);
+    if (!cases || !pool) {
+        fprintf(stdout, "[X] Unable to load %s\n", path);
+        free(cases);
+        epd_delete(epd);
+        threadpool_delete(pool);
+        return false;
+    }
+    size_t count = epd->count;
+
+    // One task per position; each walks its own depths serially
+    struct timespec start, stop;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (size_t i = 0; i < count; i++) {
+        cases[i].budget = budget;
+        if (!threadpool_submit(pool, perft_case_task, &cases[i])) perft_case_task(&cases[i]);
+    }
+    threadpool_wait(pool);
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    double wall = (stop.tv_sec - start.tv_sec) + (stop.tv_nsec - start.tv_nsec) / 1e9;
+
+    bool success = !epd->invalid;
+    size_t passed = 0, failed = epd->invalid, skipped = 0, nodes = 0;
+    if (epd->invalid) fprintf(stdout, "[X] %lu lines with an invalid FEN\n", epd->invalid);
+    for (size_t i = 0; i < count; i++) {
+        PerftCase *pc = &cases[i];
+        fprintf(stdout, "%s\n", pc->fen);
+
+        for (size_t depth = 1; depth <= PERFT_EPD_MAX_DEPTH; depth++) {
+            if (!pc->expected[depth]) continue;
+            if (!pc->ran[depth]) {
+                skipped++;
+                continue;
+            }
+
+            bool match = pc->nodes[depth] == pc->expected[depth];
+            success = success && match;
+            (match) ? passed++ : failed++;
+            nodes += pc->nodes[depth];
+
+            fprintf(stdout, "[%c] (Ply=%2lu) Target=%12lu | Actual=%12lu (%.3fs, %.0f nps)\n",
+                    (match) ? '.' : 'X', depth, pc->expected[depth], pc->nodes[depth], pc->seconds[depth],
+                    (pc->seconds[depth] > 0) ? pc->nodes[depth] / pc->seconds[depth] : 0);
+        }
+    }
+
+    fprintf(stdout, "%lu positions: %lu passed, %lu failed, %lu over budget | %lu nodes in %.3fs (%lu threads)\n",
+            count, passed, failed, skipped, nodes, wall, pool->workers_count);
+
+    free(cases);
+    epd_delete(epd);
+    threadpool_delete(pool);
+
+    return success;
+}
+
+bool    test_02_magic_attacks() {
+
+    fprintf(stdout, "Testing magic attack tables...\n");
+
+    bool success = true;
+    uint64_t seed = 0x9E3779B97F4A7C15lu;
+    for (uint8_t square = 0; square < 64; square++) {
+        for (size_t i = 0; i < 1000; i++) {
+            seed ^= seed >> 12;
+            seed ^= seed << 25;
+            seed ^= seed >> 27;
+            Bitboard occupancy = (seed * 2685821657736338717lu) & (seed * 0xD1B54A32D192ED03lu);
+
+            if (magic_bishop_attacks(square, occupancy) != magic_slow_attacks(square, occupancy, true)) success = false;
+            if (magic_rook_attacks(square, occupancy) != magic_slow_attacks(square, occupancy, false)) success = false;
+        }
+    }
+
+    fprintf(stdout, "[%c] Bishop and rook lookups match ray walk\n", (success) ? '.' : 'X');
+
+    return success;
+}
+
+bool    test_03_slider_modes() {
+
+    fprintf(stdout, "Testing slider generators...\n");
+
+    const char *fens[] = { NULL, KIWIPETE_FEN };
+    const size_t depth = 4;
+
+    bool success = true;
+    for (size_t i = 0; i < sizeof(fens) / sizeof(fens[0]); i++) {
+        ChessBoard *cb = chessboard_create(fens[i]);
+
+        size_t nodes[2];
+        double seconds[2];
+        enum ChessSliderMode modes[2] = { SLIDERS_RAYS, SLIDERS_MAGIC };
+        for (size_t m = 0; m < 2; m++) {
+            chessboard_set_slider_mode(modes[m]);
+
+            clock_t start = clock();
+            nodes[m] = chessboard_perft(cb, depth);
+            seconds[m] = (double)(clock() - start) / CLOCKS_PER_SEC;
+        }
+        chessboard_set_slider_mode(SLIDERS_MAGIC);
+
+        bool match = nodes[0] == nodes[1];
+        success = success && match;
+
+        fprintf(stdout, "[%c] (Ply=%2lu) Rays=%10lu (%.3fs) | Magic=%10lu (%.3fs)\n",
+                (match) ? '.' : 'X', depth, nodes[0], seconds[0], nodes[1], seconds[1]);
+
+        chessboard_delete(cb);
+    }
+
+    return success;
+}
+
+bool    test_04_make_unmake() {
+
+    fprintf(stdout, "Testing make/unmake...\n");
+
+    bool success = true;
+    for (size_t i = 0; i < sizeof(SPECIAL_MOVES) / sizeof(SPECIAL_MOVES[0]); i++) {
+        ChessBoard *cb = chessboard_create(SPECIAL_MOVES[i].fen);
+        ChessMove move = MOVE_CREATE(SPECIAL_MOVES[i].from, SPECIAL_MOVES[i].to, SPECIAL_MOVES[i].promotion);
+
+        ChessUndo undo;
+        chessboard_make_move_with(cb, move, &undo);
+        char *made = chessboard_to_fen(cb);
+        chessboard_unmake_move_with(cb, move, &undo);
+        char *unmade = chessboard_to_fen(cb);
+
+        bool match = !strcmp(made, SPECIAL_MOVES[i].expected) && !strcmp(unmade, SPECIAL_MOVES[i].fen);
+        success = success && match;
+
+        fprintf(stdout, "[%c] %s\n", (match) ? '.' : 'X', made);
+
+        free(made);
+        free(unmade);
+        chessboard_delete(cb);
+    }
+
+    ChessBoard *cb = chessboard_create(KIWIPETE_FEN);
+    bool restored = walk_make_unmake(cb, 3);
+    success = success && restored;
+    fprintf(stdout, "[%c] (Ply= 3) Kiwipete tree restored by unmake\n", (restored) ? '.' : 'X');
+    chessboard_delete(cb);
+
+    // The saved clock is as wide as the board's own
+    cb = chessboard_create("4k3/8/8/8/8/8/8/4K2R w K - 70000 90000");
+    ChessUndo undo;
+    ChessMove move = MOVE_CREATE(4, 5, 0);
+    chessboard_make_move_with(cb, move, &undo);
+    chessboard_unmake_move_with(cb, move, &undo);
+    bool wide = cb->halfmove_clock == 70000 && cb->castle_ability_w && cb->key == chessboard_compute_key(cb);
+    success = success && wide;
+    fprintf(stdout, "[%c] Halfmove clock %lu restored by unmake\n", (wide) ? '.' : 'X', cb->halfmove_clock);
+    chessboard_delete(cb);
+
+    return success;
+}
+
+bool    test_05_zobrist_keys() {
+
+    fprintf(stdout, "Testing Zobrist keys...\n");
+
+    bool success = true;
+    const char *fens[] = { NULL, KIWIPETE_FEN, SPECIAL_MOVES[3].fen, SPECIAL_MOVES[4].fen };
+    for (size_t i = 0; i < sizeof(fens) / sizeof(fens[0]); i++) {
+        ChessBoard *cb = chessboard_create(fens[i]);
+        bool match = walk_zobrist(cb, 3);
+        success = success && match;
+
+        fprintf(stdout, "[%c] (Ply= 3) Incremental key matches recomputed key (%016lx)\n",
+                (match) ? '.' : 'X', cb->key);
+        chessboard_delete(cb);
+    }
+
+    // 1. Nf3 Nf6 2. Nc3 and 1. Nc3 Nf6 2. Nf3 transpose
+    ChessMove order_a[] = { MOVE_CREATE(6, 21, 0), MOVE_CREATE(62, 45, 0), MOVE_CREATE(1, 18, 0) };
+    ChessMove order_b[] = { MOVE_CREATE(1, 18, 0), MOVE_CREATE(62, 45, 0), MOVE_CREATE(6, 21, 0) };
+    ChessBoard *a = chessboard_create(NULL);
+    ChessBoard *b = chessboard_create(NULL);
+    for (size_t i = 0; i < 3; i++) {
+        chessboard_make_move(a, order_a[i]);
+        chessboard_make_move(b, order_b[i]);
+    }
+
+    bool transposed = a->key == b->key;
+    chessboard_make_move(a, MOVE_CREATE(45, 62, 0));
+    chessboard_make_move(a, MOVE_CREATE(21, 6, 0));
+    bool side_differs = a->key != b->key;
+    success = success && transposed && side_differs;
+
+    fprintf(stdout, "[%c] Transposed move orders share a key\n", (transposed) ? '.' : 'X');
+    fprintf(stdout, "[%c] Side to move changes the key\n", (side_differs) ? '.' : 'X');
+
+    chessboard_delete(a);
+    chessboard_delete(b);
+
+    return success;
+}
+
+bool    test_06_parallel_perft() {
+
+    fprintf(stdout, "Testing parallel perft...\n");
+
+    const size_t depth = 4;
+    const size_t threads[] = { 1, 4 };
+
+    ChessBoard *cb = chessboard_create(KIWIPETE_FEN);
+    size_t expected = chessboard_perft(cb, depth);
+
+    bool success = true;
+    PerftResult *result = (PerftResult *) malloc(sizeof(PerftResult));
+    for (size_t i = 0; i < sizeof(threads) / sizeof(threads[0]); i++) {
+        bool match = perft_run(cb, depth, threads[i], NULL, result) && result->nodes == expected;
+
+        // Each divide entry must equal a serial count below that root move
+        for (size_t j = 0; match && j < result->moves_count; j++) {
+            ChessMove move = result->divide[j].move;
+            ChessUndo undo;
+            chessboard_make_move_with(cb, move, &undo);
+            match = chessboard_perft(cb, depth - 1) == result->divide[j].nodes;
+            chessboard_unmake_move_with(cb, move, &undo);
+        }
+        success = success && match;
+
+        fprintf(stdout, "[%c] (Ply=%2lu, Threads=%lu) Target=%10lu | Actual=%10lu (%.0f nps)\n",
+                (match) ? '.' : 'X', depth, threads[i], expected, result->nodes, result->nps);
+    }
+
+    free(result);
+    chessboard_delete(cb);
+
+    return success;
+}
+
+bool    test_07_hashed_perft() {
+
+    fprintf(stdout, "Testing hashed perft...\n");
+
+    const size_t depth = 5;
+    const size_t threads[] = { 1, 4 };
+
+    ChessBoard *cb = chessboard_create(NULL);
+    size_t expected = chessboard_perft(cb, depth);
+
+    bool success = true;
+    PerftResult *result = (PerftResult *) malloc(sizeof(PerftResult));
+    for (size_t i = 0; i < sizeof(threads) / sizeof(threads[0]); i++) {
+        PerftHash *hash = perft_hash_create(1);
+        if (!hash) {
+            fprintf(stdout, "[X] Unable to create hash table\n");
+            success = false;
+            continue;
+        }
+
+        bool match = perft_run(cb, depth, threads[i], hash, result) && result->nodes == expected;
+        match = match && atomic_load(&hash->hits) > 0;
+        success = success && match;
+
+        fprintf(stdout, "[%c] (Ply=%2lu, Threads=%lu) Target=%10lu | Actual=%10lu (%lu hits, %lu misses)\n",
+                (match) ? '.' : 'X', depth, threads[i], expected, result->nodes,
+                atomic_load(&hash->hits), atomic_load(&hash->misses));
+
+        perft_hash_delete(hash);
+    }
+
+    free(result);
+    chessboard_delete(cb);
+
+    return success;
+}
+
+bool    test_08_bulk_count() {
+
+    fprintf(stdout, "Testing bulk move counting...\n");
+
+    bool success = true;
+    const char *fens[] = { NULL, KIWIPETE_FEN, TRICKY[0].fen, TRICKY[1].fen, TRICKY[2].fen, TRICKY[5].fen };
+    for (size_t i = 0; i < sizeof(fens) / sizeof(fens[0]); i++) {
+        ChessBoard *cb = chessboard_create(fens[i]);
+        bool match = walk_count(cb, 3);
+        success = success && match;
+
+        fprintf(stdout, "[%c] (Ply= 3) Count matches generated list for %s\n",
+                (match) ? '.' : 'X', (fens[i]) ? fens[i] : "initial position");
+        chessboard_delete(cb);
+    }
+
+    const struct {
+        const char *name;
+        const char *fen;
+    } terminal[] = {
+        {"Checkmate", "rnb1kbnr/pppp1ppp/8/4p3/6Pq/5P2/PPPPP2P/RNBQKBNR w KQkq - 1 3"},
+        {"Stalemate", "7k/5Q2/6K1/8/8/8/8/8 b - - 0 1"},
+    };
+    for (size_t i = 0; i < sizeof(terminal) / sizeof(terminal[0]); i++) {
+        ChessBoard *cb = chessboard_create(terminal[i].fen);
+        size_t count = chessboard_count_legal_moves(cb);
+        success = success && !count;
+
+        fprintf(stdout, "[%c] %s has %lu legal moves\n", (count) ? 'X' : '.', terminal[i].name, count);
+        chessboard_delete(cb);
+    }
+
+    return success;
+}
+
+bool    test_09_pseudolegal_perft() {
+
+    fprintf(stdout, "Testing pseudolegal generation...\n");
+
+    bool success = true;
+    for (size_t i = 0; i < sizeof(TRICKY) / sizeof(TRICKY[0]); i++) {
+        size_t ply = (TRICKY[i].ply < 4) ? TRICKY[i].ply : 4;
+        ChessBoard *cb = chessboard_create(TRICKY[i].fen);
+        size_t target = chessboard_perft(cb, ply);
+        size_t position_count = perft_pseudolegal(cb, ply);
+        bool match = position_count == target;
+        chessboard_delete(cb);
+
+        fprintf(stdout, "[%c] (Ply=%2lu) Legal=%10lu | Pseudolegal=%10lu %s\n",
+                (match) ? '.' : 'X', ply, target, position_count, TRICKY[i].fen);
+
+        success = success && match;
+    }
+
+    return success;
+}
+
+bool    test_10_attack_maps() {
+
+    fprintf(stdout, "Testing attack maps...\n");
+
+    bool success = true;
+    const char *fens[] = { NULL, KIWIPETE_FEN, TRICKY[1].fen, TRICKY[6].fen, SPECIAL_MOVES[3].fen };
+    for (size_t i = 0; i < sizeof(fens) / sizeof(fens[0]); i++) {
+        ChessBoard *cb = chessboard_create(fens[i]);
+        bool match = walk_targets(cb, 3);
+        success = success && match;
+
+        fprintf(stdout, "[%c] (Ply= 3) Incremental maps match rebuilt maps for %s\n",
+                (match) ? '.' : 'X', (fens[i]) ? fens[i] : "initial position");
+        chessboard_delete(cb);
+    }
+
+    // Black's rook on e8 gives check down the open e-file
+    ChessBoard *cb = chessboard_create("4r1k1/8/8/8/8/8/8/4K3 w - - 0 1");
+    bool attacked = chessboard_in_check(cb, WHITE) && chessboard_square_attacked(cb, 20, BLACK) &&
+        !chessboard_square_attacked(cb, 19, BLACK);
+    success = success && attacked;
+    fprintf(stdout, "[%c] Rook on the open file attacks the king\n", (attacked) ? '.' : 'X');
+    chessboard_delete(cb);
+
+    return success;
+}
+
+void    count_iterations(const SearchResult *info, void *arg) {
+    (*(size_t *)arg)++;
+}
+
+bool    test_11_search() {
+
+    fprintf(stdout, "Testing search...\n");
+
+    const struct {
+        const char *name;
+        const char *fen;
+        size_t      depth;
+        ChessMove   best;
+        int         score;
+    } problems[] = {
+        {"Back rank mate in 1", "6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - 0 1", 2, MOVE_CREATE(3, 59, 0), SEARCH_MATE - 1},
+        {"Rook roller mate in 2", "1k6/8/8/8/8/8/R7/K6R w - - 0 1", 4, MOVE_CREATE(7, 55, 0), SEARCH_MATE - 3},
+        {"Win the hanging queen", "4k3/8/8/3q4/8/8/8/3RK3 w - - 0 1", 3, MOVE_CREATE(3, 35, 0), 0},
+        {"Stalemate is a draw", "7k/5Q2/6K1/8/8/8/8/8 b - - 0 1", 1, 0, 0},
+    };
+
+    bool success = true;
+    for (size_t i = 0; i < sizeof(problems) / sizeof(problems[0]); i++) {
+        ChessBoard *cb = chessboard_create(problems[i].fen);
+        uint64_t key = cb->key;
+        size_t iterations = 0;
+
+        SearchLimits limits = { .depth = problems[i].depth, .info = count_iterations, .info_arg = &iterations };
+        SearchResult result;
+        chessboard_search(cb, &limits, &result);
+
+        ChessMove best = (result.pv_length) ? result.pv[0] : 0;
+        bool match = best == problems[i].best && result.depth == problems[i].depth &&
+            iterations == problems[i].depth && cb->key == key;
+        if (problems[i].score) match = match && result.score == problems[i].score;
+        success = success && match;
+
+        char move[6] = "-";
+        if (best) chessmove_to_string(best, move);
+        fprintf(stdout, "[%c] (Depth=%2lu) %-26s best=%-5s score=%6d nodes=%lu\n",
+                (match) ? '.' : 'X', result.depth, problems[i].name, move, result.score, result.nodes);
+        chessboard_delete(cb);
+    }
+
+    // Node limits stop the search early with a usable move
+    ChessBoard *cb = chessboard_create(KIWIPETE_FEN);
+    SearchLimits limits = { .nodes = 20000 };
+    SearchResult result;
+    chessboard_search(cb, &limits, &result);
+    bool limited = result.nodes <= 20000 && result.pv_length && result.depth < SEARCH_MAX_PLY - 1;
+    success = success && limited;
+    fprintf(stdout, "[%c] Node limit respected (nodes=%lu, depth=%lu)\n", (limited) ? '.' : 'X', result.nodes, result.depth);
+    chessboard_delete(cb);
+
+    // A queen down, Kf1 repeats a position from the caller's game history
+    cb = chessboard_create("4k3/8/8/8/8/8/q7/4K3 w - - 10 40");
+    ChessBoard repeated = *cb;
+    chessboard_make_move(&repeated, MOVE_CREATE(4, 5, 0));
+    uint64_t history[] = { repeated.key };
+    limits = (SearchLimits){ .depth = 2, .history = history, .history_count = 1 };
+    chessboard_search(cb, &limits, &result);
+    bool repetition = result.pv_length && result.pv[0] == MOVE_CREATE(4, 5, 0) && result.score == 0;
+    success = success && repetition;
+    fprintf(stdout, "[%c] Repetition of a game position scores as a draw (score=%d)\n",
+            (repetition) ? '.' : 'X', result.score);
+    chessboard_delete(cb);
+
+    return success;
+}
+
+bool    test_12_transposition_table() {
+
+    fprintf(stdout, "Testing transposition table...\n");
+
+    bool success = true;
+    TTable *tt = ttable_create(1);
+    bool created = tt && sizeof(TTableBucket) == 64 && ((uintptr_t)tt->buckets & 63) == 0;
+    success = success && created;
+    fprintf(stdout, "[%c] 1MB table of 64-byte aligned buckets\n", (created) ? '.' : 'X');
+    if (!created) return false;
+
+    TTableHit hit;
+    ttable_store(tt, 0x1234567890abcdeflu, MOVE_CREATE(12, 28, 0), -250, 7, TTABLE_LOWER);
+    bool found = ttable_probe(tt, 0x1234567890abcdeflu, &hit) && hit.move == MOVE_CREATE(12, 28, 0) &&
+        hit.score == -250 && hit.depth == 7 && hit.bound == TTABLE_LOWER;
+    bool missing = !ttable_probe(tt, 0x1234567890abcdeflu ^ (1lu << 40), &hit);
+    success = success && found && missing;
+    fprintf(stdout, "[%c] Stored entry is found with its move, score, depth and bound\n", (found) ? '.' : 'X');
+    fprintf(stdout, "[%c] Different key in the same bucket misses\n", (missing) ? '.' : 'X');
+
+    // Five keys in one bucket: the shallowest entry is the one replaced
+    uint64_t base = 0x40;
+    for (uint64_t i = 0; i < 5; i++) ttable_store(tt, base + (i << 32), 0, 0, 10 - i, TTABLE_EXACT);
+    bool replaced = ttable_probe(tt, base, &hit) && !ttable_probe(tt, base + (3lu << 32), &hit) &&
+        ttable_probe(tt, base + (4lu << 32), &hit);
+    success = success && replaced;
+    fprintf(stdout, "[%c] Full bucket replaces its shallowest entry\n", (replaced) ? '.' : 'X');
+
+    // The table must cut the tree down without changing the mate found
+    ttable_clear(tt);
+    ChessBoard *cb = chessboard_create("1k6/8/8/8/8/8/R7/K6R w - - 0 1");
+    SearchLimits limits = { .depth = 5 };
+    SearchResult plain, hashed;
+    chessboard_search(cb, &limits, &plain);
+    limits.tt = tt;
+    chessboard_search(cb, &limits, &hashed);
+    bool smaller = hashed.nodes < plain.nodes && hashed.score == plain.score && !cb->prefetch;
+    success = success && smaller;
+    fprintf(stdout, "[%c] (Depth= 5) Search with table: %lu nodes (without: %lu), score %d\n",
+            (smaller) ? '.' : 'X', hashed.nodes, plain.nodes, hashed.score);
+    chessboard_delete(cb);
+
+    ttable_delete(tt);
+    return success;
+}
+
+void    stop_at_depth(const SearchResult *info, void *arg) {
+
+    SearchStopper *stopper = (SearchStopper *) arg;
+    if (info->depth < stopper->depth || atomic_load(stopper->stop)) return;
+    clock_gettime(CLOCK_MONOTONIC, &stopper->raised);
+    atomic_store(stopper->stop, true);
+}
+
+bool    test_13_lazy_smp() {
+
+    fprintf(stdout, "Testing Lazy SMP search...\n");
+
+    bool success = true;
+    for (size_t threads = 1; threads <= 4; threads *= 2) {
+        ChessBoard *cb = chessboard_create("1k6/8/8/8/8/8/R7/K6R w - - 0 1");
+        uint64_t key = cb->key;
+
+        SearchLimits limits = { .depth = 4, .threads = threads };
+        SearchResult result;
+        bool searched = chessboard_search(cb, &limits, &result);
+        bool match = searched && result.pv_length && result.pv[0] == MOVE_CREATE(7, 55, 0) &&
+            result.score == SEARCH_MATE - 3 && result.depth >= 4 && cb->key == key && !cb->prefetch;
+        success = success && match;
+
+        fprintf(stdout, "[%c] (Threads=%lu) Mate in 2 found at depth %lu with %lu nodes\n",
+                (match) ? '.' : 'X', threads, result.depth, result.nodes);
+        chessboard_delete(cb);
+    }
+
+    // An external stop flag raised mid-search ends every thread promptly
+    atomic_bool stop = false;
+    SearchStopper stopper = { .stop = &stop, .depth = 3 };
+    ChessBoard *cb = chessboard_create(KIWIPETE_FEN);
+    SearchLimits limits = { .threads = 4, .stop = &stop, .info = stop_at_depth, .info_arg = &stopper };
+    SearchResult result;
+    chessboard_search(cb, &limits, &result);
+
+    struct timespec returned;
+    clock_gettime(CLOCK_MONOTONIC, &returned);
+    double seconds = (returned.tv_sec - stopper.raised.tv_sec) + (returned.tv_nsec - stopper.raised.tv_nsec) / 1e9;
+    bool stopped = atomic_load(&stop) && seconds < 0.25 && result.depth >= 3 && result.depth <= 5 && result.pv_length;
+    success = success && stopped;
+    fprintf(stdout, "[%c] Stop flag raised at depth 3 ends the search in %.1f ms (depth=%lu, nodes=%lu)\n",
+            (stopped) ? '.' : 'X', seconds * 1000, result.depth, result.nodes);
+    chessboard_delete(cb);
+
+    return success;
+}
+
+bool    test_14_move_strings() {
+
+    fprintf(stdout, "Testing move strings...\n");
+
+    const struct {
+        const char *fen;
+        const char *str;
+        bool        legal;
+        ChessMove   move;
+    } cases[] = {
+        {NULL,                              "e2e4",     true,   MOVE_CREATE(12, 28, 0)},
+        {NULL,                              "g1f3 e7e5", true,   MOVE_CREATE(6, 21, 0)},
+        {NULL,                              "e2e5",     false,  0},
+        {NULL,                              "e7e5",     false,  0},
+        {NULL,                              "e2",       false,  0},
+        {NULL,                              "i2i4",     false,  0},
+        {"r3k3/1P6/8/8/8/8/8/4K3 w q - 0 1", "b7a8n",    true,   MOVE_CREATE(49, 56, KNIGHT)},
+        {"r3k3/1P6/8/8/8/8/8/4K3 w q - 0 1", "b7b8Q",    true,   MOVE_CREATE(49, 57, QUEEN)},
+        {"r3k3/1P6/8/8/8/8/8/4K3 w q - 0 1", "b7b8",     false,  0},
+        {"r3k3/1P6/8/8/8/8/8/4K3 w q - 0 1", "b7b8k",    false,  0},
+        {KIWIPETE_FEN,                      "e1g1",     true,   MOVE_CREATE(4, 6, 0)},
+    };
+
+    bool success = true;
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        ChessBoard *cb = chessboard_create(cases[i].fen);
+        ChessMove move = 0;
+        bool legal = chessboard_move_from_string(cb, cases[i].str, &move);
+        bool match = legal == cases[i].legal && (!legal || move == cases[i].move);
+
+        char round_trip[6] = "-";
+        if (legal) {
+            chessmove_to_string(move, round_trip);
+            match = match && !strncasecmp(round_trip, cases[i].str, strlen(round_trip));
+        }
+        success = success && match;
+
+        fprintf(stdout, "[%c] \"%.5s\" is %s (%s)\n", (match) ? '.' : 'X', cases[i].str,
+                (legal) ? "legal" : "rejected", round_trip);
+        chessboard_delete(cb);
+    }
+
+    // The engine over its protocol: "go infinite" holds bestmove until "stop", isready answers meanwhile
+    const char *script =
+        "uci\nisready\n"
+        "position startpos moves e2e4\nposition startpos moves d2d4 e7e9\nd\n"
+        "go infinite\nisready\nstop\nisready\n"
+        "position startpos moves e2e4 e7e5\ngo depth 3\nquit\n";
+    const struct {
+        const char *reply;
+        const char *fen;                            // Position a bestmove must be legal in
+    } replies[] = {
+        {"uciok",                           NULL},
+        {"readyok",                         NULL},
+        {"info string illegal move e7e9",   NULL},
+        {"Fen: rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1", NULL},
+        {"readyok",                         NULL},
+        {"bestmove",                        "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1"},
+        {"readyok",                         NULL},
+        {"bestmove",                        "rnbqkbnr/pppp1ppp/8/4p3/4P3/8/PPPP1PPP/RNBQKBNR w KQkq e6 0 2"},
+    };
+    const size_t replies_count = sizeof(replies) / sizeof(replies[0]);
+
+    char path[] = "/tmp/unit_chess_XXXXXX";
+    int fd = mkstemp(path);
+    bool scripted = fd >= 0 && write(fd, script, strlen(script)) == (ssize_t)strlen(script);
+    if (fd >= 0) close(fd);
+
+    char command[sizeof(UCI_PATH) + sizeof(path) + 4];
+    snprintf(command, sizeof(command), UCI_PATH " < %s", path);
+    FILE *engine = (scripted) ? popen(command, "r") : NULL;
+    if (!engine) {
+        fprintf(stdout, "[X] Unable to run %s\n", UCI_PATH);
+        if (fd >= 0) unlink(path);
+        return false;
+    }
+
+    // Only the replies the script asks for: id, option and info depth lines vary
+    char line[BUFSIZ], lines[sizeof(replies) / sizeof(replies[0])][128];
+    size_t lines_count = 0;
+    while (fgets(line, sizeof(line), engine)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (strcmp(line, "uciok") && strcmp(line, "readyok") && strncmp(line, "info string ", 12) &&
+            strncmp(line, "Fen: ", 5) && strncmp(line, "bestmove ", 9)) continue;
+        if (lines_count < replies_count) snprintf(lines[lines_count], sizeof(lines[0]), "%.127s", line);
+        lines_count++;
+    }
+    bool exited = pclose(engine) == 0 && lines_count == replies_count;
+    unlink(path);
+    success = success && exited;
+    fprintf(stdout, "[%c] %s answered %lu of %lu expected lines and exited\n",
+            (exited) ? '.' : 'X', UCI_PATH, lines_count, replies_count);
+
+    for (size_t i = 0; i < replies_count && i < lines_count; i++) {
+        bool match = !strncmp(lines[i], replies[i].reply, strlen(replies[i].reply));
+        if (match && replies[i].fen) {
+            ChessBoard *cb = chessboard_create(replies[i].fen);
+            ChessMove move;
+            match = chessboard_move_from_string(cb, lines[i] + 9, &move);
+            chessboard_delete(cb);
+        }
+        success = success && match;
+        fprintf(stdout, "[%c] %s\n", (match) ? '.' : 'X', lines[i]);
+    }
+
+    return success;
+}
+
+
+bool    test_15_pgn_reader() {
+
+    fprintf(stdout, "Testing PGN reader...\n");
+
+    bool success = true;
+
+    const struct {
+        const char *fen;
+        const char *san;
+        bool        legal;
+        ChessMove   move;
+    } moves[] = {
+        {NULL,                                  "e4",       true,   MOVE_CREATE(12, 28, 0)},
+        {NULL,                                  "Nf3+!?",   true,   MOVE_CREATE(6, 21, 0)},
+        {NULL,                                  "e5",       false,  0},
+        {"4k3/8/8/8/8/8/8/1N2KN2 w - - 0 1",    "Nd2",      false,  0},
+        {"4k3/8/8/8/8/8/8/1N2KN2 w - - 0 1",    "N1d2",     false,  0},
+        {"4k3/8/8/8/8/8/8/1N2KN2 w - - 0 1",    "Nfd2",     true,   MOVE_CREATE(5, 11, 0)},
+        {"r3k3/1P6/8/8/8/8/8/4K3 w q - 0 1",    "bxa8=N",   true,   MOVE_CREATE(49, 56, KNIGHT)},
+        {"r3k3/1P6/8/8/8/8/8/4K3 w q - 0 1",    "b8Q",      true,   MOVE_CREATE(49, 57, QUEEN)},
+        {"r3k3/1P6/8/8/8/8/8/4K3 w q - 0 1",    "b8",       false,  0},
+        {KIWIPETE_FEN,                          "O-O",      true,   MOVE_CREATE(4, 6, 0)},
+        {KIWIPETE_FEN,                          "0-0-0",    true,   MOVE_CREATE(4, 2, 0)},
+        {SPECIAL_MOVES[3].fen,                  "exf6",     true,   MOVE_CREATE(36, 45, 0)},
+    };
+    for (size_t i = 0; i < sizeof(moves) / sizeof(moves[0]); i++) {
+        ChessBoard *cb = chessboard_create(moves[i].fen);
+        ChessMove move = 0;
+        bool legal = chessboard_move_from_san(cb, moves[i].san, &move);
+        bool match = legal == moves[i].legal && (!legal || move == moves[i].move);
+        success = success && match;
+
+        fprintf(stdout, "[%c] \"%s\" is %s\n", (match) ? '.' : 'X', moves[i].san, (legal) ? "legal" : "rejected");
+        chessboard_delete(cb);
+    }
+
+    // Tags, comments, NAGs and nested variations around a mainline of two moves
+    const char *text = "[Event \"a ] b\"] 1. e4 {c} $1 (1. d4 (1. c4)) 1... e5 ! ; rest\n 1-0";
+    const int expected[] = {
+        PGN_TOKEN_TAG, PGN_TOKEN_NUMBER, PGN_TOKEN_MOVE, PGN_TOKEN_COMMENT, PGN_TOKEN_NAG,
+        PGN_TOKEN_VARIATION_START, PGN_TOKEN_NUMBER, PGN_TOKEN_MOVE, PGN_TOKEN_VARIATION_START,
+        PGN_TOKEN_NUMBER, PGN_TOKEN_MOVE, PGN_TOKEN_VARIATION_END, PGN_TOKEN_VARIATION_END,
+        PGN_TOKEN_NUMBER, PGN_TOKEN_MOVE, PGN_TOKEN_NAG, PGN_TOKEN_COMMENT, PGN_TOKEN_RESULT,
+    };
+    const char *cursor = text;
+    PgnToken token;
+    size_t count = 0;
+    bool tokens = true;
+    while (pgn_next_token(&cursor, text + strlen(text), &token)) {
+        tokens = tokens && count < sizeof(expected) / sizeof(expected[0]) && token.type == expected[count];
+        count++;
+    }
+    tokens = tokens && count == sizeof(expected) / sizeof(expected[0]);
+    success = success && tokens;
+    fprintf(stdout, "[%c] Tokenized %lu of %lu tokens\n", (tokens) ? '.' : 'X', count,
+            sizeof(expected) / sizeof(expected[0]));
+
+    // {White, plies, legal, FEN after the main line}
+    const struct {
+        const char *white;
+        size_t      plies;
+        bool        legal;
+        const char *fen;
+    } games[] = {
+        {"Paul Morphy", 33, true,   "1n1Rkb1r/p4ppp/4q3/4p1B1/4P3/8/PPP2PPP/2K5 b k - 1 17"},
+        {"White",       5,  true,   "8/8/2Q1k3/8/8/8/8/4K3 b - - 4 3"},
+        {"Engine A",    16, true,   "r1bq1rk1/1p2bppp/p1nppn2/8/2BP4/2N2N2/PPP2PPP/R1BQ1RK1 w - - 0 9"},
+        {"?",           2,  false,  "rnbqkbnr/pppp1ppp/8/4p3/4P3/8/PPPP1PPP/RNBQKBNR w KQkq e6 0 2"},
+    };
+
+    PgnReader *reader = pgn_open(PGN_SAMPLE_PATH);
+    if (!reader) {
+        fprintf(stdout, "[X] Unable to open %s\n", PGN_SAMPLE_PATH);
+        return false;
+    }
+
+    ChessBoard cb;
+    PgnGame game;
+    size_t index = 0;
+    while (pgn_next_game(reader, &game)) {
+        if (index >= sizeof(games) / sizeof(games[0])) {
+            index++;
+            continue;
+        }
+
+        ChessMove line[SEARCH_MAX_PLY];
+        size_t plies;
+        bool legal = pgn_replay(&game, &cb, line, SEARCH_MAX_PLY, &plies);
+        char *fen = chessboard_to_fen(&cb);
+
+        PgnSpan white;
+        bool match = pgn_game_tag(&game, "White", &white) && white.length == strlen(games[index].white) &&
+                     !memcmp(white.ptr, games[index].white, white.length) &&
+                     legal == games[index].legal && plies == games[index].plies && !strcmp(fen, games[index].fen);
+        success = success && match;
+
+        fprintf(stdout, "[%c] Game %lu: %lu plies, %s, result %.*s, %s\n", (match) ? '.' : 'X', index + 1,
+                plies, (legal) ? "legal" : "illegal", (int) game.result.length, game.result.ptr, fen);
+        free(fen);
+        index++;
+    }
+    pgn_close(reader);
+
+    bool counted = index == sizeof(games) / sizeof(games[0]);
+    success = success && counted;
+    fprintf(stdout, "[%c] Read %lu games\n", (counted) ? '.' : 'X', index);
+
+    // The FEN tag is kept past PGN_MAX_TAGS, or the moves would replay from the start
+    char many[4096];
+    size_t length = 0;
+    for (size_t i = 0; i <= PGN_MAX_TAGS; i++) {
+        length += sprintf(many + length, "[Tag%lu \"%lu\"]\n", i, i);
+    }
+    sprintf(many + length, "[FEN \"4k3/8/8/8/8/8/8/4K2R w K - 0 1\"]\n\n1. O-O Kd7 *\n");
+    reader = pgn_open_memory(many, strlen(many));
+    size_t plies = 0;
+    bool kept = pgn_next_game(reader, &game) && game.tags_count == PGN_MAX_TAGS &&
+                pgn_replay(&game, &cb, NULL, 0, &plies) && plies == 2;
+    pgn_close(reader);
+    success = success && kept;
+    fprintf(stdout, "[%c] FEN after %d tags replayed %lu plies\n", (kept) ? '.' : 'X', PGN_MAX_TAGS + 1, plies);
+
+    // Nothing but comments before the first tag, or after the last game, is not a game
+    const char *escaped = "% escape line\n{ intro }\n[Event \"a\"]\n\n1. e4 e5 1-0\n; trailer\n";
+    reader = pgn_open_memory(escaped, strlen(escaped));
+    size_t read = 0;
+    bool single = pgn_next_game(reader, &game) && game.index == 0 && game.tags_count == 1 &&
+                  game.text.ptr == strchr(escaped, '[');
+    while (pgn_next_game(reader, &game)) read++;
+    pgn_close(reader);
+    single = single && !read;
+    success = success && single;
+    fprintf(stdout, "[%c] Leading comments yield %lu extra games\n", (single) ? '.' : 'X', read);
+
+    return success;
+}
+
+
+bool    test_16_pgn_pipeline() {
+
+    fprintf(stdout, "Testing PGN pipeline...\n");
+
+    FILE *stream = fopen(PGN_SAMPLE_PATH, "r");
+    if (!stream) {
+        fprintf(stdout, "[X] Unable to open %s\n", PGN_SAMPLE_PATH);
+        return false;
+    }
+    char sample[BUFSIZ * 4];
+    size_t sample_size = fread(sample, 1, sizeof(sample), stream);
+    fclose(stream);
+
+    // Enough copies of the sample for many small chunks
+    const size_t copies = 100;
+    char *text = (char *) malloc(copies * (sample_size + 1));
+    for (size_t i = 0; i < copies; i++) {
+        memcpy(text + i * (sample_size + 1), sample, sample_size);
+        text[i * (sample_size + 1) + sample_size] = '\n';
+    }
+    size_t size = copies * (sample_size + 1);
+
+    size_t games = 0;
+    size_t plies[4 * 100];
+    bool legal[4 * 100];
+    ChessBoard cb;
+    PgnGame game;
+    PgnReader *reader = pgn_open_memory(text, size);
+    while (pgn_next_game(reader, &game) && games < sizeof(plies) / sizeof(plies[0])) {
+        legal[games] = pgn_replay(&game, &cb, NULL, 0, &plies[games]);
+        games++;
+    }
+    pgn_close(reader);
+
+    bool success = true;
+    const size_t workers[] = { 1, 3 };
+    PgnRecord *records = (PgnRecord *) malloc(games * sizeof(PgnRecord));
+    for (size_t w = 0; w < sizeof(workers) / sizeof(workers[0]); w++) {
+        PgnRecordLog log = { .records = records, .capacity = games, .ordered = true };
+        PgnPipelineOptions options = {
+            .workers    = workers[w],
+            .chunk_size = 2048,
+            .write      = record_game,
+            .arg        = &log,
+        };
+
+        PgnPipelineStats stats;
+        reader = pgn_open_memory(text, size);
+        bool match = pgn_pipeline_run(reader, &options, &stats) && log.ordered && log.count == games &&
+                     stats.games == games && stats.chunks > 1;
+        for (size_t i = 0; match && i < games; i++) {
+            match = records[i].plies == plies[i] && records[i].legal == legal[i];
+        }
+        pgn_close(reader);
+        success = success && match;
+
+        fprintf(stdout, "[%c] (Workers=%lu) %lu of %lu games in order over %lu chunks (%lu held back at most)\n",
+                (match) ? '.' : 'X', workers[w], stats.games, games, stats.chunks, stats.reorder_max);
+    }
+
+    free(records);
+    free(text);
+    return success;
+}
+
+
+bool    test_17_archive() {
+
+    fprintf(stdout, "Testing game archive...\n");
+
+    char path[] = "/tmp/unit_chess_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        fprintf(stdout, "[X] Unable to create a temporary file\n");
+        return false;
+    }
+    close(fd);
+
+    // Legal games of the sample, as archive_writer_add expects them
+    PgnReader *reader = pgn_open(PGN_SAMPLE_PATH);
+    ArchiveWriter *aw = archive_writer_create(path);
+    if (!reader || !aw) {
+        fprintf(stdout, "[X] Unable to open %s or %s\n", PGN_SAMPLE_PATH, path);
+        pgn_close(reader);
+        archive_writer_close(aw);
+        unlink(path);
+        return false;
+    }
+
+    ChessBoard cb;
+    PgnGame game;
+    ChessMove lines[4][SEARCH_MAX_PLY];
+    size_t plies[4];
+    char *fens[4] = { NULL };
+    size_t games = 0;
+    bool written = true;
+    while (pgn_next_game(reader, &game) && games < 4) {
+        if (!pgn_replay(&game, &cb, lines[games], SEARCH_MAX_PLY, &plies[games])) continue;
+        fens[games] = chessboard_to_fen(&cb);
+        written = written && archive_writer_add(aw, game.tags, game.tags_count, archive_result(game.result),
+                                                lines[games], plies[games]);
+        games++;
+    }
+    pgn_close(reader);
+    written = archive_writer_close(aw) && written;
+
+    ArchiveReader *ar = archive_open(path);
+    bool success = written && ar && ar->games == games && games == 3;
+    fprintf(stdout, "[%c] Archived %lu of 3 legal games\n", (success) ? '.' : 'X', (ar) ? ar->games : 0);
+
+    // {White, result}, read back from last to first through the index
+    const struct {
+        const char *white;
+        uint8_t     result;
+    } expected[] = {
+        {"Paul Morphy", ARCHIVE_RESULT_WHITE},
+        {"White",       ARCHIVE_RESULT_DRAW},
+        {"Engine A",    ARCHIVE_RESULT_UNKNOWN},
+    };
+    for (size_t i = games; success && i-- > 0;) {
+        ArchiveGame ag;
+        PgnSpan white;
+        bool match = archive_game(ar, i, &ag) && archive_replay(ar, &ag, &cb) && ag.plies == plies[i] &&
+                     !memcmp(ag.moves, lines[i], plies[i] * sizeof(ChessMove)) && ag.result == expected[i].result &&
+                     archive_game_tag(ar, &ag, "White", &white) && white.length == strlen(expected[i].white) &&
+                     !memcmp(white.ptr, expected[i].white, white.length);
+
+        char *fen = chessboard_to_fen(&cb);
+        match = match && !strcmp(fen, fens[i]);
+        success = success && match;
+
+        fprintf(stdout, "[%c] Game %lu: %lu plies, %s%s, %s\n", (match) ? '.' : 'X', i + 1, ag.plies,
+                (ag.fen) ? "from FEN, " : "", expected[i].white, fen);
+        free(fen);
+    }
+
+    ArchiveGame ag;
+    bool bounded = !ar || !archive_game(ar, games, &ag);
+    success = success && bounded;
+    fprintf(stdout, "[%c] Game %lu is out of range\n", (bounded) ? '.' : 'X', games + 1);
+
+    for (size_t i = 0; i < games; i++) free(fens[i]);
+    archive_close(ar);
+
+    // Offsets that wrap around when added to a length are rejected, not followed
+    FILE *stream = fopen(path, "r+b");
+    ArchiveFileHeader file_header;
+    uint64_t index_offset, game_offset, wrapped = UINT64_MAX - 3;
+    bool corrupted = stream && fread(&file_header, sizeof(file_header), 1, stream) == 1;
+    index_offset = file_header.index_offset;
+    file_header.index_offset = -(uint64_t)(file_header.games * sizeof(uint64_t));
+    corrupted = corrupted && !fseek(stream, 0, SEEK_SET) && fwrite(&file_header, sizeof(file_header), 1, stream) == 1;
+    if (stream) fflush(stream);
+    ar = archive_open(path);
+    bool rejected = corrupted && !ar;
+    archive_close(ar);
+
+    file_header.index_offset = index_offset;
+    corrupted = corrupted && !fseek(stream, 0, SEEK_SET) && fwrite(&file_header, sizeof(file_header), 1, stream) == 1 &&
+                !fseek(stream, index_offset, SEEK_SET) && fread(&game_offset, sizeof(game_offset), 1, stream) == 1 &&
+                !fseek(stream, index_offset, SEEK_SET) && fwrite(&wrapped, sizeof(wrapped), 1, stream) == 1;
+    if (stream) fflush(stream);
+    ar = archive_open(path);
+    rejected = rejected && corrupted && ar && !archive_game(ar, 0, &ag) && archive_game(ar, 1, &ag);
+    archive_close(ar);
+
+    corrupted = corrupted && !fseek(stream, index_offset, SEEK_SET) && fwrite(&game_offset, sizeof(game_offset), 1, stream) == 1;
+    if (stream) fclose(stream);
+    success = success && rejected;
+    fprintf(stdout, "[%c] Index and game offsets that wrap around are rejected\n", (rejected) ? '.' : 'X');
+
+    // A string offset outside its table is rejected at open, not when read
+    stream = fopen(path, "r+b");
+    uint32_t count, end;
+    corrupted = corrupted && stream && fread(&file_header, sizeof(file_header), 1, stream) == 1 &&
+                !fseek(stream, file_header.names_offset, SEEK_SET) && fread(&count, sizeof(count), 1, stream) == 1 &&
+                !fseek(stream, count * sizeof(uint32_t), SEEK_CUR) && fread(&end, sizeof(end), 1, stream) == 1 &&
+                !fseek(stream, file_header.names_offset + sizeof(uint32_t), SEEK_SET);
+    end++;
+    corrupted = corrupted && fwrite(&end, sizeof(end), 1, stream) == 1;
+    if (stream) fclose(stream);
+    ar = archive_open(path);
+    rejected = corrupted && !ar;
+    success = success && rejected;
+    fprintf(stdout, "[%c] Name offset past the end of its table is rejected\n", (rejected) ? '.' : 'X');
+    archive_close(ar);
+
+    // More tags than a game holds: the FEN tag comes last and is still kept
+    PgnTag tags[ARCHIVE_MAX_TAGS + 45];
+    char names[ARCHIVE_MAX_TAGS + 45][8];
+    const size_t tags_count = sizeof(tags) / sizeof(tags[0]);
+    for (size_t i = 0; i < tags_count; i++) {
+        snprintf(names[i], sizeof(names[i]), "T%lu", i);
+        tags[i] = (PgnTag){ { names[i], strlen(names[i]) }, { "?", 1 } };
+    }
+    const char *start = "4k3/8/8/8/8/8/8/4K2R w K - 0 1";
+    tags[tags_count - 1] = (PgnTag){ { "FEN", 3 }, { start, strlen(start) } };
+    ChessMove castle = MOVE_CREATE(4, 6, 0);
+
+    aw = archive_writer_create(path);
+    written = aw && archive_writer_add(aw, tags, tags_count, ARCHIVE_RESULT_UNKNOWN, &castle, 1);
+    written = archive_writer_close(aw) && written;
+    ar = (written) ? archive_open(path) : NULL;
+    char fen[CHESSBOARD_FEN_SIZE] = "-";
+    bool kept = ar && archive_game(ar, 0, &ag) && ag.fen && ag.tags_count == ARCHIVE_MAX_TAGS &&
+                archive_replay(ar, &ag, &cb) && chessboard_write_fen(&cb, fen, sizeof(fen)) &&
+                !strcmp(fen, "4k3/8/8/8/8/8/8/5RK1 b - - 1 1");
+    success = success && kept;
+    fprintf(stdout, "[%c] FEN tag kept among %lu tags, replayed to %s\n", (kept) ? '.' : 'X', tags_count, fen);
+    archive_close(ar);
+
+    unlink(path);
+    return success;
+}
+
+
+bool    test_18_fen_buffers() {
+
+    fprintf(stdout, "Testing in-place FEN parsing and writing...\n");
+
+    bool success = true;
+    ChessBoard cb;
+    char fen[CHESSBOARD_FEN_SIZE];
+
+    const char *fens[] = {
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3",
+        "4k3/8/8/8/8/8/8/4K3 b - - 123 18446744073709551615",
+    };
+    for (size_t i = 0; i < sizeof(fens) / sizeof(fens[0]); i++) {
+        size_t length = (chessboard_init(&cb, fens[i])) ? chessboard_write_fen(&cb, fen, sizeof(fen)) : 0;
+        bool match = length == strlen(fens[i]) && !strcmp(fen, fens[i]) && cb.key == chessboard_compute_key(&cb);
+        success = success && match;
+        fprintf(stdout, "[%c] %s\n", (match) ? '.' : 'X', fens[i]);
+    }
+
+    char small[8];
+    size_t length = chessboard_write_fen(&cb, small, sizeof(small));
+    bool truncated = length == strlen(fens[3]) && !strcmp(small, "4k3/8/8");
+    success = success && truncated;
+    fprintf(stdout, "[%c] Truncated to \"%s\" of %lu characters\n", (truncated) ? '.' : 'X', small, length);
+
+    const char *invalid[] = {
+        "rnbqkbnr/pppppppp/9/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        "rnbqkbnrr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        "8/8/8/8/8/8/8/8/8 w - - 0 1",
+        "rnbqkbnr/ppppxppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    };
+    for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+        bool rejected = !chessboard_init(&cb, invalid[i]) && !chessboard_create(invalid[i]);
+        success = success && rejected;
+        fprintf(stdout, "[%c] Rejected %s\n", (rejected) ? '.' : 'X', invalid[i]);
+    }
+
+    // EPD lines carry operations where the counters would be
+    const char *epd_line = "4k3/8/8/8/8/8/8/4K3 w - - bm Kd2; id \"kings\";";
+    const char *rest = chessboard_parse_fen(&cb, epd_line);
+    bool operations = rest && !strcmp(rest, " bm Kd2; id \"kings\";") && cb.halfmove_clock == 0 &&
+                      cb.fullmove_counter == 1;
+    success = success && operations;
+    fprintf(stdout, "[%c] Operations start at \"%s\"\n", (operations) ? '.' : 'X', (rest) ? rest : "");
+
+    const char text[] = "# Comment\r\n"
+                        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - ;D1 20\r\n"
+                        "\n"
+                        "rnbqkbnr/pppppppp/9/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - ;D1 20\n"
+                        "  4k3/8/8/8/8/8/8/4K3 b - - 3 40";
+    EpdFile *epd = epd_parse(text, sizeof(text) - 1);
+    bool batch = epd && epd->count == 2 && epd->invalid == 1 &&
+                 !strcmp(epd->fens[0], "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq -") &&
+                 !strcmp(epd->operations[0], ";D1 20") && !strcmp(epd->operations[1], "") &&
+                 epd->boards[1].to_move == BLACK && epd->boards[1].fullmove_counter == 40 &&
+                 chessboard_count_legal_moves(&epd->boards[0]) == 20;
+    success = success && batch;
+    fprintf(stdout, "[%c] Parsed %lu EPD positions (%lu invalid)\n", (batch) ? '.' : 'X',
+            (epd) ? epd->count : 0, (epd) ? epd->invalid : 0);
+    epd_delete(epd);
+
+    return success;
+}
+
+
+bool    test_19_chessgame() {
+
+    fprintf(stdout, "Testing game history...\n");
+
+    bool success = true;
+    ChessGame *cg = chessgame_create(NULL, "Test", NULL, NULL, NULL, 1, "White", "Black");
+    if (!cg) {
+        fprintf(stdout, "[X] Unable to create game\n");
+        return false;
+    }
+
+    // Knights out and back: the start position recurs every four plies
+    const char *shuffle[] = { "Nf3", "Nf6", "Ng1", "Ng8" };
+    const size_t shuffles = 80;
+    bool played = true;
+    for (size_t i = 0; played && i < shuffles * 4; i++) played = chessgame_move_pgn(cg, shuffle[i % 4]);
+    size_t repetitions = chessgame_repetitions(cg);
+    played = played && cg->ply_count == shuffles * 4 && cg->records_capacity >= cg->ply_count;
+    success = success && played && repetitions == cg->board->halfmove_clock / 4;
+    fprintf(stdout, "[%c] Played %lu plies, start position repeated %lu times in the last %lu\n",
+            (played) ? '.' : 'X', cg->ply_count, repetitions, cg->board->halfmove_clock);
+
+    // Counters aside, ply N leaves the position ply N % 4 did
+    ChessBoard cb;
+    ChessMove moves[4];
+    uint64_t keys[4];
+    chessboard_init(&cb, NULL);
+    for (size_t i = 0; i < 4; i++) {
+        chessboard_move_from_san(&cb, shuffle[i], &moves[i]);
+        chessboard_make_move(&cb, moves[i]);
+        keys[i] = cb.key;
+    }
+
+    bool indexed = true;
+    for (size_t ply = 0; ply < cg->ply_count; ply++) {
+        const ChessRecord *record = chessgame_record(cg, ply);
+        indexed = indexed && record && record->move == moves[ply % 4] && record->key == keys[ply % 4];
+    }
+    indexed = indexed && !chessgame_record(cg, cg->ply_count);
+    success = success && indexed;
+    fprintf(stdout, "[%c] Records indexed by ply\n", (indexed) ? '.' : 'X');
+
+    // All the way back to the first move
+    char start[CHESSBOARD_FEN_SIZE], end[CHESSBOARD_FEN_SIZE], fen[CHESSBOARD_FEN_SIZE];
+    chessgame_to_fen(cg, end, sizeof(end));
+    size_t undone = 0;
+    while (chessgame_undo(cg)) undone++;
+    chessgame_to_fen(cg, start, sizeof(start));
+    bool rewound = undone == shuffles * 4 &&
+                   !strcmp(start, "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1") &&
+                   cg->board->key == chessboard_compute_key(cg->board);
+    success = success && rewound;
+    fprintf(stdout, "[%c] Undid %lu plies to %s\n", (rewound) ? '.' : 'X', undone, start);
+
+    size_t redone = 0;
+    while (chessgame_redo(cg)) redone++;
+    chessgame_to_fen(cg, fen, sizeof(fen));
+    bool replayed = redone == undone && !strcmp(fen, end) && cg->board->key == chessboard_compute_key(cg->board);
+    success = success && replayed;
+    fprintf(stdout, "[%c] Redid %lu plies to %s\n", (replayed) ? '.' : 'X', redone, fen);
+
+    // A new move after undoing drops the redo tail
+    chessgame_undo(cg);
+    bool branched = chessgame_move_pgn(cg, "Ng4") && !chessgame_redo(cg) && cg->records_count == cg->ply_count &&
+                    !chessgame_move_pgn(cg, "Nf6");
+    success = success && branched;
+    fprintf(stdout, "[%c] Branched at ply %lu\n", (branched) ? '.' : 'X', cg->ply_count);
+    chessgame_delete(cg);
+
+    // {FEN, moves, result}
+    const struct {
+        const char *fen;
+        const char *moves[8];
+        uint8_t     result;
+    } games[] = {
+        {NULL, {"e4", "e5", "Bc4", "Nc6", "Qh5", "Nf6", "Qxf7#"}, CHESSGAME_WHITE_WON},
+        {NULL, {"f3", "e5", "g4", "Qh4#"}, CHESSGAME_BLACK_WON},
+        {"7k/5Q2/8/8/8/8/8/K7 w - - 0 1", {"Qf8+", "Kh7", "Qf6", "Kg8", "Qe7", "Kh8", "Qf7"}, CHESSGAME_DRAWN},
+    };
+    for (size_t i = 0; i < sizeof(games) / sizeof(games[0]); i++) {
+        cg = chessgame_create(games[i].fen, NULL, NULL, NULL, NULL, 0, NULL, NULL);
+        bool match = cg != NULL;
+        size_t plies = 0;
+        for (; match && plies < 8 && games[i].moves[plies]; plies++) match = chessgame_move_pgn(cg, games[i].moves[plies]);
+        match = match && cg->result == games[i].result;
+
+        // The result goes away with the last ply and comes back with it
+        match = match && chessgame_undo(cg) && cg->result == CHESSGAME_ONGOING && chessgame_redo(cg) &&
+                cg->result == games[i].result;
+        success = success && match;
+        fprintf(stdout, "[%c] Game %lu: %lu plies, result %u\n", (match) ? '.' : 'X', i + 1, plies,
+                (cg) ? cg->result : 0);
+        chessgame_delete(cg);
+    }
+
+    return success;
+}
+
+
+bool    test_20_arena() {
+
+    fprintf(stdout, "Testing arena allocation...\n");
+
+    Arena *arena = arena_create(1 << 16);
+    if (!arena) {
+        fprintf(stdout, "[X] Unable to create arena\n");
+        return false;
+    }
+
+    bool success = true;
+    for (size_t round = 0; round < 2; round++) {
+        size_t blocks = arena->blocks_count;
+
+        bool boards = true;
+        for (size_t i = 0; i < 100; i++) {
+            ChessBoard *cb = chessboard_create_in(arena, (i % 2) ? KIWIPETE_FEN : NULL);
+            boards = boards && cb && (uintptr_t) cb % ARENA_ALIGNMENT == 0 &&
+                     chessboard_count_legal_moves(cb) == ((i % 2) ? 48 : 20);
+        }
+        boards = boards && !chessboard_create_in(arena, "9/8/8/8/8/8/8/8 w - - 0 1");
+
+        // History outgrows its first array inside the arena
+        const char *shuffle[] = { "Nf3", "Nf6", "Ng1", "Ng8" };
+        ChessGame *cg = chessgame_create_in(arena, NULL, "Event", NULL, NULL, NULL, 1, "White", "Black");
+        bool game = cg && cg->arena == arena && !strcmp(cg->white, "White");
+        for (size_t i = 0; game && i < 400; i++) game = chessgame_move_pgn(cg, shuffle[i % 4]);
+        while (game && chessgame_undo(cg));
+        game = game && cg->ply_count == 0 && cg->board->key == chessboard_compute_key(cg->board);
+        chessgame_delete(cg);
+
+        List *l = list_create_in(arena);
+        bool list = l != NULL;
+        for (size_t i = 0; list && i < 1000; i++) list_append(l, (void *) i);
+        list = list && l->size == 1000 && list_pop(l, 10) == (void *) 10 && list_pop(l, 0) == (void *) 0 &&
+               l->size == 998;
+        list_delete(l, false);
+
+        // The second round fits in the blocks the first one left behind
+        bool reused = round == 0 || arena->blocks_count == blocks;
+        bool match = boards && game && list && reused;
+        success = success && match;
+        fprintf(stdout, "[%c] Round %lu: boards %s, game %s, list %s, %lu KB in %lu blocks\n", (match) ? '.' : 'X',
+                round + 1, (boards) ? "ok" : "failed", (game) ? "ok" : "failed", (list) ? "ok" : "failed",
+                arena->allocated >> 10, arena->blocks_count);
+
+        arena_reset(arena);
+    }
+
+    void *large = arena_alloc(arena, 1 << 20);
+    bool oversized = large && arena->allocated == 1 << 20 && arena_calloc(arena, SIZE_MAX, 2) == NULL;
+    success = success && oversized;
+    fprintf(stdout, "[%c] Allocation larger than a block\n", (oversized) ? '.' : 'X');
+
+    arena_delete(arena);
+    return success;
+}
+
+bool    test_21_position() {
+
+    fprintf(stdout, "Testing compact positions...\n");
+
+    bool success = true;
+    bool size = sizeof(Position) <= 128;
+    success = success && size;
+    fprintf(stdout, "[%c] sizeof(Position) = %lu (ChessBoard %lu)\n", (size) ? '.' : 'X',
+            sizeof(Position), sizeof(ChessBoard));
+
+    // Round trips through both representations keep the FEN and key
+    for (size_t i = 0; i < sizeof(TRICKY) / sizeof(TRICKY[0]); i++) {
+        ChessBoard *cb = chessboard_create(TRICKY[i].fen);
+        ChessBoard *back = chessboard_create(NULL);
+        Position pos;
+        bool loaded = cb && back && position_init(&pos, TRICKY[i].fen);
+
+        char fen[CHESSBOARD_FEN_SIZE], round_trip[CHESSBOARD_FEN_SIZE];
+        bool match = loaded;
+        if (loaded) {
+            position_to_chessboard(&pos, back);
+            chessboard_write_fen(cb, fen, sizeof(fen));
+            chessboard_write_fen(back, round_trip, sizeof(round_trip));
+            match = !strcmp(fen, round_trip) && pos.key == cb->key && back->key == cb->key &&
+                    !memcmp(back->targets, cb->targets, sizeof(cb->targets)) &&
+                    position_in_check(&pos) == chessboard_in_check(cb, cb->to_move);
+        }
+
+        // Copy-make agrees with make/unmake node for node, then in counts
+        size_t nodes = (match) ? position_perft(&pos, TRICKY[i].ply) : 0;
+        match = match && walk_position(cb, &pos, 3) && nodes == TRICKY[i].nodes;
+        success = success && match;
+        fprintf(stdout, "[%c] (Ply=%lu) %12lu | %s\n", (match) ? '.' : 'X', TRICKY[i].ply, nodes, TRICKY[i].fen);
+
+        chessboard_delete(cb);
+        chessboard_delete(back);
+    }
+
+    Position pos;
+    bool invalid = !position_init(&pos, "9/8/8/8/8/8/8/8 w - - 0 1");
+    bool kiwipete = position_init(&pos, KIWIPETE_FEN) && position_perft(&pos, 4) == 4085603 &&
+                    position_piece_at(&pos, 4) == (KING | WHITE) && position_piece_at(&pos, 27) == EMPTY;
+    success = success && invalid && kiwipete;
+    fprintf(stdout, "[%c] Kiwipete perft(4), invalid FEN rejected\n", (invalid && kiwipete) ? '.' : 'X');
+
+    return success;
+}
+
+
+
+bool    test_22_generated_tables() {
+
+    fprintf(stdout, "Testing generated tables against a runtime computation...\n");
+
+    Bitboard *scratch = (Bitboard *) malloc(MAGIC_ROOK_TABLE_SIZE * sizeof(Bitboard));
+    if (!scratch) {
+        fprintf(stdout, "[X] Unable to allocate scratch tables\n");
+        return false;
+    }
+
+    Bitboard knight[64], king[64], pawn[2][64];
+    tables_compute_leapers(knight, king, pawn);
+    bool leapers = !memcmp(knight, KNIGHT_ATTACKS, sizeof(knight)) && !memcmp(king, KING_ATTACKS, sizeof(king)) &&
+                   !memcmp(pawn, PAWN_ATTACKS, sizeof(pawn));
+    fprintf(stdout, "[%c] Knight, king and pawn attacks\n", (leapers) ? '.' : 'X');
+
+    // Compare fields, so that padding in Magic does not matter
+    bool magics = true;
+    for (size_t bishop = 0; bishop < 2; bishop++) {
+        Magic computed[64];
+        const Magic *generated = (bishop) ? MAGIC_BISHOP : MAGIC_ROOK;
+        size_t size = (bishop) ? MAGIC_BISHOP_TABLE_SIZE : MAGIC_ROOK_TABLE_SIZE;
+        tables_compute_magics(computed, scratch, bishop);
+        for (size_t square = 0; square < 64; square++) {
+            magics = magics && computed[square].mask == generated[square].mask &&
+                     computed[square].magic == generated[square].magic &&
+                     computed[square].offset == generated[square].offset &&
+                     computed[square].shift == generated[square].shift;
+        }
+        magics = magics && !memcmp(scratch, (bishop) ? MAGIC_BISHOP_TABLE : MAGIC_ROOK_TABLE, size * sizeof(Bitboard));
+    }
+    fprintf(stdout, "[%c] Bishop and rook magics (%d + %d attack sets)\n", (magics) ? '.' : 'X',
+            MAGIC_BISHOP_TABLE_SIZE, MAGIC_ROOK_TABLE_SIZE);
+
+    Bitboard (*between)[64] = (Bitboard (*)[64]) scratch;
+    Bitboard (*line)[64] = (Bitboard (*)[64]) (scratch + 64 * 64);
+    tables_compute_lines(between, line);
+    bool lines = !memcmp(between, BETWEEN, sizeof(BETWEEN)) && !memcmp(line, LINE, sizeof(LINE));
+    fprintf(stdout, "[%c] Between and line tables\n", (lines) ? '.' : 'X');
+
+    uint64_t pieces[16][64], castle[16], enpassant[8], side;
+    tables_compute_zobrist(pieces, castle, enpassant, &side);
+    bool zobrist = !memcmp(pieces, ZOBRIST_PIECES, sizeof(pieces)) && !memcmp(castle, ZOBRIST_CASTLE, sizeof(castle)) &&
+                   !memcmp(enpassant, ZOBRIST_ENPASSANT, sizeof(enpassant)) && side == ZOBRIST_SIDE;
+    fprintf(stdout, "[%c] Zobrist keys\n", (zobrist) ? '.' : 'X');
+
+    free(scratch);
+    return leapers && magics && lines && zobrist;
+}
+
+
+/* Main Execution */
+
+int main(int argc, char *argv[]) {
+
+    int failures = 0;
+
+    failures += test_01_perft_results() ? 0 : 1;
+    failures += test_02_magic_attacks() ? 0 : 1;
+    failures += test_03_slider_modes() ? 0 : 1;
+    failures += test_04_make_unmake() ? 0 : 1;
+    failures += test_05_zobrist_keys() ? 0 : 1;
+    failures += test_06_parallel_perft() ? 0 : 1;
+    failures += test_07_hashed_perft() ? 0 : 1;
+    failures += test_08_bulk_count() ? 0 : 1;
+    failures += test_09_pseudolegal_perft() ? 0 : 1;
+    failures += test_10_attack_maps() ? 0 : 1;
+    failures += test_11_search() ? 0 : 1;
+    failures += test_12_transposition_table() ? 0 : 1;
+    failures += test_13_lazy_smp() ? 0 : 1;
+    failures += test_14_move_strings() ? 0 : 1;
+    failures += test_15_pgn_reader() ? 0 : 1;
+    failures += test_16_pgn_pipeline() ? 0 : 1;
+    failures += test_17_archive() ? 0 : 1;
+    failures += test_18_fen_buffers() ? 0 : 1;
+    failures += test_19_chessgame() ? 0 : 1;
+    failures += test_20_arena() ? 0 : 1;
+    failures += test_21_position() ? 0 : 1;
+    failures += test_22_generated_tables() ? 0 : 1;
+
+    return (failures) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+